@@ -114,6 +114,7 @@ static int dai_evaluate_tile_for_air_attack(struct unit *punit,
                                             struct tile *dst_tile)
 {
   struct unit *pdefender;
+  double chance;
   // unit costs in shields
   int balanced_cost, unit_cost, victim_cost = 0;
   // unit stats
@@ -125,7 +126,7 @@ static int dai_evaluate_tile_for_air_attack(struct unit *punit,
 #define PROB_MULTIPLIER 100 // should unify with those in combat.c
 
   if (!can_unit_attack_tile(punit, dst_tile)
-      || !(pdefender = get_defender(punit, dst_tile))) {
+      || !(pdefender = get_defender_odds(punit, dst_tile, &chance))) {
     return 0;
   }
 
@@ -149,8 +150,7 @@ static int dai_evaluate_tile_for_air_attack(struct unit *punit,
     victim_cost -= unit_build_shield_cost_base(punit);
   }
 
-  unit_attack =
-      static_cast<int>(PROB_MULTIPLIER * unit_win_chance(punit, pdefender));
+  unit_attack = static_cast<int>(PROB_MULTIPLIER * chance);
 
   victim_defence = PROB_MULTIPLIER - unit_attack;
 
@@ -282,6 +282,9 @@ void dai_data_phase_finished(struct ai_type *ait, struct player *pplayer)
 {
   struct ai_plr *ai = def_ai_player_data(pplayer, ait);
 
+  ai->danger_scan.done = false;
+  ai->danger_scan.cities.clear();
+
   if (!ai->phase_initialized) {
     return;
   }
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <QHash>
+#include <QVector>
 // utility
 #include "support.h"
 
@@ -60,6 +61,16 @@ struct ai_dip_intel {
   signed char warned_about_space;
 };
 
+/* What the read-only danger scan found out about a single enemy unit
+ * that could reach one of our cities. */
+struct dai_threat {
+  const struct unit_type *utype;
+  int move_time;
+  int vulnerability;
+  bool can_take_over;
+  bool can_nuke;
+};
+
 struct ai_plr {
   bool phase_initialized;
 
@@ -93,6 +104,13 @@ struct ai_plr {
 
   // The units of tech_want seem to be shields
   adv_want tech_want[A_LAST + 1];
+
+  /* Threats to our cities scanned at phase start by
+   * dai_assess_danger_phase(), keyed by city id. */
+  struct {
+    bool done;
+    QHash<int, QVector<struct dai_threat>> cities;
+  } danger_scan;
 };
 
 void dai_data_init(struct ai_type *ait, struct player *pplayer);
@@ -482,6 +482,7 @@ int dai_hunter_manage(struct ai_type *ait, struct player *pplayer,
     {
       struct player *aplayer = unit_owner(target);
       int dist1, dist2, stackthreat = 0, stackcost = 0;
+      double chance;
       int sanity_target = target->id;
       struct unit_ai *target_data;
 
@@ -535,8 +536,8 @@ int dai_hunter_manage(struct ai_type *ait, struct player *pplayer,
       /* Calculate juiciness of target, compare with existing target,
        * if any. */
       dai_hunter_juiciness(pplayer, punit, target, &stackthreat, &stackcost);
-      stackcost *=
-          unit_win_chance(punit, get_defender(punit, unit_tile(target)));
+      get_defender_odds(punit, unit_tile(target), &chance);
+      stackcost *= chance;
       if (stackcost < unit_build_shield_cost_base(punit)) {
         UNIT_LOG(LOGLEVEL_HUNT, punit,
                  "%d is too expensive (it %d vs us %d)", target->id,
@@ -55,6 +55,8 @@ static struct tile *find_best_tile_to_paradrop_to(struct ai_type *ait,
 {
   int best = 0;
   int val;
+  double chance;
+  struct unit *pdefender;
   struct tile *best_tile = nullptr;
   int range = unit_type_get(punit)->paratroopers_range;
   struct city *acity;
@@ -144,6 +146,8 @@ static struct tile *find_best_tile_to_paradrop_to(struct ai_type *ait,
         continue;
       }
       val = 0;
+      // One batch gives both the defender and the odds against it.
+      pdefender = get_defender_odds(punit, target, &chance);
       if (is_stack_vulnerable(target)) {
         unit_list_iterate(target->units, victim)
         {
@@ -156,9 +160,9 @@ static struct tile *find_best_tile_to_paradrop_to(struct ai_type *ait,
         }
         unit_list_iterate_end;
       } else {
-        val += get_defender(punit, target)->hp * 100;
+        val += pdefender->hp * 100;
       }
-      val *= unit_win_chance(punit, get_defender(punit, target));
+      val *= chance;
       val += pterrain->defense_bonus / 10;
       val -= punit->hp * 100;
 
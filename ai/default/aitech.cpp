@@ -11,6 +11,7 @@
     \_____/ /                     If not, see https://www.gnu.org/licenses/.
       \____/        ********************************************************/
 
+#include <QThreadPool>
 #include <cstring>
 
 // utility
@@ -206,35 +207,102 @@ static void dai_select_tech(struct ai_type *ait, struct player *pplayer,
 }
 
 /**
-   Calculates want for some techs by actually adding the tech and
-   measuring the effect.
+   Calculates want for some techs by speculatively adding the tech and
+   measuring the effect. The research itself isn't modified.
  */
-static adv_want dai_tech_base_want(struct ai_type *ait,
-                                   struct player *pplayer,
-                                   struct city *pcity, struct advance *padv)
+static adv_want dai_tech_base_want(struct player *pplayer,
+                                   struct city *pcity, struct advance *padv,
+                                   struct adv_data *adv)
 {
-  struct research *pres = research_get(pplayer);
-  Tech_type_id tech = advance_number(padv);
-  enum tech_state old_state = research_invention_state(pres, tech);
-  struct adv_data *adv = adv_data_get(pplayer, nullptr);
+  struct research_speculation spec;
   adv_want orig_want = dai_city_want(pplayer, pcity, adv, nullptr);
   adv_want final_want;
-  bool world_knew = game.info.global_advances[tech];
-  int world_count = game.info.global_advance_count;
-
-  research_invention_set(pres, tech, TECH_KNOWN);
 
+  research_speculation_begin(&spec, research_get(pplayer),
+                             advance_number(padv));
   final_want = dai_city_want(pplayer, pcity, adv, nullptr);
-
-  research_invention_set(pres, tech, old_state);
-  game.info.global_advances[tech] = world_knew;
-  game.info.global_advance_count = world_count;
+  research_speculation_end(&spec);
 
   return final_want - orig_want;
 }
 
 /**
-   Add effect values in to tech wants.
+   Add the effect values of one unknown tech in to its tech want. Only
+   reads the game state and only writes the want of that tech, so it can
+   run for several techs at once.
+ */
+static void dai_tech_effect_value(struct player *pplayer,
+                                  struct advance *padv,
+                                  struct government *gov,
+                                  struct adv_data *adv, struct ai_plr *aip,
+                                  int turns, int nplayers)
+{
+  struct universal source = {
+      .value = {.advance = padv},
+      .kind = VUT_ADVANCE,
+  };
+
+  city_list_iterate(pplayer->cities, pcity)
+  {
+    adv_want v;
+    adv_want tech_want;
+    bool capital;
+
+    v = dai_tech_base_want(pplayer, pcity, padv, adv);
+    capital = is_capital(pcity);
+
+    effect_list_iterate(get_req_source_effects(&source), peffect)
+    {
+      bool present = true;
+      bool active = true;
+
+      requirement_vector_iterate(&peffect->reqs, preq)
+      {
+        /* Check if all the requirements for the currently evaluated
+         * effect are met, except for having the tech that we are
+         * evaluating.
+         * TODO: Consider requirements that could be met later. */
+        if (VUT_ADVANCE == preq->source.kind
+            && preq->source.value.advance == padv) {
+          present = preq->present;
+          continue;
+        }
+        if (!is_req_active(pplayer, nullptr, pcity, nullptr, nullptr,
+                           nullptr, nullptr, nullptr, nullptr, nullptr,
+                           preq, RPT_POSSIBLE)) {
+          active = false;
+          break; // presence doesn't matter for inactive effects.
+        }
+      }
+      requirement_vector_iterate_end;
+
+      if (active) {
+        adv_want v1;
+
+        v1 = dai_effect_value(pplayer, gov, adv, pcity, capital, turns,
+                              peffect, 1, nplayers);
+
+        if (!present) {
+          // Tech removes the effect
+          v -= v1;
+        } else {
+          v += v1;
+        }
+      }
+    }
+    effect_list_iterate_end;
+
+    // Same conversion factor as in want_tech_for_improvement_effect()
+    tech_want = v * 14 / 8;
+
+    aip->tech_want[advance_index(padv)] += tech_want;
+  }
+  city_list_iterate_end;
+}
+
+/**
+   Add effect values in to tech wants. With game.server.ai_threads worker
+   threads, the techs are evaluated in parallel.
  */
 static void dai_tech_effect_values(struct ai_type *ait,
                                    struct player *pplayer)
@@ -242,11 +310,13 @@ static void dai_tech_effect_values(struct ai_type *ait,
   /* TODO: Currently this duplicates code from aicity.c improvement effect
    *       evaluating almost verbose - refactor so that they can share code.
    */
+  const struct research *presearch = research_get(pplayer);
   struct government *gov = government_of_player(pplayer);
   struct adv_data *adv = adv_data_get(pplayer, nullptr);
   struct ai_plr *aip = def_ai_player_data(pplayer, ait);
   int turns = 9999; // TODO: Set to correct value
   int nplayers = normal_player_count();
+  QThreadPool pool;
 
   // Remove team members from the equation
   players_iterate(aplayer)
@@ -258,74 +328,24 @@ static void dai_tech_effect_values(struct ai_type *ait,
   }
   players_iterate_end;
 
+  pool.setMaxThreadCount(game.server.ai_threads);
   advance_iterate(A_FIRST, padv)
   {
-    if (research_invention_state(research_get(pplayer), advance_number(padv))
-        != TECH_KNOWN) {
-      struct universal source = {
-          .value = {.advance = padv},
-          .kind = VUT_ADVANCE,
-      };
-
-      city_list_iterate(pplayer->cities, pcity)
-      {
-        adv_want v;
-        adv_want tech_want;
-        bool capital;
-
-        v = dai_tech_base_want(ait, pplayer, pcity, padv);
-        capital = is_capital(pcity);
-
-        effect_list_iterate(get_req_source_effects(&source), peffect)
-        {
-          bool present = true;
-          bool active = true;
-
-          requirement_vector_iterate(&peffect->reqs, preq)
-          {
-            /* Check if all the requirements for the currently evaluated
-             * effect are met, except for having the tech that we are
-             * evaluating.
-             * TODO: Consider requirements that could be met later. */
-            if (VUT_ADVANCE == preq->source.kind
-                && preq->source.value.advance == padv) {
-              present = preq->present;
-              continue;
-            }
-            if (!is_req_active(pplayer, nullptr, pcity, nullptr, nullptr,
-                               nullptr, nullptr, nullptr, nullptr, nullptr,
-                               preq, RPT_POSSIBLE)) {
-              active = false;
-              break; // presence doesn't matter for inactive effects.
-            }
-          }
-          requirement_vector_iterate_end;
-
-          if (active) {
-            adv_want v1;
-
-            v1 = dai_effect_value(pplayer, gov, adv, pcity, capital, turns,
-                                  peffect, 1, nplayers);
-
-            if (!present) {
-              // Tech removes the effect
-              v -= v1;
-            } else {
-              v += v1;
-            }
-          }
-        }
-        effect_list_iterate_end;
-
-        // Same conversion factor as in want_tech_for_improvement_effect()
-        tech_want = v * 14 / 8;
-
-        aip->tech_want[advance_index(padv)] += tech_want;
-      }
-      city_list_iterate_end;
+    if (research_invention_state(presearch, advance_number(padv))
+        == TECH_KNOWN) {
+      continue;
+    }
+    if (game.server.ai_threads <= 1) {
+      dai_tech_effect_value(pplayer, padv, gov, adv, aip, turns, nplayers);
+    } else {
+      pool.start([=]() {
+        dai_tech_effect_value(pplayer, padv, gov, adv, aip, turns,
+                              nplayers);
+      });
     }
   }
   advance_iterate_end;
+  pool.waitForDone();
 }
 
 /**
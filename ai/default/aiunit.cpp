@@ -456,11 +456,12 @@ static int dai_rampage_want(struct unit *punit, struct tile *ptile)
 {
   struct player *pplayer = unit_owner(punit);
   struct unit *pdef;
+  double chance;
 
   CHECK_UNIT(punit);
 
   if (can_unit_attack_tile(punit, ptile)
-      && (pdef = get_defender(punit, ptile))) {
+      && (pdef = get_defender_odds(punit, ptile, &chance))) {
     // See description of kill_desire() about these variables.
     int attack = unit_att_rating_now(punit);
     int benefit = stack_cost(punit, pdef);
@@ -479,7 +480,6 @@ static int dai_rampage_want(struct unit *punit, struct tile *ptile)
 
     // If we have non-zero attack rating...
     if (attack > 0 && is_my_turn(punit, pdef)) {
-      double chance = unit_win_chance(punit, pdef);
       int desire = avg_benefit(benefit, loss, chance);
 
       // No need to amortize, our operation takes one turn.
@@ -11,6 +11,9 @@
     \_____/ /                     If not, see https://www.gnu.org/licenses/.
       \____/        ********************************************************/
 
+#include <QHash>
+#include <QThreadPool>
+#include <QVector>
 #include <cstring>
 
 // utility
@@ -1487,16 +1490,16 @@ adv_want dai_city_want(struct player *pplayer, struct city *acity,
 }
 
 /**
-   Calculates want for some buildings by actually adding the building and
-   measuring the effect.
+   Calculates want for some buildings by speculatively adding the building
+   and measuring the effect. The city itself isn't modified, so this can
+   run on several worker threads at once.
  */
 static adv_want base_want(struct ai_type *ait, struct player *pplayer,
-                          struct city *pcity, struct impr_type *pimprove)
+                          struct city *pcity, struct impr_type *pimprove,
+                          struct adv_data *adv)
 {
-  struct adv_data *adv = adv_data_get(pplayer, nullptr);
+  struct city_speculation spec;
   adv_want final_want = 0;
-  int wonder_player_id = WONDER_NOT_OWNED;
-  int wonder_city_id = WONDER_NOT_BUILT;
 
   if (adv->impr_calc[improvement_index(pimprove)] == ADV_IMPR_ESTIMATE) {
     return 0; // Nothing to calculate here.
@@ -1508,15 +1511,9 @@ static adv_want base_want(struct ai_type *ait, struct player *pplayer,
     return 0;
   }
 
-  if (is_wonder(pimprove)) {
-    if (is_great_wonder(pimprove)) {
-      wonder_player_id =
-          game.info.great_wonder_owners[improvement_index(pimprove)];
-    }
-    wonder_city_id = pplayer->wonders[improvement_index(pimprove)];
-  }
-  // Add the improvement
-  city_add_improvement(pcity, pimprove);
+  // Pretend to add the improvement
+  city_speculation_begin(&spec, pcity);
+  city_speculation_add_improvement(&spec, pimprove);
 
   // Stir, then compare notes
   city_range_iterate(pcity, pplayer->cities,
@@ -1527,16 +1524,7 @@ static adv_want base_want(struct ai_type *ait, struct player *pplayer,
   }
   city_range_iterate_end;
 
-  // Restore
-  city_remove_improvement(pcity, pimprove);
-  if (is_wonder(pimprove)) {
-    if (is_great_wonder(pimprove)) {
-      game.info.great_wonder_owners[improvement_index(pimprove)] =
-          wonder_player_id;
-    }
-
-    pplayer->wonders[improvement_index(pimprove)] = wonder_city_id;
-  }
+  city_speculation_end(&spec);
 
   return final_want;
 }
@@ -1569,12 +1557,15 @@ static adv_want base_want(struct ai_type *ait, struct player *pplayer,
 
    IDEA: Calculate per-continent aggregates of various data, and use this
    for wonders below for better wonder placements.
+
+   'base' is the base_want() of the improvement in the city.
  */
 static void adjust_improvement_wants_by_effects(struct ai_type *ait,
                                                 struct player *pplayer,
                                                 struct city *pcity,
                                                 struct impr_type *pimprove,
-                                                const bool already)
+                                                const bool already,
+                                                adv_want base)
 {
   adv_want v = 0;
   int cities[REQ_RANGE_COUNT];
@@ -1609,7 +1600,7 @@ static void adjust_improvement_wants_by_effects(struct ai_type *ait,
     v += float(TRADE_WEIGHTING) / 10;
   } else {
     // Base want is calculated above using a more direct approach.
-    v += base_want(ait, pplayer, pcity, pimprove);
+    v += base;
     if (v != 0) {
       CITY_LOG(LOG_DEBUG, pcity,
                "%s base_want is " ADV_WANT_PRINTF " (range=%d)",
@@ -1944,6 +1935,10 @@ void dai_build_adv_init(struct ai_type *ait, struct player *pplayer)
 void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
                           struct city *wonder_city)
 {
+  struct adv_data *adv = adv_data_get(pplayer, nullptr);
+  QHash<int, QVector<adv_want>> base_wants;
+  QThreadPool pool;
+
   /* Clear old building wants.
    * Do this separately from the iteration over improvement types
    * because each iteration could actually update more than one improvement,
@@ -1974,6 +1969,46 @@ void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
   }
   city_list_iterate_end;
 
+  /* The base wants only read the game state. They are the expensive part,
+   * so they are all measured up front, using game.server.ai_threads
+   * worker threads. The slots are allocated before any job starts. */
+  city_list_iterate(pplayer->cities, pcity)
+  {
+    if (def_ai_city_data(pcity, ait)->building_turn <= game.info.turn) {
+      base_wants[pcity->id].fill(0, improvement_count());
+    }
+  }
+  city_list_iterate_end;
+
+  pool.setMaxThreadCount(game.server.ai_threads);
+  improvement_iterate(pimprove)
+  {
+    if (improvement_has_flag(pimprove, IF_GOLD)
+        || !can_player_build_improvement_later(pplayer, pimprove)) {
+      continue;
+    }
+    city_list_iterate(pplayer->cities, pcity)
+    {
+      adv_want *pwant;
+
+      if (!base_wants.contains(pcity->id)
+          || (pcity != wonder_city && is_wonder(pimprove))) {
+        continue;
+      }
+      pwant = &base_wants[pcity->id][improvement_index(pimprove)];
+      if (game.server.ai_threads <= 1) {
+        *pwant = base_want(ait, pplayer, pcity, pimprove, adv);
+      } else {
+        pool.start([=]() {
+          *pwant = base_want(ait, pplayer, pcity, pimprove, adv);
+        });
+      }
+    }
+    city_list_iterate_end;
+  }
+  improvement_iterate_end;
+  pool.waitForDone();
+
   improvement_iterate(pimprove)
   {
     const bool is_coinage = improvement_has_flag(pimprove, IF_GOLD);
@@ -1996,8 +2031,9 @@ void dai_build_adv_adjust(struct ai_type *ait, struct player *pplayer,
           const bool already = city_has_building(pcity, pimprove);
           int idx = improvement_index(pimprove);
 
-          adjust_improvement_wants_by_effects(ait, pplayer, pcity, pimprove,
-                                              already);
+          adjust_improvement_wants_by_effects(
+              ait, pplayer, pcity, pimprove, already,
+              is_coinage ? 0 : base_wants[pcity->id][idx]);
 
           fc_assert(!(already && 0 < pcity->server.adv->building_want[idx]));
 
@@ -11,7 +11,9 @@
     \_____/ /                     If not, see https://www.gnu.org/licenses/.
       \____/        ********************************************************/
 
+#include <QThreadPool>
 #include <cstring>
+#include <vector>
 
 // utility
 #include "log.h"
@@ -30,6 +32,7 @@
 #include "pf_tools.h"
 
 // server
+#include "plrhand.h"
 #include "srv_log.h"
 #include "srv_main.h"
 
@@ -415,14 +418,97 @@ static int assess_danger_unit(const struct city *pcity,
 void dai_assess_danger_player(struct ai_type *ait, struct player *pplayer,
                               const struct civ_map *dmap)
 {
+  struct ai_plr *ai = def_ai_player_data(pplayer, ait);
+
   // Do nothing if game is not running
   if (S_S_RUNNING == server_state()) {
     city_list_iterate(pplayer->cities, pcity)
     {
-      (void) assess_danger(ait, pcity, dmap, nullptr);
+      if (ai->danger_scan.cities.contains(pcity->id)) {
+        // Scanned at phase start by dai_assess_danger_phase().
+        TIMING_LOG(AIT_DANGER, TIMER_START);
+        (void) assess_danger_apply(ait, pcity,
+                                   ai->danger_scan.cities.take(pcity->id));
+        TIMING_LOG(AIT_DANGER, TIMER_STOP);
+      } else {
+        (void) assess_danger(ait, pcity, dmap, nullptr);
+      }
+    }
+    city_list_iterate_end;
+  }
+}
+
+/**
+   Scan the threats to the cities of all the players of this phase that
+   are controlled by ait, using game.server.ai_threads worker threads.
+
+   The scans see the world as it is when the phase starts. The results are
+   applied later, one player at a time and in phase order, when
+   dai_assess_danger_player() gets called for each player. A city that
+   has changed hands in the meantime is scanned again at that point.
+ */
+void dai_assess_danger_phase(struct ai_type *ait,
+                             const struct civ_map *dmap)
+{
+  struct danger_job {
+    struct city *pcity;
+    const QVector<struct player *> *enemies;
+    QVector<struct dai_threat> threats;
+  };
+  QHash<const struct player *, QVector<struct player *>> enemies;
+  std::vector<struct danger_job> jobs;
+  QThreadPool pool;
+
+  if (S_S_RUNNING != server_state() || game.server.ai_threads <= 1) {
+    return;
+  }
+
+  // Everything that may ask the AI for its opinion is done up front.
+  phase_players_iterate(pplayer)
+  {
+    struct ai_plr *ai;
+
+    if (!is_ai(pplayer) || pplayer->ai != ait) {
+      continue;
+    }
+    ai = def_ai_player_data(pplayer, ait);
+    if (ai->danger_scan.done) {
+      continue;
+    }
+    ai->danger_scan.done = true;
+    ai->danger_scan.cities.clear();
+    enemies.insert(pplayer, assess_danger_enemies(pplayer));
+  }
+  phase_players_iterate_end;
+
+  // Filled in a second pass so that the enemy lists don't move anymore.
+  phase_players_iterate(pplayer)
+  {
+    if (!enemies.contains(pplayer)) {
+      continue;
+    }
+    city_list_iterate(pplayer->cities, pcity)
+    {
+      jobs.push_back({pcity, &enemies[pplayer], {}});
     }
     city_list_iterate_end;
   }
+  phase_players_iterate_end;
+
+  pool.setMaxThreadCount(game.server.ai_threads);
+  for (auto &job : jobs) {
+    pool.start([ait, dmap, &job]() {
+      assess_danger_scan(ait, job.pcity, dmap, nullptr, *job.enemies,
+                         &job.threats);
+    });
+  }
+  pool.waitForDone();
+
+  for (auto &job : jobs) {
+    struct ai_plr *ai = def_ai_player_data(city_owner(job.pcity), ait);
+
+    ai->danger_scan.cities.insert(job.pcity->id, std::move(job.threats));
+  }
 }
 
 /**
@@ -460,9 +546,101 @@ static void dai_reevaluate_building(struct city *pcity, adv_want *value,
   }
 }
 
+/**
+   Return the players whose units are considered a danger to the cities of
+   pplayer. Note that we still consider the units of players we are not
+   (yet) at war with.
+ */
+static QVector<struct player *>
+assess_danger_enemies(struct player *pplayer)
+{
+  QVector<struct player *> enemies;
+
+  players_iterate(aplayer)
+  {
+    if (adv_is_player_dangerous(pplayer, aplayer)) {
+      enemies.append(aplayer);
+    }
+  }
+  players_iterate_end;
+
+  return enemies;
+}
+
+/**
+   Find out which units of the enemies can reach pcity, how soon, and how
+   dangerous they are for it.
+
+   This is the expensive, read-only part of assess_danger(). It changes
+   neither the game nor the AI data, so it may run for several cities at
+   once as long as nothing modifies the world meanwhile.
+ */
+static void assess_danger_scan(struct ai_type *ait,
+                               const struct city *pcity,
+                               const struct civ_map *dmap,
+                               player_unit_list_getter ul_cb,
+                               const QVector<struct player *> &enemies,
+                               QVector<struct dai_threat> *threats)
+{
+  const struct player *pplayer = city_owner(pcity);
+  int assess_turns;
+  bool omnimap;
+
+  if (player_is_cpuhog(pplayer)) {
+    assess_turns = 6;
+  } else {
+    assess_turns = 3;
+  }
+
+  omnimap = !has_handicap(pplayer, H_MAP);
+
+  for (auto *aplayer : enemies) {
+    struct pf_reverse_map *pcity_map;
+    struct unit_list *units;
+
+    pcity_map = pf_reverse_map_new_for_city(pcity, aplayer, assess_turns,
+                                            omnimap, dmap);
+
+    if (ul_cb != nullptr) {
+      units = ul_cb(aplayer);
+    } else {
+      units = aplayer->units;
+    }
+    unit_list_iterate(units, punit)
+    {
+      struct dai_threat threat;
+      const struct unit_type *utype = unit_type_get(punit);
+      struct unit_type_ai *utai =
+          static_cast<unit_type_ai *>(utype_ai_data(utype, ait));
+
+      if (!utai->carries_occupiers && !utype_acts_hostile(utype)) {
+        // Harmless unit.
+        continue;
+      }
+
+      threat.vulnerability =
+          assess_danger_unit(pcity, pcity_map, punit, &threat.move_time);
+
+      if (PF_IMPOSSIBLE_MC == threat.move_time) {
+        continue;
+      }
+
+      threat.utype = utype;
+      threat.can_take_over = unit_can_take_over(punit);
+      threat.can_nuke = (unit_can_do_action(punit, ACTION_NUKE)
+                         || unit_can_do_action(punit, ACTION_NUKE_CITY)
+                         || unit_can_do_action(punit, ACTION_NUKE_UNITS));
+      threats->append(threat);
+    }
+    unit_list_iterate_end;
+
+    pf_reverse_map_destroy(pcity_map);
+  }
+}
+
 /**
    Create cached information about danger, urgency and grave danger to our
-   cities.
+   cities from the threats found by assess_danger_scan().
 
    Danger is a weight on how much power enemy units nearby have, which is
    compared to our defence.
@@ -478,9 +656,8 @@ static void dai_reevaluate_building(struct city *pcity, adv_want *value,
    afraid of a boat laden with enemies if it stands on the coast (i.e.
    is directly reachable by this boat).
  */
-static int assess_danger(struct ai_type *ait, struct city *pcity,
-                         const struct civ_map *dmap,
-                         player_unit_list_getter ul_cb)
+static int assess_danger_apply(struct ai_type *ait, struct city *pcity,
+                               const QVector<struct dai_threat> &threats)
 {
   struct player *pplayer = city_owner(pcity);
   struct tile *ptile = city_tile(pcity);
@@ -494,10 +671,6 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
   int total_danger = 0;
   int defense_bonuses_pct[U_LAST];
   bool defender_type_handled[U_LAST] = {false};
-  int assess_turns;
-  bool omnimap;
-
-  TIMING_LOG(AIT_DANGER, TIMER_START);
 
   // Initialize data.
   memset(&danger_reduced, 0, sizeof(danger_reduced));
@@ -550,105 +723,55 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
   }
   unit_list_iterate_end;
 
-  if (player_is_cpuhog(pplayer)) {
-    assess_turns = 6;
-  } else {
-    assess_turns = 3;
-  }
-
-  omnimap = !has_handicap(pplayer, H_MAP);
-
-  // Check.
-  players_iterate(aplayer)
-  {
-    struct pf_reverse_map *pcity_map;
-    struct unit_list *units;
-
-    if (!adv_is_player_dangerous(pplayer, aplayer)) {
-      continue;
+  for (const auto &threat : threats) {
+    int move_time = threat.move_time;
+    int vulnerability = threat.vulnerability;
+    int defbonus_pct;
+    const struct unit_type *utype = threat.utype;
+    struct unit_type_ai *utai =
+        static_cast<unit_type_ai *>(utype_ai_data(utype, ait));
+
+    if ((0 < vulnerability && threat.can_take_over)
+        || utai->carries_occupiers) {
+      if (3 >= move_time) {
+        urgency++;
+        if (1 >= move_time) {
+          city_data->grave_danger++;
+        }
+      }
     }
-    /* Note that we still consider the units of players we are not (yet)
-     * at war with. */
 
-    pcity_map = pf_reverse_map_new_for_city(pcity, aplayer, assess_turns,
-                                            omnimap, dmap);
-
-    if (ul_cb != nullptr) {
-      units = ul_cb(aplayer);
-    } else {
-      units = aplayer->units;
+    defbonus_pct = defense_bonuses_pct[utype_index(utype)];
+    if (defbonus_pct > 100) {
+      defbonus_pct = (defbonus_pct + 100) / 2;
     }
-    unit_list_iterate(units, punit)
-    {
-      int move_time;
-      int vulnerability;
-      int defbonus_pct;
-      const struct unit_type *utype = unit_type_get(punit);
-      struct unit_type_ai *utai =
-          static_cast<unit_type_ai *>(utype_ai_data(utype, ait));
+    vulnerability = vulnerability * 100 / (defbonus_pct + 100);
+    (void) dai_wants_defender_against(ait, pplayer, pcity, utype,
+                                      vulnerability / MAX(move_time, 1));
 
-      if (!utai->carries_occupiers && !utype_acts_hostile(utype)) {
-        // Harmless unit.
-        continue;
-      }
-
-      vulnerability =
-          assess_danger_unit(pcity, pcity_map, punit, &move_time);
-
-      if (PF_IMPOSSIBLE_MC == move_time) {
-        continue;
-      }
-
-      if ((0 < vulnerability && unit_can_take_over(punit))
-          || utai->carries_occupiers) {
-        if (3 >= move_time) {
-          urgency++;
-          if (1 >= move_time) {
-            city_data->grave_danger++;
-          }
-        }
-      }
-
-      defbonus_pct = defense_bonuses_pct[utype_index(utype)];
-      if (defbonus_pct > 100) {
-        defbonus_pct = (defbonus_pct + 100) / 2;
-      }
-      vulnerability = vulnerability * 100 / (defbonus_pct + 100);
-      (void) dai_wants_defender_against(ait, pplayer, pcity, utype,
-                                        vulnerability / MAX(move_time, 1));
+    if (utype_acts_hostile(utype) && 2 >= move_time) {
+      city_data->diplomat_threat = true;
+    }
 
-      if (utype_acts_hostile(unit_type_get(punit)) && 2 >= move_time) {
-        city_data->diplomat_threat = true;
-      }
+    vulnerability *= vulnerability; // positive feedback
+    if (1 < move_time) {
+      vulnerability /= move_time;
+    }
 
-      vulnerability *= vulnerability; // positive feedback
-      if (1 < move_time) {
-        vulnerability /= move_time;
+    if (threat.can_nuke) {
+      defender = dai_find_source_building(pcity, EFT_NUKE_PROOF, utype);
+      if (defender != B_LAST) {
+        danger_reduced[defender] += vulnerability / MAX(move_time, 1);
       }
-
-      if (unit_can_do_action(punit, ACTION_NUKE)
-          || unit_can_do_action(punit, ACTION_NUKE_CITY)
-          || unit_can_do_action(punit, ACTION_NUKE_UNITS)) {
-        defender = dai_find_source_building(pcity, EFT_NUKE_PROOF,
-                                            unit_type_get(punit));
-        if (defender != B_LAST) {
-          danger_reduced[defender] += vulnerability / MAX(move_time, 1);
-        }
-      } else {
-        defender = dai_find_source_building(pcity, EFT_DEFEND_BONUS,
-                                            unit_type_get(punit));
-        if (defender != B_LAST) {
-          danger_reduced[defender] += vulnerability / MAX(move_time, 1);
-        }
+    } else {
+      defender = dai_find_source_building(pcity, EFT_DEFEND_BONUS, utype);
+      if (defender != B_LAST) {
+        danger_reduced[defender] += vulnerability / MAX(move_time, 1);
       }
-
-      total_danger += vulnerability;
     }
-    unit_list_iterate_end;
 
-    pf_reverse_map_destroy(pcity_map);
+    total_danger += vulnerability;
   }
-  players_iterate_end;
 
   if (total_danger) {
     city_data->wallvalue = 90;
@@ -685,6 +808,26 @@ static int assess_danger(struct ai_type *ait, struct city *pcity,
   }
   city_data->urgency = urgency;
 
+  return urgency;
+}
+
+/**
+   Assess the danger to pcity and cache the results in its AI data.
+   See assess_danger_apply() for the meaning of the results.
+ */
+static int assess_danger(struct ai_type *ait, struct city *pcity,
+                         const struct civ_map *dmap,
+                         player_unit_list_getter ul_cb)
+{
+  QVector<struct dai_threat> threats;
+  int urgency;
+
+  TIMING_LOG(AIT_DANGER, TIMER_START);
+
+  assess_danger_scan(ait, pcity, dmap, ul_cb,
+                     assess_danger_enemies(city_owner(pcity)), &threats);
+  urgency = assess_danger_apply(ait, pcity, threats);
+
   TIMING_LOG(AIT_DANGER, TIMER_STOP);
 
   return urgency;
@@ -32,6 +32,8 @@ struct adv_choice *military_advisor_choose_build(
     const struct civ_map *mamap, player_unit_list_getter ul_cb);
 void dai_assess_danger_player(struct ai_type *ait, struct player *pplayer,
                               const struct civ_map *dmap);
+void dai_assess_danger_phase(struct ai_type *ait,
+                             const struct civ_map *dmap);
 int assess_defense_quadratic(struct ai_type *ait, struct city *pcity);
 int assess_defense_unit(struct ai_type *ait, struct city *pcity,
                         struct unit *punit, bool igwall);
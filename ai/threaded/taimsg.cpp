@@ -11,60 +11,90 @@
     \_____/ /                     If not, see https://www.gnu.org/licenses/.
       \____/        ********************************************************/
 
-#include <fc_config.h>
+// utility
+#include "log.h"
+
+// common
+#include "player.h"
+
+/* server/advisors */
+#include "advdata.h"
 
 /* ai/threaded */
 #include "taiplayer.h"
 
 #include "taimsg.h"
 
-/**********************************************************************/ /**
-   Construct and send message to player thread.
- **************************************************************************/
+/**
+   Construct and send message to player thread. Caller must make sure that
+   the thread is running, as nobody would ever free the data otherwise.
+ */
 void tai_send_msg(enum taimsgtype type, struct player *pplayer, void *data)
 {
   struct tai_msg *msg;
 
-  if (!tai_thread_running()) {
-    /* No player thread to send messages to */
-    return;
-  }
-
-  msg = fc_malloc(sizeof(*msg));
+  fc_assert_ret(tai_thread_running());
 
+  msg = new tai_msg;
   msg->type = type;
-  msg->plr = pplayer;
+  msg->plrno = (pplayer != nullptr ? player_number(pplayer) : -1);
   msg->data = data;
 
   tai_msg_to_thr(msg);
 }
 
-/**********************************************************************/ /**
+/**
    Construct and send request from player thread.
- **************************************************************************/
-void tai_send_req(enum taireqtype type, struct player *pplayer, void *data)
+ */
+void tai_send_req(enum taireqtype type, int plrno, void *data)
 {
-  struct tai_req *req = fc_malloc(sizeof(*req));
+  struct tai_req *req = new tai_req;
 
   req->type = type;
-  req->plr = pplayer;
+  req->plrno = plrno;
   req->data = data;
 
   tai_req_from_thr(req);
 }
 
-/**********************************************************************/ /**
-   Time for phase first activities
- **************************************************************************/
+/**
+   Time for phase first activities. Hand the danger scan over to the
+   thread; units are moved once it reports back.
+ */
 void tai_first_activities(struct ai_type *ait, struct player *pplayer)
 {
-  tai_send_msg(TAI_MSG_FIRST_ACTIVITIES, pplayer, NULL);
+  struct tai_plr *plr_data = tai_player_data(ait, pplayer);
+  auto *data = new tai_first_activities_msg;
+
+  data->stamp = ++plr_data->stamp;
+  if (player_is_cpuhog(pplayer)) {
+    data->assess_turns = 6;
+  } else {
+    data->assess_turns = 3;
+  }
+  players_iterate(aplayer)
+  {
+    if (adv_is_player_dangerous(pplayer, aplayer)) {
+      data->enemies.append(player_number(aplayer));
+    }
+  }
+  players_iterate_end;
+
+  plr_data->activities_pending = true;
+  // Keep the default AI from scanning these cities itself.
+  plr_data->defai.danger_scan.done = true;
+
+  tai_send_msg(TAI_MSG_FIRST_ACTIVITIES, pplayer, data);
 }
 
-/**********************************************************************/ /**
+/**
    Player phase has finished
- **************************************************************************/
+ */
 void tai_phase_finished(struct ai_type *ait, struct player *pplayer)
 {
-  tai_send_msg(TAI_MSG_PHASE_FINISHED, pplayer, NULL);
+  Q_UNUSED(ait)
+
+  if (tai_thread_running()) {
+    tai_send_msg(TAI_MSG_PHASE_FINISHED, pplayer, nullptr);
+  }
 }
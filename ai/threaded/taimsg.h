@@ -12,6 +12,14 @@
       \____/        ********************************************************/
 #pragma once
 
+#include <QVector>
+
+/* ai/default */
+#include "aidata.h"
+
+struct ai_type;
+struct player;
+
 #define SPECENUM_NAME taimsgtype
 #define SPECENUM_VALUE0 TAI_MSG_THR_EXIT
 #define SPECENUM_VALUE0NAME "Exit"
@@ -19,37 +27,74 @@
 #define SPECENUM_VALUE1NAME "FirstActivities"
 #define SPECENUM_VALUE2 TAI_MSG_PHASE_FINISHED
 #define SPECENUM_VALUE2NAME "PhaseFinished"
+#define SPECENUM_VALUE3 TAI_MSG_MAP_ALLOC
+#define SPECENUM_VALUE3NAME "MapAlloc"
+#define SPECENUM_VALUE4 TAI_MSG_MAP_FREE
+#define SPECENUM_VALUE4NAME "MapFree"
+#define SPECENUM_VALUE5 TAI_MSG_TILE_INFO
+#define SPECENUM_VALUE5NAME "TileInfo"
+#define SPECENUM_VALUE6 TAI_MSG_CITY_CREATED
+#define SPECENUM_VALUE6NAME "CityCreated"
+#define SPECENUM_VALUE7 TAI_MSG_CITY_CHANGED
+#define SPECENUM_VALUE7NAME "CityChanged"
+#define SPECENUM_VALUE8 TAI_MSG_CITY_DESTROYED
+#define SPECENUM_VALUE8NAME "CityDestroyed"
+#define SPECENUM_VALUE9 TAI_MSG_UNIT_CREATED
+#define SPECENUM_VALUE9NAME "UnitCreated"
+#define SPECENUM_VALUE10 TAI_MSG_UNIT_CHANGED
+#define SPECENUM_VALUE10NAME "UnitChanged"
+#define SPECENUM_VALUE11 TAI_MSG_UNIT_MOVED
+#define SPECENUM_VALUE11NAME "UnitMoved"
+#define SPECENUM_VALUE12 TAI_MSG_UNIT_DESTROYED
+#define SPECENUM_VALUE12NAME "UnitDestroyed"
 #include "specenum_gen.h"
 
 #define SPECENUM_NAME taireqtype
-#define SPECENUM_VALUE0 TAI_REQ_WORKER_TASK
-#define SPECENUM_VALUE0NAME "WorkerTask"
+#define SPECENUM_VALUE0 TAI_REQ_CITY_THREATS
+#define SPECENUM_VALUE0NAME "CityThreats"
 #define SPECENUM_VALUE1 TAI_REQ_TURN_DONE
 #define SPECENUM_VALUE1NAME "TurnDone"
 #include "specenum_gen.h"
 
+/* Messages go from the main thread to the AI thread, requests the other
+ * way round. The data is owned by the receiver, which must delete it as
+ * the type matching the message type. Players are passed by number so
+ * that the AI thread never touches the real player structures. */
 struct tai_msg {
   enum taimsgtype type;
-  struct player *plr;
+  int plrno;
   void *data;
 };
 
 struct tai_req {
   enum taireqtype type;
-  struct player *plr;
+  int plrno;
   void *data;
 };
 
-#define SPECLIST_TAG taimsg
-#define SPECLIST_TYPE struct tai_msg
-#include "speclist.h"
+// Payload of TAI_MSG_FIRST_ACTIVITIES.
+struct tai_first_activities_msg {
+  int stamp;
+  int assess_turns;
+  QVector<int> enemies; // Numbers of the players considered dangerous
+};
 
-#define SPECLIST_TAG taireq
-#define SPECLIST_TYPE struct tai_req
-#include "speclist.h"
+// Payload of TAI_REQ_CITY_THREATS.
+struct tai_city_threats_req {
+  int stamp;
+  int city_id;
+  QVector<struct dai_threat> threats;
+};
+
+// Payload of TAI_REQ_TURN_DONE.
+struct tai_turn_done_req {
+  int stamp;
+  int cities;
+  qint64 msec; // Time the AI thread spent scanning
+};
 
 void tai_send_msg(enum taimsgtype type, struct player *pplayer, void *data);
-void tai_send_req(enum taireqtype type, struct player *pplayer, void *data);
+void tai_send_req(enum taireqtype type, int plrno, void *data);
 
 void tai_first_activities(struct ai_type *ait, struct player *pplayer);
 void tai_phase_finished(struct ai_type *ait, struct player *pplayer);
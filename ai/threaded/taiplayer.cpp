@@ -0,0 +1,472 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QWaitCondition>
+
+// utility
+#include "fcthread.h"
+#include "log.h"
+
+// common
+#include "city.h"
+#include "effects.h"
+#include "game.h"
+#include "movement.h"
+
+// server
+#include "srv_main.h"
+
+/* ai/default */
+#include "aihand.h"
+#include "aiplayer.h"
+
+/* ai/threaded */
+#include "taiworld.h"
+
+#include "taiplayer.h"
+
+/* What level of operation we should abort because
+ * of received messages. Lower is more critical;
+ * TAI_ABORT_EXIT means that whole thread should exit,
+ * TAI_ABORT_NONE means that we can continue what we were doing */
+enum tai_abort_msg_class {
+  TAI_ABORT_EXIT,
+  TAI_ABORT_PHASE_END,
+  TAI_ABORT_NONE
+};
+
+struct tai_msgs {
+  QWaitCondition thr_cond;
+  QMutex mutex;
+  QQueue<struct tai_msg *> msglist;
+};
+
+struct tai_reqs {
+  QMutex mutex;
+  QQueue<struct tai_req *> reqlist;
+};
+
+static struct tai_thr {
+  struct ai_type *ait;
+  int num_players;
+  struct tai_msgs msgs_to;
+  struct tai_reqs reqs_from;
+  bool thread_running;
+  // Set when a message that ends the current scan has been queued.
+  QAtomicInt aborting;
+} thrai;
+
+Q_GLOBAL_STATIC(fcThread, tai_thread);
+
+/**
+   Initialize ai thread.
+ */
+void tai_init_threading()
+{
+  thrai.thread_running = false;
+
+  thrai.num_players = 0;
+}
+
+/**
+   Handle first activities message in the thread: scan the threats to
+   each city of the player in the world of the thread, and send them
+   back one city at a time.
+ */
+static void tai_first_activities_scan(struct ai_type *ait,
+                                      struct tai_msg *msg)
+{
+  auto *data = static_cast<struct tai_first_activities_msg *>(msg->data);
+  QVector<int> cities = tai_world_player_cities(msg->plrno);
+  QElapsedTimer timer;
+  struct tai_turn_done_req *done;
+
+  timer.start();
+
+  for (int city_id : qAsConst(cities)) {
+    struct tai_city_threats_req *req;
+
+    if (tai_thread_aborting()) {
+      // Phase is over already, don't bother finishing.
+      delete data;
+      return;
+    }
+
+    req = new tai_city_threats_req;
+    req->stamp = data->stamp;
+    req->city_id = city_id;
+    tai_world_city_threats(ait, city_id, data->enemies, data->assess_turns,
+                           &req->threats);
+    tai_send_req(TAI_REQ_CITY_THREATS, msg->plrno, req);
+  }
+
+  done = new tai_turn_done_req;
+  done->stamp = data->stamp;
+  done->cities = cities.size();
+  done->msec = timer.elapsed();
+  tai_send_req(TAI_REQ_TURN_DONE, msg->plrno, done);
+
+  delete data;
+}
+
+/**
+   Handle one message from the main thread.
+ */
+static enum tai_abort_msg_class tai_handle_message(struct ai_type *ait,
+                                                   struct tai_msg *msg)
+{
+  log_debug("Plr thr got %s", taimsgtype_name(msg->type));
+
+  if (tai_world_msg_recv(msg)) {
+    return TAI_ABORT_NONE;
+  }
+
+  switch (msg->type) {
+  case TAI_MSG_FIRST_ACTIVITIES:
+    tai_first_activities_scan(ait, msg);
+    return TAI_ABORT_NONE;
+  case TAI_MSG_PHASE_FINISHED:
+    thrai.aborting = 0;
+    return TAI_ABORT_PHASE_END;
+  case TAI_MSG_THR_EXIT:
+    return TAI_ABORT_EXIT;
+  default:
+    qCritical("Illegal message type %s (%d) for threaded ai!",
+              taimsgtype_name(msg->type), msg->type);
+    return TAI_ABORT_NONE;
+  }
+}
+
+/**
+   This is main function of ai thread.
+ */
+static void tai_thread_start(void *arg)
+{
+  auto *ait = static_cast<struct ai_type *>(arg);
+  bool finished = false;
+
+  log_debug("New AI thread launched");
+
+  tai_world_init();
+
+  while (!finished) {
+    struct tai_msg *msg;
+
+    {
+      QMutexLocker locker(&thrai.msgs_to.mutex);
+
+      while (thrai.msgs_to.msglist.isEmpty()) {
+        thrai.msgs_to.thr_cond.wait(&thrai.msgs_to.mutex);
+      }
+      msg = thrai.msgs_to.msglist.dequeue();
+    }
+
+    if (tai_handle_message(ait, msg) <= TAI_ABORT_EXIT) {
+      finished = true;
+    }
+
+    delete msg;
+  }
+
+  tai_world_close();
+
+  log_debug("AI thread exiting");
+}
+
+/**
+   Stop the thread and drop whatever is still queued either way.
+ */
+static void tai_thread_stop()
+{
+  tai_msg_to_thr(new tai_msg{TAI_MSG_THR_EXIT, -1, nullptr});
+  tai_thread->wait();
+  thrai.thread_running = false;
+  thrai.aborting = 0;
+
+  /* Whatever is left are world updates and requests nobody waits for
+   * anymore. */
+  for (auto *msg : qAsConst(thrai.msgs_to.msglist)) {
+    if (!tai_world_msg_free(msg)
+        && msg->type == TAI_MSG_FIRST_ACTIVITIES) {
+      delete static_cast<struct tai_first_activities_msg *>(msg->data);
+    }
+    delete msg;
+  }
+  thrai.msgs_to.msglist.clear();
+  for (auto *req : qAsConst(thrai.reqs_from.reqlist)) {
+    switch (req->type) {
+    case TAI_REQ_CITY_THREATS:
+      delete static_cast<struct tai_city_threats_req *>(req->data);
+      break;
+    case TAI_REQ_TURN_DONE:
+      delete static_cast<struct tai_turn_done_req *>(req->data);
+      break;
+    }
+    delete req;
+  }
+  thrai.reqs_from.reqlist.clear();
+}
+
+/**
+   Stop the thread if it's still running when the module is closed.
+ */
+void tai_close_threading()
+{
+  if (thrai.thread_running) {
+    tai_thread_stop();
+  }
+}
+
+/**
+   Initialize player for use with threaded AI.
+ */
+void tai_player_alloc(struct ai_type *ait, struct player *pplayer)
+{
+  struct tai_plr *player_data = new tai_plr{};
+
+  player_set_ai_data(pplayer, ait, player_data);
+
+  // Default AI
+  dai_data_init(ait, pplayer);
+}
+
+/**
+   Free player from use with threaded AI.
+ */
+void tai_player_free(struct ai_type *ait, struct player *pplayer)
+{
+  struct tai_plr *player_data = tai_player_data(ait, pplayer);
+
+  // Default AI
+  dai_data_close(ait, pplayer);
+
+  if (player_data != nullptr) {
+    player_set_ai_data(pplayer, ait, nullptr);
+    delete player_data;
+    player_data = nullptr;
+  }
+}
+
+/**
+   We actually control the player
+ */
+void tai_control_gained(struct ai_type *ait, struct player *pplayer)
+{
+  thrai.num_players++;
+
+  log_debug("%s now under threaded AI (%d)", pplayer->name,
+            thrai.num_players);
+
+  if (!thrai.thread_running) {
+    thrai.thread_running = true;
+    thrai.ait = ait;
+
+    tai_thread->set_func(tai_thread_start, ait);
+    tai_thread->start(QThread::NormalPriority);
+
+    tai_world_sync();
+  }
+}
+
+/**
+   We no longer control the player
+ */
+void tai_control_lost(struct ai_type *ait, struct player *pplayer)
+{
+  struct tai_plr *plr_data = tai_player_data(ait, pplayer);
+
+  thrai.num_players--;
+  plr_data->activities_pending = false;
+
+  log_debug("%s no longer under threaded AI (%d)", pplayer->name,
+            thrai.num_players);
+
+  if (thrai.num_players <= 0 && thrai.thread_running) {
+    tai_thread_stop();
+  }
+}
+
+/**
+   Main thread receives the threats the thread found to a city. The parts
+   that depend on the real game state are checked here.
+ */
+static void tai_city_threats_rcv(struct ai_type *ait,
+                                 struct player *pplayer,
+                                 struct tai_city_threats_req *data)
+{
+  struct tai_plr *plr_data = tai_player_data(ait, pplayer);
+  struct city *pcity = game_city_by_number(data->city_id);
+  struct tile *ptile;
+  QVector<struct dai_threat> threats;
+
+  if (pcity == nullptr || city_owner(pcity) != pplayer) {
+    // City has been lost meanwhile
+    return;
+  }
+
+  ptile = city_tile(pcity);
+  for (auto threat : qAsConst(data->threats)) {
+    int mod;
+
+    if (!is_native_tile(threat.utype, ptile)
+        && !can_attack_non_native(threat.utype)) {
+      continue;
+    }
+    if (!is_native_near_tile(&(wld.map), utype_class(threat.utype),
+                             ptile)) {
+      continue;
+    }
+
+    mod = 100
+          + get_unittype_bonus(pplayer, ptile, threat.utype,
+                               EFT_DEFEND_BONUS);
+    threat.vulnerability = threat.vulnerability * 100 / MAX(mod, 1);
+    threats.append(threat);
+  }
+
+  plr_data->defai.danger_scan.cities.insert(pcity->id, threats);
+}
+
+/**
+   Check for messages sent by player thread
+ */
+void tai_refresh(struct ai_type *ait, struct player *pplayer)
+{
+  Q_UNUSED(pplayer)
+
+  while (thrai.thread_running) {
+    struct tai_req *req;
+    struct player *rplayer;
+    struct tai_plr *plr_data = nullptr;
+
+    {
+      QMutexLocker locker(&thrai.reqs_from.mutex);
+
+      if (thrai.reqs_from.reqlist.isEmpty()) {
+        break;
+      }
+      req = thrai.reqs_from.reqlist.dequeue();
+    }
+
+    log_debug("Plr thr sent %s", taireqtype_name(req->type));
+
+    rplayer = player_by_number(req->plrno);
+    if (rplayer != nullptr && is_ai(rplayer) && rplayer->ai == ait) {
+      plr_data = tai_player_data(ait, rplayer);
+    }
+
+    switch (req->type) {
+    case TAI_REQ_CITY_THREATS: {
+      auto *data = static_cast<struct tai_city_threats_req *>(req->data);
+
+      if (plr_data != nullptr && plr_data->activities_pending
+          && plr_data->stamp == data->stamp) {
+        tai_city_threats_rcv(ait, rplayer, data);
+      }
+      delete data;
+    } break;
+    case TAI_REQ_TURN_DONE: {
+      auto *data = static_cast<struct tai_turn_done_req *>(req->data);
+
+      if (plr_data != nullptr && plr_data->activities_pending
+          && plr_data->stamp == data->stamp) {
+        log_time(QStringLiteral("Threaded AI %1: %2 cities scanned in %3 "
+                                "milliseconds on the AI thread")
+                     .arg(player_name(rplayer))
+                     .arg(data->cities)
+                     .arg(data->msec));
+        tai_first_activities_finish(ait, rplayer);
+      }
+      delete data;
+    } break;
+    }
+
+    delete req;
+  }
+}
+
+/**
+   Do the first activities of the phase that had to wait for the thread.
+   If the thread did not make it in time, the default AI scans the cities
+   that are still missing itself.
+ */
+void tai_first_activities_finish(struct ai_type *ait,
+                                 struct player *pplayer)
+{
+  struct tai_plr *plr_data = tai_player_data(ait, pplayer);
+  QElapsedTimer timer;
+
+  if (!plr_data->activities_pending) {
+    return;
+  }
+  plr_data->activities_pending = false;
+
+  timer.start();
+  dai_do_first_activities(ait, pplayer);
+  pplayer->ai_phase_done = true;
+  log_time(QStringLiteral("Threaded AI %1: first activities in %2 "
+                          "milliseconds on the main thread")
+               .arg(player_name(pplayer))
+               .arg(timer.elapsed()));
+
+  check_for_full_turn_done();
+}
+
+/**
+   Send message to thread. Be sure that thread is running so that messages
+   are not just piling up to the list without anybody reading them.
+ */
+void tai_msg_to_thr(struct tai_msg *msg)
+{
+  QMutexLocker locker(&thrai.msgs_to.mutex);
+
+  if (msg->type == TAI_MSG_PHASE_FINISHED
+      || msg->type == TAI_MSG_THR_EXIT) {
+    thrai.aborting = 1;
+  }
+  thrai.msgs_to.msglist.enqueue(msg);
+  thrai.msgs_to.thr_cond.wakeOne();
+}
+
+/**
+   Thread sends message. The main thread handles it as soon as it gets
+   back to its event loop instead of waiting for the next server pulse.
+ */
+void tai_req_from_thr(struct tai_req *req)
+{
+  QMutexLocker locker(&thrai.reqs_from.mutex);
+
+  thrai.reqs_from.reqlist.enqueue(req);
+  if (thrai.reqs_from.reqlist.size() == 1) {
+    // The main thread drains the whole list, so one wake-up is enough.
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(),
+        [] { tai_refresh(thrai.ait, nullptr); }, Qt::QueuedConnection);
+  }
+}
+
+/**
+   Return whether player thread is running
+ */
+bool tai_thread_running() { return thrai.thread_running; }
+
+/**
+   Return whether the thread should give up what it is doing, as a message
+   ending it is already waiting.
+ */
+bool tai_thread_aborting() { return thrai.aborting.loadRelaxed() != 0; }
@@ -12,9 +12,6 @@
       \____/        ********************************************************/
 #pragma once
 
-// utility
-#include "fcthread.h"
-
 // common
 #include "player.h"
 
@@ -26,29 +23,28 @@
 
 struct player;
 
-struct tai_msgs {
-  QWaitCondition thr_cond;
-  QMutex mutex;
-  struct taimsg_list *msglist;
-};
-
-struct tai_reqs {
-  struct taireq_list *reqlist;
-};
-
 struct tai_plr {
   struct ai_plr defai; // Keep this first so default ai finds it
+
+  /* Set while the first activities of the phase wait for the danger scan
+   * of the thread. Only requests carrying the current stamp are used. */
+  bool activities_pending;
+  int stamp;
 };
 
-void tai_init_threading(void);
+void tai_init_threading();
+void tai_close_threading();
 
-bool tai_thread_running(void);
+bool tai_thread_running();
+bool tai_thread_aborting();
 
 void tai_player_alloc(struct ai_type *ait, struct player *pplayer);
 void tai_player_free(struct ai_type *ait, struct player *pplayer);
 void tai_control_gained(struct ai_type *ait, struct player *pplayer);
 void tai_control_lost(struct ai_type *ait, struct player *pplayer);
 void tai_refresh(struct ai_type *ait, struct player *pplayer);
+void tai_first_activities_finish(struct ai_type *ait,
+                                 struct player *pplayer);
 
 void tai_msg_to_thr(struct tai_msg *msg);
 
@@ -57,5 +53,5 @@ void tai_req_from_thr(struct tai_req *req);
 static inline struct tai_plr *tai_player_data(struct ai_type *ait,
                                               const struct player *pplayer)
 {
-  return (struct tai_plr *) player_ai_data(pplayer, ait);
+  return static_cast<struct tai_plr *>(player_ai_data(pplayer, ait));
 }
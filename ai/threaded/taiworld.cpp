@@ -0,0 +1,572 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#include <functional>
+#include <map>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// common
+#include "city.h"
+#include "game.h"
+#include "map.h"
+#include "movement.h"
+#include "player.h"
+#include "unit.h"
+#include "unittype.h"
+
+/* server/advisors */
+#include "advgoto.h"
+
+/* ai/default */
+#include "aidata.h"
+#include "aiunit.h"
+
+/* ai/threaded */
+#include "taimsg.h"
+#include "taiplayer.h"
+
+#include "taiworld.h"
+
+struct tai_city_mirror {
+  int owner;
+  int tindex;
+  int size;
+};
+
+struct tai_unit_mirror {
+  int owner;
+  int tindex;
+  const struct unit_type *utype;
+  int veteran;
+  int hp;
+  int transporter; // Unit id, 0 if not transported.
+};
+
+/* The world as the AI thread sees it. It is only ever touched by the AI
+ * thread, and only changed by the messages the main thread sends. The
+ * tiles carry just enough for map distances, continents and move costs.
+ * The map has the geometry of the main map, but its tiles are the ones
+ * of the thread, so that the map iterators can be used on them. */
+static struct {
+  struct civ_map map;
+  std::vector<struct tile> tiles;
+  std::map<int, struct tai_city_mirror> cities;
+  std::map<int, struct tai_unit_mirror> units;
+} tai_world;
+
+struct tai_tile_info_msg {
+  int index;
+  struct terrain *terrain;
+  bv_extras extras;
+  Continent_id continent;
+};
+
+struct tai_map_msg {
+  struct civ_map map;
+  std::vector<struct tai_tile_info_msg> tiles;
+};
+
+struct tai_city_info_msg {
+  int id;
+  struct tai_city_mirror city;
+};
+
+struct tai_unit_info_msg {
+  int id;
+  struct tai_unit_mirror unit;
+};
+
+struct tai_id_msg {
+  int id;
+};
+
+/**
+   Fill tile update message from main map tile.
+ */
+static void tai_tile_info_fill(struct tai_tile_info_msg *info,
+                               const struct tile *ptile)
+{
+  info->index = tile_index(ptile);
+  info->terrain = tile_terrain(ptile);
+  info->extras = *tile_extras(ptile);
+  info->continent = tile_continent(ptile);
+}
+
+/**
+   Send the whole main map, and all the cities and units on it, to the
+   thread. Used when the thread starts and when a new map is ready.
+ */
+void tai_world_sync()
+{
+  struct tai_map_msg *info;
+
+  if (!tai_thread_running() || wld.map.tiles == nullptr) {
+    return;
+  }
+
+  info = new tai_map_msg;
+  // Only the geometry, nothing the thread must not touch.
+  info->map = wld.map;
+  info->map.tiles = nullptr;
+  info->map.startpos_table = nullptr;
+  info->map.iterate_outwards_indices = nullptr;
+  info->map.num_iterate_outwards_indices = 0;
+  info->tiles.resize(MAP_INDEX_SIZE);
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    tai_tile_info_fill(&info->tiles[tile_index(ptile)], ptile);
+  }
+  whole_map_iterate_end;
+  tai_send_msg(TAI_MSG_MAP_ALLOC, nullptr, info);
+
+  players_iterate(pplayer)
+  {
+    city_list_iterate(pplayer->cities, pcity) { tai_city_created(pcity); }
+    city_list_iterate_end;
+    unit_list_iterate(pplayer->units, punit) { tai_unit_created(punit); }
+    unit_list_iterate_end;
+  }
+  players_iterate_end;
+}
+
+/**
+   Main map is going away. Tell the thread to forget its copy.
+ */
+void tai_map_free()
+{
+  if (tai_thread_running()) {
+    tai_send_msg(TAI_MSG_MAP_FREE, nullptr, nullptr);
+  }
+}
+
+/**
+   Tile info updated on main map. Send update to the thread.
+ */
+void tai_tile_info(struct tile *ptile)
+{
+  if (tai_thread_running()) {
+    auto *info = new tai_tile_info_msg;
+
+    tai_tile_info_fill(info, ptile);
+    tai_send_msg(TAI_MSG_TILE_INFO, nullptr, info);
+  }
+}
+
+/**
+   Send city information to the thread.
+ */
+static void tai_city_update(struct city *pcity, enum taimsgtype msgtype)
+{
+  if (tai_thread_running()) {
+    auto *info = new tai_city_info_msg;
+
+    info->id = pcity->id;
+    info->city.owner = player_number(city_owner(pcity));
+    info->city.tindex = tile_index(city_tile(pcity));
+    info->city.size = city_size_get(pcity);
+
+    tai_send_msg(msgtype, nullptr, info);
+  }
+}
+
+/**
+   New city has been added to the main map.
+ */
+void tai_city_created(struct city *pcity)
+{
+  tai_city_update(pcity, TAI_MSG_CITY_CREATED);
+}
+
+/**
+   City on main map has (potentially) changed.
+ */
+void tai_city_changed(struct city *pcity)
+{
+  tai_city_update(pcity, TAI_MSG_CITY_CHANGED);
+}
+
+/**
+   City has been removed from the main map.
+ */
+void tai_city_destroyed(struct city *pcity)
+{
+  if (tai_thread_running()) {
+    auto *info = new tai_id_msg;
+
+    info->id = pcity->id;
+    tai_send_msg(TAI_MSG_CITY_DESTROYED, nullptr, info);
+  }
+}
+
+/**
+   Send unit information to the thread.
+ */
+static void tai_unit_update(struct unit *punit, enum taimsgtype msgtype)
+{
+  if (tai_thread_running()) {
+    auto *info = new tai_unit_info_msg;
+
+    info->id = punit->id;
+    info->unit.owner = player_number(unit_owner(punit));
+    info->unit.tindex = tile_index(unit_tile(punit));
+    info->unit.utype = unit_type_get(punit);
+    info->unit.veteran = punit->veteran;
+    info->unit.hp = punit->hp;
+    info->unit.transporter =
+        unit_transported(punit) ? unit_transport_get(punit)->id : 0;
+
+    tai_send_msg(msgtype, nullptr, info);
+  }
+}
+
+/**
+   New unit has been added to the main map.
+ */
+void tai_unit_created(struct unit *punit)
+{
+  tai_unit_update(punit, TAI_MSG_UNIT_CREATED);
+}
+
+/**
+   Unit (potentially) changed in main map.
+ */
+void tai_unit_changed(struct unit *punit)
+{
+  tai_unit_update(punit, TAI_MSG_UNIT_CHANGED);
+}
+
+/**
+   Unit has moved in the main map.
+ */
+void tai_unit_move_seen(struct unit *punit)
+{
+  tai_unit_update(punit, TAI_MSG_UNIT_MOVED);
+}
+
+/**
+   Unit has been removed from the main map.
+ */
+void tai_unit_destroyed(struct unit *punit)
+{
+  if (tai_thread_running()) {
+    auto *info = new tai_id_msg;
+
+    info->id = punit->id;
+    tai_send_msg(TAI_MSG_UNIT_DESTROYED, nullptr, info);
+  }
+}
+
+/**
+   Initialize the world of the thread. Called in the thread.
+ */
+void tai_world_init() { tai_world_close(); }
+
+/**
+   Free the world of the thread. Called in the thread.
+ */
+void tai_world_close()
+{
+  tai_world.map.tiles = nullptr;
+  tai_world.tiles.clear();
+  tai_world.tiles.shrink_to_fit();
+  tai_world.cities.clear();
+  tai_world.units.clear();
+}
+
+/**
+   Return the tile of the world of the thread with the given index, or
+   nullptr if there is no such tile.
+ */
+static struct tile *tai_world_tile(int tindex)
+{
+  if (tindex < 0 || tindex >= static_cast<int>(tai_world.tiles.size())) {
+    return nullptr;
+  }
+
+  return &tai_world.tiles[tindex];
+}
+
+/**
+   Copy tile information to the world of the thread.
+ */
+static void tai_tile_info_set(const struct tai_tile_info_msg *info)
+{
+  struct tile *ptile = tai_world_tile(info->index);
+
+  if (ptile != nullptr) {
+    ptile->terrain = info->terrain;
+    ptile->extras = info->extras;
+    ptile->continent = info->continent;
+  }
+}
+
+/**
+   Apply message to the world of the thread. Returns whether the message
+   was a world update at all. Called in the thread.
+ */
+bool tai_world_msg_recv(struct tai_msg *msg)
+{
+  switch (msg->type) {
+  case TAI_MSG_MAP_ALLOC: {
+    auto *info = static_cast<struct tai_map_msg *>(msg->data);
+
+    // A new map, or the same one again: start over either way.
+    tai_world.cities.clear();
+    tai_world.units.clear();
+    tai_world.tiles.assign(info->tiles.size(), tile());
+    for (size_t i = 0; i < info->tiles.size(); i++) {
+      tai_world.tiles[i].index = i;
+      tai_tile_info_set(&info->tiles[i]);
+    }
+    tai_world.map = info->map;
+    tai_world.map.tiles = tai_world.tiles.data();
+    delete info;
+  } break;
+  case TAI_MSG_MAP_FREE:
+    tai_world_close();
+    break;
+  case TAI_MSG_TILE_INFO: {
+    auto *info = static_cast<struct tai_tile_info_msg *>(msg->data);
+
+    tai_tile_info_set(info);
+    delete info;
+  } break;
+  case TAI_MSG_CITY_CREATED:
+  case TAI_MSG_CITY_CHANGED: {
+    auto *info = static_cast<struct tai_city_info_msg *>(msg->data);
+
+    tai_world.cities[info->id] = info->city;
+    delete info;
+  } break;
+  case TAI_MSG_CITY_DESTROYED: {
+    auto *info = static_cast<struct tai_id_msg *>(msg->data);
+
+    tai_world.cities.erase(info->id);
+    delete info;
+  } break;
+  case TAI_MSG_UNIT_CREATED:
+  case TAI_MSG_UNIT_CHANGED:
+  case TAI_MSG_UNIT_MOVED: {
+    auto *info = static_cast<struct tai_unit_info_msg *>(msg->data);
+
+    tai_world.units[info->id] = info->unit;
+    delete info;
+  } break;
+  case TAI_MSG_UNIT_DESTROYED: {
+    auto *info = static_cast<struct tai_id_msg *>(msg->data);
+
+    tai_world.units.erase(info->id);
+    delete info;
+  } break;
+  default:
+    return false;
+  }
+
+  return true;
+}
+
+/**
+   Free the data of a world update message that was never received.
+   Returns whether the message was a world update at all.
+ */
+bool tai_world_msg_free(struct tai_msg *msg)
+{
+  switch (msg->type) {
+  case TAI_MSG_MAP_ALLOC:
+    delete static_cast<struct tai_map_msg *>(msg->data);
+    break;
+  case TAI_MSG_MAP_FREE:
+    break;
+  case TAI_MSG_TILE_INFO:
+    delete static_cast<struct tai_tile_info_msg *>(msg->data);
+    break;
+  case TAI_MSG_CITY_CREATED:
+  case TAI_MSG_CITY_CHANGED:
+    delete static_cast<struct tai_city_info_msg *>(msg->data);
+    break;
+  case TAI_MSG_CITY_DESTROYED:
+  case TAI_MSG_UNIT_DESTROYED:
+    delete static_cast<struct tai_id_msg *>(msg->data);
+    break;
+  case TAI_MSG_UNIT_CREATED:
+  case TAI_MSG_UNIT_CHANGED:
+  case TAI_MSG_UNIT_MOVED:
+    delete static_cast<struct tai_unit_info_msg *>(msg->data);
+    break;
+  default:
+    return false;
+  }
+
+  return true;
+}
+
+/**
+   Return the ids of the cities of the player in the world of the thread.
+ */
+QVector<int> tai_world_player_cities(int plrno)
+{
+  QVector<int> cities;
+
+  for (const auto &city : tai_world.cities) {
+    if (city.second.owner == plrno) {
+      cities.append(city.first);
+    }
+  }
+
+  return cities;
+}
+
+/**
+   Return the move cost for units of the type to get next to ctile, in
+   move fragments, from each tile of the world of the thread they can get
+   there from within max_cost. This is a reverse Dijkstra search from the
+   city over the mirrored tiles. It uses the terrain and road move costs
+   of tile_move_cost_ptrs() and passes native tiles of the unit class
+   only. Zones of control, borders and other units are not known to the
+   thread and are ignored.
+ */
+static std::map<int, int> tai_world_reach(const struct unit_type *utype,
+                                          const struct tile *ctile,
+                                          int max_cost)
+{
+  using tile_cost = std::pair<int, int>;
+  const struct unit_class *pclass = utype_class(utype);
+  std::map<int, int> reach;
+  std::priority_queue<tile_cost, std::vector<tile_cost>,
+                      std::greater<tile_cost>>
+      queue;
+
+  // Attacking from next to the city is enough.
+  reach[tile_index(ctile)] = 0;
+  queue.push({0, tile_index(ctile)});
+  while (!queue.empty()) {
+    tile_cost best = queue.top();
+    struct tile *ptile = &tai_world.tiles[best.second];
+
+    queue.pop();
+    if (best.first > reach[best.second]) {
+      // Already reached more cheaply.
+      continue;
+    }
+
+    adjc_iterate(&tai_world.map, ptile, atile)
+    {
+      int cost = best.first;
+      auto known = reach.find(tile_index(atile));
+
+      if (!is_native_tile_to_class(pclass, atile)) {
+        continue;
+      }
+      if (ptile != ctile) {
+        cost += tile_move_cost_ptrs(&tai_world.map, nullptr, utype, nullptr,
+                                    atile, ptile);
+      }
+      if (cost > max_cost
+          || (known != reach.end() && known->second <= cost)) {
+        continue;
+      }
+      reach[tile_index(atile)] = cost;
+      queue.push({cost, tile_index(atile)});
+    }
+    adjc_iterate_end;
+  }
+
+  return reach;
+}
+
+/**
+   Find the units of the enemies that threaten the city, in the world of
+   the thread. This is the counterpart of the reverse path-finding scan
+   of the default AI: the time to reach the city is the move cost found
+   by tai_world_reach() divided by the move rate. Transported units move
+   with their transport. Effects are left for the main thread to apply,
+   as they depend on the real game state.
+ */
+void tai_world_city_threats(struct ai_type *ait, int city_id,
+                            const QVector<int> &enemies, int assess_turns,
+                            QVector<struct dai_threat> *threats)
+{
+  auto city = tai_world.cities.find(city_id);
+  std::map<const struct unit_type *, std::map<int, int>> reaches;
+  struct tile *ctile;
+
+  if (city == tai_world.cities.end()) {
+    return;
+  }
+  ctile = tai_world_tile(city->second.tindex);
+  if (ctile == nullptr) {
+    return;
+  }
+
+  for (const auto &unit : tai_world.units) {
+    const struct tai_unit_mirror *punit = &unit.second;
+    const struct unit_type *utype = punit->utype;
+    const struct unit_type *mover = utype;
+    struct unit_type_ai *utai =
+        static_cast<unit_type_ai *>(utype_ai_data(utype, ait));
+    struct tile *utile;
+    struct dai_threat threat;
+    int move_rate;
+
+    if (!enemies.contains(punit->owner)) {
+      continue;
+    }
+    if (!utai->carries_occupiers && !utype_acts_hostile(utype)) {
+      // Harmless unit.
+      continue;
+    }
+
+    utile = tai_world_tile(punit->tindex);
+    if (utile == nullptr) {
+      continue;
+    }
+    if (punit->transporter != 0) {
+      auto ptrans = tai_world.units.find(punit->transporter);
+
+      if (ptrans != tai_world.units.end()) {
+        mover = ptrans->second.utype;
+      }
+    }
+
+    move_rate = MAX(mover->move_rate, SINGLE_MOVE);
+    auto reach = reaches.find(mover);
+    if (reach == reaches.end()) {
+      // Anything dearer takes more than assess_turns.
+      int max_cost = (assess_turns + 1) * move_rate - 1;
+
+      reach = reaches.emplace(mover, tai_world_reach(mover, ctile, max_cost))
+                  .first;
+    }
+    auto cost = reach->second.find(tile_index(utile));
+    if (cost == reach->second.end()) {
+      // Can't get there in time.
+      continue;
+    }
+
+    threat.move_time = cost->second / move_rate;
+    if (threat.move_time > assess_turns) {
+      continue;
+    }
+
+    threat.utype = utype;
+    threat.vulnerability = adv_unittype_att_rating(utype, punit->veteran,
+                                                   SINGLE_MOVE, punit->hp);
+    threat.can_take_over = utype_can_take_over(utype);
+    threat.can_nuke = (utype_can_do_action(utype, ACTION_NUKE)
+                       || utype_can_do_action(utype, ACTION_NUKE_CITY)
+                       || utype_can_do_action(utype, ACTION_NUKE_UNITS));
+    threats->append(threat);
+  }
+}
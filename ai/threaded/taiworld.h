@@ -0,0 +1,44 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+#pragma once
+
+#include <QVector>
+
+// common
+#include "fc_types.h"
+
+struct ai_type;
+struct dai_threat;
+struct tai_msg;
+
+// Main thread side: keep the mirror of the AI thread up to date.
+void tai_world_sync();
+void tai_map_free();
+void tai_tile_info(struct tile *ptile);
+void tai_city_created(struct city *pcity);
+void tai_city_changed(struct city *pcity);
+void tai_city_destroyed(struct city *pcity);
+void tai_unit_created(struct unit *punit);
+void tai_unit_changed(struct unit *punit);
+void tai_unit_move_seen(struct unit *punit);
+void tai_unit_destroyed(struct unit *punit);
+
+// AI thread side.
+void tai_world_init();
+void tai_world_close();
+bool tai_world_msg_recv(struct tai_msg *msg);
+bool tai_world_msg_free(struct tai_msg *msg);
+QVector<int> tai_world_player_cities(int plrno);
+void tai_world_city_threats(struct ai_type *ait, int city_id,
+                            const QVector<int> &enemies, int assess_turns,
+                            QVector<struct dai_threat> *threats);
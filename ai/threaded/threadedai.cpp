@@ -0,0 +1,797 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+// common
+#include "ai.h"
+#include "player.h"
+
+// server
+#include "srv_main.h"
+
+/* server/advisors */
+#include "advdata.h"
+#include "autosettlers.h"
+
+/* ai/default */
+#include "aidata.h"
+#include "aiferry.h"
+#include "aihand.h"
+#include "ailog.h"
+#include "aiplayer.h"
+#include "aisettler.h"
+#include "aitools.h"
+#include "aiunit.h"
+#include "daicity.h"
+#include "daidiplomacy.h"
+#include "daidomestic.h"
+#include "daimilitary.h"
+
+/* ai/threaded */
+#include "taimsg.h"
+#include "taiplayer.h"
+#include "taiworld.h"
+
+#include "threadedai.h"
+
+class PFPath;
+
+static struct ai_type *self = nullptr;
+
+/**
+   Set pointer to ai type of the threaded ai.
+ */
+static void tai_set_self(struct ai_type *ai)
+{
+  self = ai;
+
+  tai_init_threading();
+}
+
+/**
+   Get pointer to ai type of the threaded ai.
+ */
+static struct ai_type *tai_get_self() { return self; }
+
+/**
+   Free resources allocated by the threaded AI module
+ */
+static void twai_module_close()
+{
+  struct ai_type *ait = tai_get_self();
+
+  tai_close_threading();
+
+  delete static_cast<dai_private_data *>(ait->pprivate);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_player_alloc(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  tai_player_alloc(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_player_free(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  tai_player_free(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+   Threadedai stores information to "tai", apart from the default ai.
+ */
+static void twai_player_save_relations(struct player *pplayer,
+                                       struct player *other,
+                                       struct section_file *file, int plrno)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_player_save_relations(ait, "tai", pplayer, other, file, plrno);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_player_load_relations(struct player *pplayer,
+                                       struct player *other,
+                                       const struct section_file *file,
+                                       int plrno)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_player_load_relations(ait, "tai", pplayer, other, file, plrno);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_gained_control(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_gained_control(ait, pplayer);
+  tai_control_gained(ait, pplayer);
+}
+
+/**
+   Stop sending the player to the thread.
+ */
+static void twai_lost_control(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  tai_control_lost(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_split_by_civil_war(struct player *original,
+                                    struct player *created)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_assess_danger_player(ait, original, &(wld.map));
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_created_by_civil_war(struct player *original,
+                                      struct player *created)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_player_copy(ait, original, created);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_data_phase_begin(struct player *pplayer, bool is_new_phase)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_data_phase_begin(ait, pplayer, is_new_phase);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_data_phase_finished(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  tai_phase_finished(ait, pplayer);
+  dai_data_phase_finished(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_city_alloc(struct city *pcity)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_city_alloc(ait, pcity);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_city_free(struct city *pcity)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_city_free(ait, pcity);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_city_save(struct section_file *file,
+                           const struct city *pcity, const char *citystr)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_city_save(ait, "tai", file, pcity, citystr);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_city_load(const struct section_file *file,
+                           struct city *pcity, const char *citystr)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_city_load(ait, "tai", file, pcity, citystr);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_build_adv_override(struct city *pcity,
+                                    struct adv_choice *choice)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_build_adv_override(ait, pcity, choice);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_wonder_city_distance(struct player *pplayer,
+                                      struct adv_data *adv)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_wonder_city_distance(ait, pplayer, adv);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_build_adv_init(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_build_adv_init(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_build_adv_adjust(struct player *pplayer,
+                                  struct city *wonder_city)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_build_adv_adjust(ait, pplayer, wonder_city);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_gov_value(struct player *pplayer, struct government *gov,
+                           adv_want *val, bool *override)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_gov_value(ait, pplayer, gov, val, override);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_units_ruleset_init()
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_units_ruleset_init(ait);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_units_ruleset_close()
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_units_ruleset_close(ait);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_init(struct unit *punit)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_init(ait, punit);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_close(struct unit *punit)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_close(ait, punit);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_ferry_init_ferry(struct unit *ferry)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_ferry_init_ferry(ait, ferry);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_ferry_transformed(struct unit *ferry,
+                                   const struct unit_type *old)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_ferry_transformed(ait, ferry, old);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_ferry_lost(struct unit *punit)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_ferry_lost(ait, punit);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_turn_end(struct unit *punit)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_turn_end(ait, punit);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_move_or_attack(struct unit *punit, struct tile *ptile,
+                                     const PFPath &path, int step)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_move_or_attack(ait, punit, ptile, path, step);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_new_adv_task(struct unit *punit,
+                                   enum adv_unit_task task,
+                                   struct tile *ptile)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_new_adv_task(ait, punit, task, ptile);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_save(struct section_file *file,
+                           const struct unit *punit, const char *unitstr)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_save(ait, "tai", file, punit, unitstr);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_load(const struct section_file *file,
+                           struct unit *punit, const char *unitstr)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_load(ait, "tai", file, punit, unitstr);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_auto_settler_reset(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_auto_settler_reset(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_auto_settler_run(struct player *pplayer, struct unit *punit,
+                                  struct settlermap *state)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_auto_settler_run(ait, pplayer, punit, state);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_auto_settler_cont(struct player *pplayer,
+                                   struct unit *punit,
+                                   struct settlermap *state)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_auto_settler_cont(ait, pplayer, punit, state);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_switch_to_explore(struct unit *punit, struct tile *target,
+                                   enum override_bool *allow)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_switch_to_explore(ait, punit, target, allow);
+}
+
+/**
+   Hand the danger assessment over to the AI thread. The phase is marked
+   done only once the thread has reported back and the units have moved.
+ */
+static void twai_do_first_activities(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  if (tai_thread_running()) {
+    tai_first_activities(ait, pplayer);
+    return;
+  }
+
+  dai_do_first_activities(ait, pplayer);
+
+  pplayer->ai_phase_done = true;
+}
+
+/**
+   Mark turn done as we have already done everything before game was saved.
+ */
+static void twai_restart_phase(struct player *pplayer)
+{
+  pplayer->ai_phase_done = true;
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_diplomacy_actions(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_diplomacy_actions(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter. If the thread has
+   not reported back by the end of the phase, finish the first activities
+   with whatever it did send.
+ */
+static void twai_do_last_activities(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  tai_refresh(ait, pplayer);
+  tai_first_activities_finish(ait, pplayer);
+
+  dai_do_last_activities(ait, pplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_treaty_evaluate(struct player *pplayer,
+                                 struct player *aplayer,
+                                 struct Treaty *ptreaty)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_treaty_evaluate(ait, pplayer, aplayer, ptreaty);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_treaty_accepted(struct player *pplayer,
+                                 struct player *aplayer,
+                                 struct Treaty *ptreaty)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_treaty_accepted(ait, pplayer, aplayer, ptreaty);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_diplomacy_first_contact(struct player *pplayer,
+                                         struct player *aplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_diplomacy_first_contact(ait, pplayer, aplayer);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_incident(enum incident_type type,
+                          enum casus_belli_range scope,
+                          const struct action *paction,
+                          struct player *receiver, struct player *violator,
+                          struct player *victim)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_incident(ait, type, scope, paction, receiver, violator, victim);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_city_log(char *buffer, int buflength,
+                          const struct city *pcity)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_city_log(ait, buffer, buflength, pcity);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_unit_log(char *buffer, int buflength,
+                          const struct unit *punit)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_unit_log(ait, buffer, buflength, punit);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_consider_plr_dangerous(struct player *plr1,
+                                        struct player *plr2,
+                                        enum override_bool *result)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_consider_plr_dangerous(ait, plr1, plr2, result);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_consider_tile_dangerous(struct tile *ptile,
+                                         struct unit *punit,
+                                         enum override_bool *result)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_consider_tile_dangerous(ait, ptile, punit, result);
+}
+
+/**
+   Call default ai with threaded ai type as parameter.
+ */
+static void twai_consider_wonder_city(struct city *pcity, bool *result)
+{
+  struct ai_type *ait = tai_get_self();
+
+  dai_consider_wonder_city(ait, pcity, result);
+}
+
+/**
+   Send the whole world to the thread once the map is ready.
+ */
+static void twai_map_ready() { tai_world_sync(); }
+
+/**
+   Map is going away; so does the copy of the thread.
+ */
+static void twai_map_free() { tai_map_free(); }
+
+/**
+   Pass tile change to the thread.
+ */
+static void twai_tile_info(struct tile *ptile) { tai_tile_info(ptile); }
+
+/**
+   Pass new city to the thread.
+ */
+static void twai_city_created(struct city *pcity)
+{
+  tai_city_created(pcity);
+}
+
+/**
+   Pass city change to the thread.
+ */
+static void twai_city_info(struct city *pcity) { tai_city_changed(pcity); }
+
+/**
+   Pass city removal to the thread.
+ */
+static void twai_city_destroyed(struct city *pcity)
+{
+  tai_city_destroyed(pcity);
+}
+
+/**
+   Pass new unit to the thread.
+ */
+static void twai_unit_created(struct unit *punit)
+{
+  tai_unit_created(punit);
+}
+
+/**
+   Pass unit change to the thread.
+ */
+static void twai_unit_info(struct unit *punit) { tai_unit_changed(punit); }
+
+/**
+   Pass unit movement to the thread.
+ */
+static void twai_unit_move_seen(struct unit *punit)
+{
+  tai_unit_move_seen(punit);
+}
+
+/**
+   Pass unit removal to the thread.
+ */
+static void twai_unit_destroyed(struct unit *punit)
+{
+  tai_unit_destroyed(punit);
+}
+
+/**
+   Apply whatever the thread has sent meanwhile.
+ */
+static void twai_refresh(struct player *pplayer)
+{
+  struct ai_type *ait = tai_get_self();
+
+  tai_refresh(ait, pplayer);
+}
+
+/**
+   Setup player ai_funcs function pointers.
+ */
+bool fc_ai_threaded_setup(struct ai_type *ai)
+{
+  struct dai_private_data *pprivate;
+
+  tai_set_self(ai);
+
+  qstrncpy(ai->name, "threaded", sizeof(ai->name));
+
+  pprivate = new dai_private_data;
+  pprivate->contemplace_workers = true;
+  ai->pprivate = pprivate;
+
+  ai->funcs.module_close = twai_module_close;
+
+  // ai->funcs.map_alloc = nullptr;
+  ai->funcs.map_ready = twai_map_ready;
+  ai->funcs.map_free = twai_map_free;
+  // ai->funcs.game_start = nullptr;
+  // ai->funcs.game_free = nullptr;
+
+  ai->funcs.player_alloc = twai_player_alloc;
+  ai->funcs.player_free = twai_player_free;
+  // ai->funcs.player_save = nullptr;
+  // ai->funcs.player_load = nullptr;
+  ai->funcs.player_save_relations = twai_player_save_relations;
+  ai->funcs.player_load_relations = twai_player_load_relations;
+  ai->funcs.gained_control = twai_gained_control;
+  ai->funcs.lost_control = twai_lost_control;
+  ai->funcs.split_by_civil_war = twai_split_by_civil_war;
+  ai->funcs.created_by_civil_war = twai_created_by_civil_war;
+
+  ai->funcs.phase_begin = twai_data_phase_begin;
+  ai->funcs.phase_finished = twai_data_phase_finished;
+
+  ai->funcs.city_alloc = twai_city_alloc;
+  ai->funcs.city_free = twai_city_free;
+  ai->funcs.city_created = twai_city_created;
+  ai->funcs.city_destroyed = twai_city_destroyed;
+  /*
+    ai->funcs.city_got = nullptr;
+    ai->funcs.city_lost = nullptr;
+  */
+  ai->funcs.city_save = twai_city_save;
+  ai->funcs.city_load = twai_city_load;
+  ai->funcs.choose_building = twai_build_adv_override;
+  ai->funcs.build_adv_prepare = twai_wonder_city_distance;
+  ai->funcs.build_adv_init = twai_build_adv_init;
+  ai->funcs.build_adv_adjust_want = twai_build_adv_adjust;
+
+  ai->funcs.gov_value = twai_gov_value;
+
+  ai->funcs.units_ruleset_init = twai_units_ruleset_init;
+  ai->funcs.units_ruleset_close = twai_units_ruleset_close;
+
+  /* FIXME: We should allocate memory only for units owned by
+     default ai in unit_got. We track no data
+     about enemy units.
+     But advisors code still depends on some default ai data (role) to be
+     always allocated. */
+  /*
+    ai->funcs.unit_alloc = nullptr;
+    ai->funcs.unit_free = nullptr;
+    ai->funcs.unit_got = dai_unit_init;
+    ai->funcs.unit_lost = dai_unit_close;
+  */
+  ai->funcs.unit_created = twai_unit_created;
+  ai->funcs.unit_destroyed = twai_unit_destroyed;
+  ai->funcs.unit_alloc = twai_unit_init;
+  ai->funcs.unit_free = twai_unit_close;
+  ai->funcs.unit_got = twai_ferry_init_ferry;
+  ai->funcs.unit_lost = twai_ferry_lost;
+  ai->funcs.unit_transformed = twai_ferry_transformed;
+
+  ai->funcs.unit_turn_end = twai_unit_turn_end;
+  ai->funcs.unit_move = twai_unit_move_or_attack;
+  ai->funcs.unit_move_seen = twai_unit_move_seen;
+  ai->funcs.unit_task = twai_unit_new_adv_task;
+
+  ai->funcs.unit_save = twai_unit_save;
+  ai->funcs.unit_load = twai_unit_load;
+
+  ai->funcs.settler_reset = twai_auto_settler_reset;
+  ai->funcs.settler_run = twai_auto_settler_run;
+  ai->funcs.settler_cont = twai_auto_settler_cont;
+
+  ai->funcs.want_to_explore = twai_switch_to_explore;
+
+  ai->funcs.first_activities = twai_do_first_activities;
+  ai->funcs.restart_phase = twai_restart_phase;
+  ai->funcs.diplomacy_actions = twai_diplomacy_actions;
+  ai->funcs.last_activities = twai_do_last_activities;
+  ai->funcs.treaty_evaluate = twai_treaty_evaluate;
+  ai->funcs.treaty_accepted = twai_treaty_accepted;
+  ai->funcs.first_contact = twai_diplomacy_first_contact;
+  ai->funcs.incident = twai_incident;
+
+  ai->funcs.log_fragment_city = twai_city_log;
+  ai->funcs.log_fragment_unit = twai_unit_log;
+
+  ai->funcs.consider_plr_dangerous = twai_consider_plr_dangerous;
+  ai->funcs.consider_tile_dangerous = twai_consider_tile_dangerous;
+  ai->funcs.consider_wonder_city = twai_consider_wonder_city;
+
+  ai->funcs.refresh = twai_refresh;
+
+  ai->funcs.tile_info = twai_tile_info;
+  ai->funcs.city_info = twai_city_info;
+  ai->funcs.unit_info = twai_unit_info;
+
+  return true;
+}
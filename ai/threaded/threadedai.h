@@ -12,10 +12,6 @@
       \____/        ********************************************************/
 #pragma once
 
-struct city;
-struct tai_req;
+struct ai_type;
 
-void tai_city_worker_requests_create(struct ai_type *ait,
-                                     struct player *pplayer,
-                                     struct city *pcity);
-void tai_req_worker_task_rcv(struct tai_req *req);
+bool fc_ai_threaded_setup(struct ai_type *ai);
@@ -65,6 +65,18 @@
 #include "qtg_cxxside.h"
 
 extern void flush_dirty_overview();
+
+/**
+   Refreshes a city after the units in it or supported by it changed. The
+   city report only recomputes a row when asked to, and its unit columns
+   are not covered by city info packets.
+ */
+void refresh_city_units(struct city *pcity)
+{
+  refresh_city_dialog(pcity);
+  city_report_dialog_update_city(pcity);
+}
+
 /**
    Remove unit, client end version
  */
@@ -109,7 +121,7 @@ void client_remove_unit(struct unit *punit)
   if (nullptr != pcity) {
     if (can_player_see_units_in_city(client_player(), pcity)) {
       pcity->client.occupied = (0 < unit_list_size(pcity->tile->units));
-      refresh_city_dialog(pcity);
+      refresh_city_units(pcity);
     }
 
     log_debug("map city %s, %s, (%d %d)", city_name_get(pcity),
@@ -120,7 +132,7 @@ void client_remove_unit(struct unit *punit)
   if (!client_has_player() || unit_owner(&old_unit) == client_player()) {
     pcity = game_city_by_number(hc);
     if (nullptr != pcity) {
-      refresh_city_dialog(pcity);
+      refresh_city_units(pcity);
       log_debug("home city %s, %s, (%d %d)", city_name_get(pcity),
                 nation_rule_name(nation_of_city(pcity)),
                 TILE_XY(city_tile(pcity)));
@@ -24,6 +24,7 @@ typedef int cid;
 
 void client_remove_city(struct city *pcity);
 void client_remove_unit(struct unit *punit);
+void refresh_city_units(struct city *pcity);
 
 const char *get_embassy_status(const struct player *me,
                                const struct player *them);
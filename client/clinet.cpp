@@ -169,6 +169,8 @@ int connect_to_server(const QUrl &url, char *errbuf, int errbufsize)
 void make_connection(QTcpSocket *sock, const QString &username)
 {
   struct packet_server_join_req req;
+  QByteArray capability = our_capability;
+  QByteArray cache = ruleset_bundle_cache_capability();
 
   connection_common_init(&client.conn);
   client.conn.sock = sock;
@@ -187,7 +189,11 @@ void make_connection(QTcpSocket *sock, const QString &username)
   req.minor_version = MINOR_VERSION;
   req.patch_version = PATCH_VERSION;
   sz_strlcpy(req.version_label, VERSION_LABEL);
-  sz_strlcpy(req.capability, our_capability);
+  // Announce our cached rulesets, see handle_ruleset_bundle()
+  if (!cache.isEmpty()) {
+    capability += ' ' + cache;
+  }
+  sz_strlcpy(req.capability, capability.constData());
   sz_strlcpy(req.username, qUtf8Printable(username));
 
   send_packet_server_join_req(&client.conn, &req);
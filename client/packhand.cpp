@@ -14,7 +14,13 @@
 #include <fc_config.h>
 
 #include <QBitArray>
+#include <QByteArrayList>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QStandardPaths>
 #include <cstring>
 
 // utility
@@ -1709,7 +1715,7 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
 
       if ((hcity = game_city_by_number(punit->homecity))) {
         unit_list_remove(hcity->units_supported, punit);
-        refresh_city_dialog(hcity);
+        refresh_city_units(hcity);
       }
 
       punit->homecity = packet_unit->homecity;
@@ -1746,7 +1752,7 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
       repaint_unit = true;
       repaint_city = true;
       if (ccity != nullptr && (ccity->id != punit->homecity)) {
-        refresh_city_dialog(ccity);
+        refresh_city_units(ccity);
       }
       if (unit_is_in_focus(punit)) {
         // Update the orders menu -- the unit might have new abilities
@@ -1786,7 +1792,7 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
         if (ccity->id == punit->homecity) {
           repaint_city = true;
         } else {
-          refresh_city_dialog(ccity);
+          refresh_city_units(ccity);
         }
       }
 
@@ -1803,7 +1809,7 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
         if (ccity->id == punit->homecity) {
           repaint_city = true;
         } else {
-          refresh_city_dialog(ccity);
+          refresh_city_units(ccity);
         }
       }
     } /*** End of Change position. ***/
@@ -1812,12 +1818,12 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
       /* We repaint the city if the unit itself needs repainting or if
        * there is a special city-only redrawing to be done. */
       if ((pcity = game_city_by_number(punit->homecity))) {
-        refresh_city_dialog(pcity);
+        refresh_city_units(pcity);
       }
       if (repaint_unit && tile_city(unit_tile(punit))
           && tile_city(unit_tile(punit)) != pcity) {
         // Refresh the city we're occupying too.
-        refresh_city_dialog(tile_city(unit_tile(punit)));
+        refresh_city_units(tile_city(unit_tile(punit)));
       }
     }
 
@@ -1863,6 +1869,7 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
 
     if ((pcity = game_city_by_number(punit->homecity))) {
       unit_list_prepend(pcity->units_supported, punit);
+      refresh_city_units(pcity);
     }
 
     log_debug("New %s %s id %d (%d %d) hc %d %s",
@@ -1889,6 +1896,7 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
     if (pcity) {
       // The unit is in a city - obviously it's occupied.
       pcity->client.occupied = true;
+      refresh_city_units(pcity);
     }
 
     if (should_ask_server_for_actions(punit)) {
@@ -2897,6 +2905,9 @@ void handle_spaceship_info(const struct packet_spaceship_info *p)
   }
 }
 
+// Set while a tile snapshot is applied, to redraw the map only once.
+static bool tile_snapshot_applying = false;
+
 /**
    Packet tile_info handler.
  */
@@ -3129,7 +3140,7 @@ void handle_tile_info(const struct packet_tile_info *packet)
   }
 
   // refresh tiles
-  if (can_client_change_view()) {
+  if (can_client_change_view() && !tile_snapshot_applying) {
     // the tile itself (including the necessary parts of adjacent tiles)
     if (tile_changed || old_known != new_known) {
       refresh_tile_mapcanvas(ptile, true);
@@ -3149,6 +3160,131 @@ void handle_tile_info(const struct packet_tile_info *packet)
    * case of changes in worked tiles above. */
 }
 
+/**
+   Apply a complete tile snapshot: rebuild the tile info packets from the
+   columns and handle them as if they had been sent one by one.
+ */
+static void apply_tile_snapshot(const QByteArray &raw)
+{
+  QDataStream in(raw);
+  quint8 version;
+  quint32 count, next_string = 0;
+  QByteArray tiles, known, continent, owner, extras_owner, worked, terrain,
+      resource, extras, placing, place_turn, strings;
+  struct packet_tile_info info;
+  int index = -1;
+
+  in >> version >> count;
+  if (in.status() != QDataStream::Ok || version != TILE_SNAPSHOT_VERSION) {
+    qCritical("Invalid tile snapshot.");
+    return;
+  }
+  in >> tiles >> known >> continent >> owner >> extras_owner >> worked
+      >> terrain >> resource >> extras >> placing >> place_turn >> strings;
+  if (in.status() != QDataStream::Ok) {
+    qCritical("Truncated tile snapshot.");
+    return;
+  }
+
+  QDataStream tiles_in(tiles), known_in(known), continent_in(continent),
+      owner_in(owner), extras_owner_in(extras_owner), worked_in(worked),
+      terrain_in(terrain), resource_in(resource), extras_in(extras),
+      placing_in(placing), place_turn_in(place_turn), strings_in(strings);
+
+  if (!strings_in.atEnd()) {
+    strings_in >> next_string;
+  } else {
+    next_string = count;
+  }
+
+  tile_snapshot_applying = true;
+  for (quint32 i = 0; i < count; i++) {
+    quint32 gap;
+    quint8 u8;
+    qint8 s8;
+    quint16 u16;
+    qint16 s16;
+
+    tiles_in >> gap;
+    index += gap + 1;
+    info.tile = index;
+    known_in >> u8;
+    info.known = static_cast<enum known_type>(u8);
+    continent_in >> s16;
+    info.continent = s16;
+    owner_in >> u16;
+    info.owner = u16;
+    extras_owner_in >> u16;
+    info.extras_owner = u16;
+    worked_in >> u16;
+    info.worked = u16;
+    terrain_in >> u8;
+    info.terrain = u8;
+    resource_in >> u8;
+    info.resource = u8;
+    extras_in.readRawData(reinterpret_cast<char *>(info.extras.vec),
+                          sizeof(info.extras.vec));
+    placing_in >> s8;
+    info.placing = s8;
+    place_turn_in >> s16;
+    info.place_turn = s16;
+
+    info.label[0] = '\0';
+    info.spec_sprite[0] = '\0';
+    if (i == next_string) {
+      QByteArray label, spec_sprite;
+
+      strings_in >> label >> spec_sprite;
+      sz_strlcpy(info.label, label.constData());
+      sz_strlcpy(info.spec_sprite, spec_sprite.constData());
+      if (!strings_in.atEnd()) {
+        strings_in >> next_string;
+      }
+    }
+
+    if (tiles_in.status() != QDataStream::Ok
+        || extras_in.status() != QDataStream::Ok
+        || place_turn_in.status() != QDataStream::Ok) {
+      qCritical("Tile snapshot ends after %u of %u tiles.", i, count);
+      break;
+    }
+    handle_tile_info(&info);
+  }
+  tile_snapshot_applying = false;
+
+  if (can_client_change_view()) {
+    update_map_canvas_visible();
+  }
+}
+
+/**
+   Packet tile_snapshot handler. The chunks are collected until the whole
+   snapshot is there.
+ */
+void handle_tile_snapshot(const struct packet_tile_snapshot *packet)
+{
+  static QByteArray snapshot;
+
+  if (packet->offset == 0) {
+    snapshot.clear();
+    snapshot.reserve(packet->total_length);
+  }
+  if (packet->offset != snapshot.size()
+      || packet->offset + packet->chunk_length > packet->total_length) {
+    qCritical("Tile snapshot chunk at %d out of order.", packet->offset);
+    snapshot.clear();
+    return;
+  }
+
+  snapshot.append(reinterpret_cast<const char *>(packet->data),
+                  packet->chunk_length);
+  if (snapshot.size() == packet->total_length) {
+    apply_tile_snapshot(qUncompress(snapshot));
+    snapshot.clear();
+    snapshot.squeeze();
+  }
+}
+
 /**
    Received packet containing info about current scenario
  */
@@ -3300,11 +3436,195 @@ void handle_ruleset_description_part(
              game.control.desc_length + 1);
 }
 
+/**
+   Number of ruleset bundles kept in the disk cache.
+ */
+#define RULESET_BUNDLE_CACHE_SIZE 4
+
+/* The ruleset bundles of the disk cache, all announced on connecting.
+ * Maps their hash to their file. */
+static QHash<QByteArray, QString> cached_bundles;
+
+// Set while the packets of a ruleset bundle are being handled.
+static bool ruleset_bundle_injected = false;
+
+/**
+   Returns the directory of the ruleset bundle cache.
+ */
+static QString ruleset_bundle_cache_dir()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+         + QStringLiteral("/rulesets");
+}
+
+/**
+   Returns the hex SHA-1 hash identifying a ruleset bundle.
+ */
+static QByteArray ruleset_bundle_hash(const QByteArray &data)
+{
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+/**
+   Reads a cached ruleset bundle. Returns an empty array if it can't be
+   read or is corrupted.
+ */
+static QByteArray ruleset_bundle_cache_load(const QString &filename,
+                                            const QByteArray &hash)
+{
+  QFile file(filename);
+  QByteArray data;
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  data = file.readAll();
+  if (ruleset_bundle_hash(data) != hash) {
+    qDebug("Ignoring corrupted ruleset cache %s.",
+           qUtf8Printable(filename));
+    return QByteArray();
+  }
+  return data;
+}
+
+/**
+   Look up the ruleset bundles of the disk cache. Returns the capabilities
+   announcing them to the server, or an empty string if there are none.
+   Called when connecting.
+ */
+QByteArray ruleset_bundle_cache_capability()
+{
+  const auto files =
+      QDir(ruleset_bundle_cache_dir())
+          .entryInfoList({QStringLiteral("*.bundle")}, QDir::Files,
+                         QDir::Time);
+  QByteArrayList tokens;
+
+  cached_bundles.clear();
+  ruleset_bundle_injected = false;
+
+  for (const auto &info : files) {
+    QByteArray hash = info.completeBaseName().toLatin1();
+
+    if (ruleset_bundle_cache_load(info.filePath(), hash).isEmpty()) {
+      continue;
+    }
+
+    cached_bundles.insert(hash, info.filePath());
+    tokens.append(QByteArrayLiteral("ruleset-cache-") + hash);
+    if (cached_bundles.size() == RULESET_BUNDLE_CACHE_SIZE) {
+      break;
+    }
+  }
+
+  return tokens.join(' ');
+}
+
+/**
+   Store a ruleset bundle in the disk cache, dropping the oldest ones.
+ */
+static void ruleset_bundle_cache_save(const QByteArray &hash,
+                                      const QByteArray &data)
+{
+  QString dirname = ruleset_bundle_cache_dir();
+  QFile file(dirname + QStringLiteral("/%1.bundle")
+                           .arg(QString::fromLatin1(hash)));
+
+  QDir().mkpath(dirname);
+  if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+    qDebug("Could not cache the rulesets in %s: %s",
+           qUtf8Printable(file.fileName()),
+           qUtf8Printable(file.errorString()));
+    file.remove();
+    return;
+  }
+  file.close();
+
+  const auto files = QDir(dirname).entryInfoList(
+      {QStringLiteral("*.bundle")}, QDir::Files, QDir::Time);
+  for (int i = RULESET_BUNDLE_CACHE_SIZE; i < files.size(); i++) {
+    QFile::remove(files.at(i).filePath());
+  }
+}
+
+/**
+   Handle the packets of a ruleset bundle next, as if they had been sent
+   by the server. The bundle was recorded with empty delta caches, and the
+   server drops its own after sending it, so our caches are cleared here
+   and again in handle_rulesets_ready().
+ */
+static void ruleset_bundle_inject(const QByteArray &data)
+{
+  conn_clear_delta_cache(&client.conn, false);
+  inject_recorded_packets(&client.conn, data);
+  ruleset_bundle_injected = true;
+}
+
+/**
+   Packet ruleset_bundle handler. The chunks are collected until the whole
+   bundle is there; a chunk with cached set means that our cached bundle
+   can be used instead.
+ */
+void handle_ruleset_bundle(const struct packet_ruleset_bundle *packet)
+{
+  static QByteArray bundle;
+
+  if (packet->cached) {
+    QByteArray cached =
+        ruleset_bundle_cache_load(cached_bundles.value(packet->hash),
+                                  packet->hash);
+
+    if (cached.isEmpty()) {
+      qCritical("The server sent no rulesets but we don't have %s cached.",
+                packet->hash);
+      connection_close(&client.conn, _("ruleset cache mismatch"));
+      return;
+    }
+    ruleset_bundle_inject(cached);
+    return;
+  }
+
+  if (packet->offset == 0) {
+    bundle.clear();
+    bundle.reserve(packet->total_length);
+  }
+  if (packet->offset != bundle.size()
+      || packet->offset + packet->chunk_length > packet->total_length) {
+    qCritical("Ruleset bundle chunk at %d out of order.", packet->offset);
+    bundle.clear();
+    connection_close(&client.conn, _("corrupted rulesets"));
+    return;
+  }
+
+  bundle.append(reinterpret_cast<const char *>(packet->data),
+                packet->chunk_length);
+  if (bundle.size() == packet->total_length) {
+    if (ruleset_bundle_hash(bundle) != packet->hash) {
+      qCritical("Ruleset bundle %s is corrupted.", packet->hash);
+      bundle.clear();
+      connection_close(&client.conn, _("corrupted rulesets"));
+      return;
+    }
+    ruleset_bundle_cache_save(packet->hash, bundle);
+    ruleset_bundle_inject(bundle);
+    bundle.clear();
+    bundle.squeeze();
+  }
+}
+
 /**
    Received packet indicating that all rulesets have now been received.
  */
 void handle_rulesets_ready()
 {
+  if (ruleset_bundle_injected) {
+    // See ruleset_bundle_inject()
+    conn_clear_delta_cache(&client.conn, false);
+    ruleset_bundle_injected = false;
+  }
+
+  techs_precalc_closures();
+
   // Setup extra hiders caches
   extra_type_iterate(pextra)
   {
@@ -10,8 +10,13 @@
 **************************************************************************/
 #pragma once
 
+// Qt
+#include <QByteArray>
+
 void packhand_free();
 
+QByteArray ruleset_bundle_cache_capability();
+
 void notify_about_incoming_packet(struct connection *pc, int packet_type,
                                   int size);
 void notify_about_outgoing_packet(struct connection *pc, int packet_type,
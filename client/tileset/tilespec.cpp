@@ -18,11 +18,19 @@
  */
 
 #include <QApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QHash>
 #include <QImageReader>
 #include <QPixmap>
+#include <QSaveFile>
 #include <QSet>
+#include <QStandardPaths>
 #include <QString>
+#include <QThreadPool>
 #include <QVector>
 #include <cstdarg>
 #include <cstdlib> // exit
@@ -269,6 +277,8 @@ struct named_sprites {
 struct specfile {
   QPixmap *big_sprite;
   char *file_name;
+  QString gfx_file; // full path of the big sprite
+  QImage image;     // big sprite decoded by tileset_decode_big_sprites()
 };
 
 /*
@@ -1183,12 +1193,11 @@ static QPixmap *make_error_pixmap()
 }
 
 /**
-   Loads the given graphics file (found in the data path) into a newly
-   allocated sprite.
+   Finds the given graphics file in the data path, trying out all
+   supported file extensions. Returns an empty string if there is none.
  */
-static QPixmap *load_gfx_file(const char *gfx_filename)
+static QString find_gfx_file(const char *gfx_filename)
 {
-  // Try out all supported file extensions to find one that works.
   auto supported = QImageReader::supportedImageFormats();
 
   // Make sure we try png first (it's the most common and Qt always supports
@@ -1203,11 +1212,26 @@ static QPixmap *load_gfx_file(const char *gfx_filename)
     real_full_name =
         fileinfoname(get_data_dirs(), qUtf8Printable(full_name));
     if (!real_full_name.isEmpty()) {
-      log_debug("trying to load gfx file \"%s\".",
-                qUtf8Printable(real_full_name));
-      if (const auto s = load_gfxfile(qUtf8Printable(real_full_name)); s) {
-        return s;
-      }
+      return real_full_name;
+    }
+  }
+
+  return QString();
+}
+
+/**
+   Loads the given graphics file (found in the data path) into a newly
+   allocated sprite.
+ */
+static QPixmap *load_gfx_file(const char *gfx_filename)
+{
+  QString real_full_name = find_gfx_file(gfx_filename);
+
+  if (!real_full_name.isEmpty()) {
+    log_debug("trying to load gfx file \"%s\".",
+              qUtf8Printable(real_full_name));
+    if (const auto s = load_gfxfile(qUtf8Printable(real_full_name)); s) {
+      return s;
     }
   }
 
@@ -1215,6 +1239,129 @@ static QPixmap *load_gfx_file(const char *gfx_filename)
   return make_error_pixmap();
 }
 
+// Marks the files of the decoded sprite cache.
+#define GFX_CACHE_MAGIC 0x46434731 // "FCG1"
+
+/**
+   Reads an image from the decoded sprite cache. Returns a null image if
+   it isn't in the cache.
+ */
+static QImage gfx_cache_read(const QString &cache_name)
+{
+  QFile file(cache_name);
+  quint32 magic;
+  qint32 width, height;
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QImage();
+  }
+
+  QDataStream in(&file);
+  in >> magic >> width >> height;
+  if (in.status() != QDataStream::Ok || magic != GFX_CACHE_MAGIC
+      || width <= 0 || height <= 0) {
+    return QImage();
+  }
+
+  QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+  if (image.isNull()
+      || in.readRawData(reinterpret_cast<char *>(image.bits()),
+                        image.sizeInBytes())
+             != image.sizeInBytes()) {
+    return QImage();
+  }
+
+  return image;
+}
+
+/**
+   Writes an image to the decoded sprite cache. The image is stored in the
+   format QPixmap uses, so that it can be loaded without any conversion.
+ */
+static void gfx_cache_write(const QString &cache_name, const QImage &image)
+{
+  QSaveFile file(cache_name);
+
+  if (!file.open(QIODevice::WriteOnly)) {
+    return;
+  }
+
+  QDataStream out(&file);
+  out << quint32(GFX_CACHE_MAGIC) << qint32(image.width())
+      << qint32(image.height());
+  out.writeRawData(reinterpret_cast<const char *>(image.constBits()),
+                   image.sizeInBytes());
+  if (out.status() == QDataStream::Ok) {
+    file.commit();
+  }
+}
+
+/**
+   Decodes a graphics file. The decoded image is cached in cache_dir under
+   the hash of the file, so that later loads of the same file only need to
+   read it back. Can be called from any thread.
+ */
+static QImage decode_gfx_file(const QString &gfx_file,
+                              const QString &cache_dir)
+{
+  QFile file(gfx_file);
+  QByteArray data, hash;
+  QString cache_name;
+  QImage image;
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QImage();
+  }
+  data = file.readAll();
+
+  hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+  cache_name = QStringLiteral("%1/%2.img")
+                   .arg(cache_dir, QString::fromLatin1(hash.toHex()));
+  image = gfx_cache_read(cache_name);
+  if (!image.isNull()) {
+    return image;
+  }
+
+  image = QImage::fromData(data);
+  if (image.isNull()) {
+    return image;
+  }
+  image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+  gfx_cache_write(cache_name, image);
+
+  return image;
+}
+
+/**
+   Decodes the big sprites of all spec files on a thread pool. The images
+   are turned into pixmaps on demand by ensure_big_sprite(), which has to
+   happen in the GUI thread.
+ */
+static void tileset_decode_big_sprites(struct tileset *t)
+{
+  QString cache_dir =
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+      + QStringLiteral("/tilesets");
+  QElapsedTimer timer;
+  QThreadPool pool;
+
+  timer.start();
+  QDir().mkpath(cache_dir);
+
+  for (auto *sf : qAsConst(*t->specfiles)) {
+    if (sf->big_sprite == nullptr && !sf->gfx_file.isEmpty()) {
+      pool.start([sf, cache_dir]() {
+        sf->image = decode_gfx_file(sf->gfx_file, cache_dir);
+      });
+    }
+  }
+  pool.waitForDone();
+
+  log_time(QStringLiteral("Decoded the graphics of %1 in %2 milliseconds")
+               .arg(t->name)
+               .arg(timer.elapsed()));
+}
+
 /**
    Ensure that the big sprite of the given spec file is loaded.
  */
@@ -1228,6 +1375,13 @@ static void ensure_big_sprite(struct tileset *t, struct specfile *sf)
     return;
   }
 
+  if (!sf->image.isNull()) {
+    // Decoded in advance.
+    sf->big_sprite = new QPixmap(QPixmap::fromImage(std::move(sf->image)));
+    sf->image = QImage();
+    return;
+  }
+
   /* Otherwise load it.  The big sprite will sometimes be freed and will have
    * to be reloaded, but most of the time it's just loaded once, the small
    * sprites are extracted, and then it's freed. */
@@ -1279,8 +1433,9 @@ static void scan_specfile(struct tileset *t, struct specfile *sf,
   // Currently unused
   (void) secfile_entry_lookup(file, "info.artists");
 
-  // Not used here
-  (void) secfile_entry_lookup(file, "file.gfx");
+  // Looked up here so that the big sprite can be decoded in advance
+  sf->gfx_file =
+      find_gfx_file(secfile_lookup_str_default(file, "", "file.gfx"));
 
   if ((sections = secfile_sections_by_name_prefix(file, "grid_"))) {
     section_list_iterate(sections, psection)
@@ -2988,6 +3143,7 @@ void finish_loading_sprites(struct tileset *t)
       delete sf->big_sprite;
       sf->big_sprite = nullptr;
     }
+    sf->image = QImage();
   }
 }
 
@@ -2999,6 +3155,7 @@ void finish_loading_sprites(struct tileset *t)
  */
 void tileset_load_tiles(struct tileset *t)
 {
+  tileset_decode_big_sprites(t);
   tileset_lookup_sprite_tags(t);
   finish_loading_sprites(t);
 }
@@ -43,19 +43,9 @@
 bool city_sort_model::lessThan(const QModelIndex &left,
                                const QModelIndex &right) const
 {
-  QVariant qleft;
-  QVariant qright;
-  int i;
-  QByteArray l_bytes;
-  QByteArray r_bytes;
-
-  qleft = sourceModel()->data(left);
-  qright = sourceModel()->data(right);
-  l_bytes = qleft.toString().toLocal8Bit();
-  r_bytes = qright.toString().toLocal8Bit();
-  i = cityrepfield_compare(l_bytes.data(), r_bytes.data());
+  auto model = static_cast<const city_model *>(sourceModel());
 
-  return i >= 0;
+  return model->compare(left, right) > 0;
 }
 
 /**
@@ -121,7 +111,14 @@ QSize city_item_delegate::sizeHint(const QStyleOptionViewItem &option,
 /**
    Constructor for city item
  */
-city_item::city_item(city *pcity) : QObject() { i_city = pcity; }
+city_item::city_item(city *pcity) : QObject()
+{
+  i_city = pcity;
+  texts.resize(NUM_CREPORT_COLS);
+  text_valid.resize(NUM_CREPORT_COLS);
+  keys.resize(NUM_CREPORT_COLS);
+  key_valid.resize(NUM_CREPORT_COLS);
+}
 
 /**
    Returns used city pointer for city item creation
@@ -150,8 +147,42 @@ QVariant city_item::data(int column, int role) const
   if (role != Qt::DisplayRole) {
     return QVariant();
   }
-  const auto spec = city_report_specs[column];
-  return spec.func(i_city, spec.data).trimmed();
+  return text(column);
+}
+
+/**
+   Returns the text of the column, computing it if it isn't known yet
+ */
+const QString &city_item::text(int column) const
+{
+  if (!text_valid.testBit(column)) {
+    const auto &spec = city_report_specs[column];
+
+    texts[column] = spec.func(i_city, spec.data).trimmed();
+    text_valid.setBit(column);
+  }
+  return texts[column];
+}
+
+/**
+   Returns the text of the column parsed for sorting
+ */
+const cityrep_key &city_item::sort_key(int column) const
+{
+  if (!key_valid.testBit(column)) {
+    keys[column] = cityrepfield_key(qUtf8Printable(text(column)));
+    key_valid.setBit(column);
+  }
+  return keys[column];
+}
+
+/**
+   Forgets the cached cells after the city changed
+ */
+void city_item::invalidate()
+{
+  text_valid.fill(false);
+  key_valid.fill(false);
 }
 
 /**
@@ -194,6 +225,18 @@ QVariant city_model::data(const QModelIndex &index, int role) const
   return QVariant();
 }
 
+/**
+   Compares the cells at two indices of the same column for sorting
+ */
+int city_model::compare(const QModelIndex &left,
+                        const QModelIndex &right) const
+{
+  const auto &lkey = city_list[left.row()]->sort_key(left.column());
+  const auto &rkey = city_list[right.row()]->sort_key(right.column());
+
+  return cityrepfield_key_compare(lkey, rkey);
+}
+
 /**
    Sets data in model under index
  */
@@ -276,53 +319,79 @@ QVariant city_model::hide_data(int section) const
 }
 
 /**
-   Creates city model
+   Returns the cities shown in the model, in order
  */
-void city_model::populate()
+static QList<city *> city_model_cities()
 {
-  city_item *ci;
+  QList<city *> cities;
 
   if (client_has_player()) {
-    city_list_iterate(client_player()->cities, pcity)
-    {
-      ci = new city_item(pcity);
-      city_list << ci;
-    }
+    city_list_iterate(client_player()->cities, pcity) { cities << pcity; }
     city_list_iterate_end;
   } else {
-    cities_iterate(pcity)
-    {
-      ci = new city_item(pcity);
-      city_list << ci;
-    }
+    cities_iterate(pcity) { cities << pcity; }
     cities_iterate_end;
   }
+  return cities;
 }
 
 /**
-   Notifies about changed item
+   Creates city model
+ */
+void city_model::populate()
+{
+  for (auto *pcity : city_model_cities()) {
+    city_rows.insert(pcity->id, city_list.size());
+    city_list << new city_item(pcity);
+  }
+}
+
+/**
+   Notifies about changed item. Only its row is computed again.
  */
 void city_model::city_changed(struct city *pcity)
 {
-  city_item *item;
+  int row = city_rows.value(pcity->id, -1);
 
-  beginResetModel();
-  endResetModel();
-  for (int i = 0; i < city_list.count(); i++) {
-    item = city_list.at(i);
-    if (pcity == item->get_city()) {
-      notify_city_changed(i);
-    }
+  if (row < 0 || city_list.at(row)->get_city() != pcity) {
+    // A city we don't know yet
+    all_changed();
+    return;
   }
+
+  city_list.at(row)->invalidate();
+  notify_city_changed(row);
 }
 
 /**
-   Notifies about whole model changed
+   Notifies about whole model changed. The rows are kept when the cities
+   are the same, so the view only asks again for the cells it shows.
  */
 void city_model::all_changed()
 {
-  city_list.clear();
+  const auto cities = city_model_cities();
+  bool same = cities.size() == city_list.size();
+
+  for (int i = 0; same && i < cities.size(); i++) {
+    same = city_list.at(i)->get_city() == cities.at(i)
+           && city_rows.value(cities.at(i)->id, -1) == i;
+  }
+
+  if (same) {
+    for (auto *item : qAsConst(city_list)) {
+      item->invalidate();
+    }
+    if (!city_list.isEmpty()) {
+      emit dataChanged(index(0, 0),
+                       index(rowCount() - 1, columnCount() - 1));
+    }
+    return;
+  }
+
   beginResetModel();
+  qDeleteAll(city_list);
+  city_list.clear();
+  city_rows.clear();
   populate();
   endResetModel();
 }
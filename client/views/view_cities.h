@@ -11,6 +11,8 @@
 
 // Qt
 #include <QAbstractListModel>
+#include <QBitArray>
+#include <QHash>
 #include <QItemDelegate>
 #include <QMenu>
 #include <QSortFilterProxyModel>
@@ -63,7 +65,8 @@ class city_item_delegate : public QItemDelegate {
 };
 
 /***************************************************************************
-  Single item in model of city view table
+  Single item in model of city view table. Cells are computed when first
+  asked for and kept until the city changes.
 ***************************************************************************/
 class city_item : public QObject {
   Q_OBJECT
@@ -75,9 +78,17 @@ class city_item : public QObject {
   bool setData(int column, const QVariant &value,
                int role = Qt::DisplayRole);
   struct city *get_city();
+  const cityrep_key &sort_key(int column) const;
+  void invalidate();
 
 private:
+  const QString &text(int column) const;
+
   struct city *i_city;
+  mutable QVector<QString> texts;
+  mutable QBitArray text_valid;
+  mutable QVector<cityrep_key> keys;
+  mutable QBitArray key_valid;
 };
 
 /***************************************************************************
@@ -108,6 +119,7 @@ class city_model : public QAbstractListModel {
                       int role) const override;
   QVariant menu_data(int section) const;
   QVariant hide_data(int section) const;
+  int compare(const QModelIndex &left, const QModelIndex &right) const;
   void populate();
   void city_changed(struct city *pcity);
   void all_changed();
@@ -116,6 +128,7 @@ private slots:
 
 private:
   QList<city_item *> city_list;
+  QHash<int, int> city_rows; // city id -> row
 };
 
 /***************************************************************************
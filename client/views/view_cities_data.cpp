@@ -951,76 +951,29 @@ void init_city_report_game_data()
   note that numbers are before letters in the ASCII table).
  */
 
-/* A datum is one short string, or one number.
-   A datum_vector represents a long string of alternating strings and
-   numbers.
- */
-struct datum {
-  union {
-    float numeric_value;
-    char *string_value;
-  } val;
-  bool is_numeric;
-};
-#define SPECVEC_TAG datum
-#include "specvec.h"
-
-/**
-   Init a datum from a substring.
- */
-static void init_datum_string(struct datum *dat, const char *left,
-                              const char *right)
-{
-  int len = right - left;
-
-  dat->is_numeric = false;
-  dat->val.string_value = new char[len + 1];
-  memcpy(dat->val.string_value, left, len);
-  dat->val.string_value[len] = 0;
-}
-
-/**
-   Init a datum from a number (a float because we happen to use
-   strtof).
- */
-static void init_datum_number(struct datum *dat, float val)
-{
-  dat->is_numeric = true;
-  dat->val.numeric_value = val;
-}
-
-/**
-   Free the data associated with a datum -- that is, free the string if
-   it was allocated.
- */
-static void free_datum(struct datum *dat)
-{
-  if (!dat->is_numeric) {
-    delete[] dat->val.string_value;
-  }
-}
-
 /**
    Compare two data items as described above:
    - numbers in the obvious way
    - strings alphabetically
    - number < string for no good reason
  */
-static int datum_compare(const struct datum *a, const struct datum *b)
+static int datum_compare(const struct cityrep_datum *a,
+                         const struct cityrep_datum *b)
 {
   if (a->is_numeric == b->is_numeric) {
     if (a->is_numeric) {
-      if (a->val.numeric_value == b->val.numeric_value) {
+      if (a->numeric_value == b->numeric_value) {
         return 0;
-      } else if (a->val.numeric_value < b->val.numeric_value) {
+      } else if (a->numeric_value < b->numeric_value) {
         return -1;
-      } else if (a->val.numeric_value > b->val.numeric_value) {
+      } else if (a->numeric_value > b->numeric_value) {
         return +1;
       } else {
         return 0; // shrug
       }
     } else {
-      return strcmp(a->val.string_value, b->val.string_value);
+      return strcmp(a->string_value.constData(),
+                    b->string_value.constData());
     }
   } else {
     if (a->is_numeric) {
@@ -1034,15 +987,15 @@ static int datum_compare(const struct datum *a, const struct datum *b)
 /**
    Compare two strings of data lexicographically.
  */
-static int data_compare(const struct datum_vector *a,
-                        const struct datum_vector *b)
+int cityrepfield_key_compare(const cityrep_key &key1,
+                             const cityrep_key &key2)
 {
   int i, n;
 
-  n = MIN(a->size, b->size);
+  n = MIN(key1.size(), key2.size());
 
   for (i = 0; i < n; i++) {
-    int cmp = datum_compare(&a->p[i], &b->p[i]);
+    int cmp = datum_compare(&key1[i], &key2[i]);
 
     if (cmp != 0) {
       return cmp;
@@ -1051,17 +1004,18 @@ static int data_compare(const struct datum_vector *a,
 
   /* The first n fields match; whoever has more fields goes last.
      If they have equal numbers, the two really are equal. */
-  return a->size - b->size;
+  return key1.size() - key2.size();
 }
 
 /**
-   Split a string into a vector of datum.
+   Split a string into a vector of datum. The result can be kept and
+   compared with cityrepfield_key_compare() as often as needed.
  */
-static void split_string(struct datum_vector *data, const char *str)
+cityrep_key cityrepfield_key(const char *str)
 {
+  cityrep_key data;
   const char *string_start;
 
-  datum_vector_init(data);
   string_start = str;
   while (*str) {
     char *endptr;
@@ -1075,15 +1029,12 @@ static void split_string(struct datum_vector *data, const char *str)
     } else {
       /* that was a number, so stop the string we were parsing, add
          it (unless it's empty), then add the number we just parsed */
-      struct datum d;
-
       if (str != string_start) {
-        init_datum_string(&d, string_start, str);
-        datum_vector_append(data, d);
+        data.append({0.0f, QByteArray(string_start, str - string_start),
+                     false});
       }
 
-      init_datum_number(&d, value);
-      datum_vector_append(data, d);
+      data.append({value, QByteArray(), true});
 
       // finally, update the string position pointers
       string_start = str = endptr;
@@ -1092,24 +1043,11 @@ static void split_string(struct datum_vector *data, const char *str)
 
   // if we have anything leftover then it's a string
   if (str != string_start) {
-    struct datum d;
-
-    init_datum_string(&d, string_start, str);
-    datum_vector_append(data, d);
+    data.append(
+        {0.0f, QByteArray(string_start, str - string_start), false});
   }
-}
-
-/**
-   Free every datum in the vector.
- */
-static void free_data(struct datum_vector *data)
-{
-  int i;
 
-  for (i = 0; i < data->size; i++) {
-    free_datum(&data->p[i]);
-  }
-  datum_vector_free(data);
+  return data;
 }
 
 /**
@@ -1117,9 +1055,6 @@ static void free_data(struct datum_vector *data)
  */
 int cityrepfield_compare(const char *str1, const char *str2)
 {
-  struct datum_vector data1, data2;
-  int retval;
-
   if (str1 == str2) {
     return 0;
   } else if (nullptr == str1) {
@@ -1128,15 +1063,8 @@ int cityrepfield_compare(const char *str1, const char *str2)
     return -1;
   }
 
-  split_string(&data1, str1);
-  split_string(&data2, str2);
-
-  retval = data_compare(&data1, &data2);
-
-  free_data(&data1);
-  free_data(&data2);
-
-  return retval;
+  return cityrepfield_key_compare(cityrepfield_key(str1),
+                                  cityrepfield_key(str2));
 }
 
 /**
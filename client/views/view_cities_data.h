@@ -14,7 +14,9 @@
 
 #include "fc_types.h"
 
+#include <QByteArray>
 #include <QString>
+#include <QVector>
 
 // Number of city report columns: have to set this manually now...
 #define NUM_CREPORT_COLS (num_city_report_spec())
@@ -39,6 +41,18 @@ const char *city_report_spec_tagname(int i);
 
 void init_city_report_game_data();
 
+/* A city report field split into numbers and strings, so it can be
+ * sorted without being parsed again. */
+struct cityrep_datum {
+  float numeric_value;
+  QByteArray string_value;
+  bool is_numeric;
+};
+typedef QVector<cityrep_datum> cityrep_key;
+
+cityrep_key cityrepfield_key(const char *field);
+int cityrepfield_key_compare(const cityrep_key &key1,
+                             const cityrep_key &key2);
 int cityrepfield_compare(const char *field1, const char *field2);
 
 bool can_city_sell_universal(const struct city *pcity,
@@ -0,0 +1,19 @@
+# Find zstd. Defines Zstd::zstd if found.
+
+include(FindPackageHandleStandardArgs)
+
+find_path(ZSTD_INCLUDE_DIRS zstd.h)
+find_library(ZSTD_LIBRARIES NAMES zstd zstd_static)
+
+find_package_handle_standard_args(
+  Zstd DEFAULT_MSG ZSTD_LIBRARIES ZSTD_INCLUDE_DIRS)
+
+if(Zstd_FOUND AND NOT TARGET Zstd::zstd)
+  add_library(Zstd::zstd UNKNOWN IMPORTED)
+  set_target_properties(
+    Zstd::zstd
+    PROPERTIES
+    IMPORTED_LOCATION "${ZSTD_LIBRARIES}"
+    INTERFACE_INCLUDE_DIRECTORIES "${ZSTD_INCLUDE_DIRS}"
+  )
+endif()
@@ -24,6 +24,14 @@ cmake_dependent_option(
   FREECIV_ENABLE_RULEUP
   "Build the ruleset updater"
   ON FREECIV_ENABLE_TOOLS OFF)
+cmake_dependent_option(
+  FREECIV_ENABLE_MAPFRAMES
+  "Build the map image stream converter"
+  ON FREECIV_ENABLE_TOOLS OFF)
+cmake_dependent_option(
+  FREECIV_ENABLE_GENHASHBENCH
+  "Build the hash table benchmark (not installed)"
+  OFF FREECIV_ENABLE_TOOLS OFF)
 
 option(FREECIV_ENABLE_NLS "Enable internationalization" ON)
 
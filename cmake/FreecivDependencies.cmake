@@ -122,6 +122,17 @@ set(FREECIV_HAVE_BZ2 ${KArchive_HAVE_BZIP2})
 set(FREECIV_HAVE_LZMA ${KArchive_HAVE_LZMA})
 set(FREECIV_HAVE_ZSTD ${KArchive_HAVE_ZSTD})
 
+# Savegames are compressed with several threads when the libraries are
+# available directly. KArchive can read the result.
+if (FREECIV_HAVE_LZMA)
+  find_package(LibLZMA)
+  set(FREECIV_HAVE_LZMA_MT ${LIBLZMA_FOUND})
+endif()
+if (FREECIV_HAVE_ZSTD)
+  find_package(Zstd)
+  set(FREECIV_HAVE_ZSTD_MT ${Zstd_FOUND})
+endif()
+
 find_package(ZLIB REQUIRED) # Network protocol code
 
 # Some systems don't have a well-defined root user
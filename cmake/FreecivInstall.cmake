@@ -237,6 +237,7 @@ if(UNIX AND NOT APPLE)
         ${CMAKE_BINARY_DIR}/docs/man/freeciv21-game-manual.6
         ${CMAKE_BINARY_DIR}/docs/man/freeciv21-manual.6
         ${CMAKE_BINARY_DIR}/docs/man/freeciv21-ruleup.6
+        ${CMAKE_BINARY_DIR}/docs/man/freeciv21-mapframes.6
         DESTINATION ${CMAKE_INSTALL_DATAROOTDIR}/man/man6
         COMPONENT freeciv21
       )
@@ -314,12 +314,14 @@ struct ai_type {
     /* Called for every AI type when certain kind of city change has taken
      * place. Currently this gets called when:
      *  - city changes owner.
+     *  - city info is sent to the clients.
      */
     void (*city_info)(struct city *pcity);
 
     /* Called for every AI type when certain kind of unit change has taken
      * place. Currently this gets called when:
-     *  - unit updates & conversions
+     *  - unit info is sent to the clients, which includes conversions.
+     *  - unit has moved along with its transport.
      */
     void (*unit_info)(struct unit *punit);
 
@@ -145,6 +145,10 @@ void citizens_nation_set(struct city *pcity, const struct player_slot *pslot,
   fc_assert_ret(pcity != nullptr);
   fc_assert_ret(pcity->nationality != nullptr);
 
+  if (*(pcity->nationality + player_slot_index(pslot)) != count) {
+    // Effects may depend on the nationality of the citizens.
+    city_refresh_invalidate_all(pcity);
+  }
   *(pcity->nationality + player_slot_index(pslot)) = count;
 }
 
@@ -43,6 +43,9 @@
 
 #include "city.h"
 
+// The speculation installed by the current thread, if any.
+static thread_local const struct city_speculation *speculation = nullptr;
+
 // Define this to add in extra (very slow) assertions for the city code.
 #undef CITY_DEBUGGING
 
@@ -68,7 +71,13 @@ struct tile_cache {
   int output[O_LAST];
 };
 
+static struct city_refresh_stats refresh_stats;
+/* Bumped by city_refresh_invalidate_effects(). A city refreshed in an
+ * older generation redoes all stages. */
+static int refresh_generation = 0;
+
 static inline void city_tile_cache_update(struct city *pcity);
+static void city_refresh_citizens(struct city *pcity, bool *workers_map);
 static inline int city_tile_cache_get_output(const struct city *pcity,
                                              int city_tile_index,
                                              enum output_type_id o);
@@ -1126,6 +1135,10 @@ void city_size_set(struct city *pcity, citizens size)
   fc_assert_ret(pcity != nullptr);
 
   // Set city size.
+  if (pcity->size != size) {
+    // Effects may require a minimum size.
+    city_refresh_invalidate_all(pcity);
+  }
   pcity->size = size;
 }
 
@@ -1190,6 +1203,10 @@ bool city_has_building(const struct city *pcity,
   if (nullptr == pimprove) {
     return false;
   }
+  if (nullptr != speculation && pcity == speculation->pcity
+      && BV_ISSET(speculation->improvements, improvement_index(pimprove))) {
+    return true;
+  }
   return (pcity->built[improvement_index(pimprove)].turn > I_NEVER);
 }
 
@@ -3029,8 +3046,20 @@ void city_refresh_from_main_map(struct city *pcity, bool *workers_map)
     city_tile_cache_update(pcity);
     // manage settlers, and units
     city_support(pcity);
+
+    BV_CLR_ALL(pcity->refresh_dirty);
+    pcity->refresh_generation = refresh_generation;
   }
 
+  city_refresh_citizens(pcity, workers_map);
+}
+
+/**
+   Refreshes the values that depend on the placement of the workers. The
+   bonus[], tile_cache[] and the upkeep must be up to date already.
+ */
+static void city_refresh_citizens(struct city *pcity, bool *workers_map)
+{
   // Calculate output from citizens (uses city_tile_cache_get_output()).
   get_worked_tile_output(pcity, pcity->citizen_base, workers_map);
   add_specialist_output(pcity, pcity->citizen_base);
@@ -3062,6 +3091,182 @@ void city_refresh_from_main_map(struct city *pcity, bool *workers_map)
   set_surpluses(pcity);
 }
 
+/**
+   Marks a stage of the refresh to be redone by the next
+   city_refresh_dirty() of the city.
+ */
+void city_refresh_invalidate(struct city *pcity,
+                             enum city_refresh_stage stage)
+{
+  BV_SET(pcity->refresh_dirty, stage);
+}
+
+/**
+   Marks the whole refresh to be redone by the next city_refresh_dirty().
+ */
+void city_refresh_invalidate_all(struct city *pcity)
+{
+  BV_SET_ALL(pcity->refresh_dirty);
+}
+
+/**
+   Marks the tile output of all cities that may work ptile or one of its
+   neighbours to be redone. To be called when the terrain, the extras, the
+   resource or the owner of ptile change. Tile effects can have adjacent
+   requirements, hence the neighbours. The owner and the bases of a tile
+   also decide whether the units on it are aggressive, so the support of
+   their home cities is redone, too.
+ */
+void city_refresh_invalidate_tile(const struct tile *ptile)
+{
+  if (map_is_empty() || tile_virtual_check(ptile)) {
+    return;
+  }
+
+  square_iterate(&(wld.map), ptile, CITY_MAP_MAX_RADIUS + 1, ctile)
+  {
+    struct city *pcity = tile_city(ctile);
+
+    if (pcity != nullptr) {
+      BV_SET(pcity->refresh_dirty, CRS_TILES);
+    }
+  }
+  square_iterate_end;
+
+  unit_list_iterate(ptile->units, punit)
+  {
+    struct city *phome = game_city_by_number(punit->homecity);
+
+    if (phome != nullptr) {
+      BV_SET(phome->refresh_dirty, CRS_SUPPORT);
+    }
+  }
+  unit_list_iterate_end;
+}
+
+/**
+   Marks all stages of every city to be redone. To be called when effects
+   may have changed in a way that is not limited to known cities, e.g. when
+   a building is added or removed, a tech is learned or lost, a government
+   or diplomatic state changes, or a new turn starts.
+ */
+void city_refresh_invalidate_effects() { refresh_generation++; }
+
+/**
+   Returns whether the next city_refresh_dirty() of the city has to redo
+   the given stage.
+ */
+bool city_refresh_needed(struct city *pcity, enum city_refresh_stage stage)
+{
+  if (pcity->refresh_generation != refresh_generation) {
+    BV_SET_ALL(pcity->refresh_dirty);
+    pcity->refresh_generation = refresh_generation;
+  }
+
+  return BV_ISSET(pcity->refresh_dirty, stage);
+}
+
+#ifdef FREECIV_DEBUG
+/**
+   Compares the result of an incremental refresh against a full one. The
+   city is left with the result of the full refresh, so a missing
+   invalidation only shows up here. Run with --Fatal to stop at the first
+   one.
+ */
+static void city_refresh_check(struct city *pcity)
+{
+  int bonus[O_LAST], usage[O_LAST], prod[O_LAST], surplus[O_LAST];
+  citizens feel[CITIZEN_LAST][FEELING_LAST];
+  int ntiles = city_map_tiles_from_city(pcity);
+  std::vector<struct tile_cache> tiles(pcity->tile_cache,
+                                       pcity->tile_cache + ntiles);
+  bool same;
+
+  memcpy(bonus, pcity->bonus, sizeof(bonus));
+  memcpy(usage, pcity->usage, sizeof(usage));
+  memcpy(prod, pcity->prod, sizeof(prod));
+  memcpy(surplus, pcity->surplus, sizeof(surplus));
+  memcpy(feel, pcity->feel, sizeof(feel));
+
+  city_refresh_from_main_map(pcity, nullptr);
+
+  same = (0 == memcmp(bonus, pcity->bonus, sizeof(bonus))
+          && 0 == memcmp(usage, pcity->usage, sizeof(usage))
+          && 0 == memcmp(prod, pcity->prod, sizeof(prod))
+          && 0 == memcmp(surplus, pcity->surplus, sizeof(surplus))
+          && 0 == memcmp(feel, pcity->feel, sizeof(feel)));
+  for (size_t i = 0; same && i < tiles.size(); i++) {
+    same = (0
+            == memcmp(tiles[i].output, pcity->tile_cache[i].output,
+                      sizeof(tiles[i].output)));
+  }
+
+  if (!same) {
+    refresh_stats.mismatches++;
+  }
+  fc_assert_msg(same,
+                "%s: incremental city refresh differs from a full one.",
+                city_name_get(pcity));
+}
+#endif // FREECIV_DEBUG
+
+/**
+   Refreshes the city like city_refresh_from_main_map(), but reruns only
+   the stages that have been invalidated since the last refresh. The
+   values that depend on the placement of the workers are always redone.
+
+   Builds with FREECIV_DEBUG compare the result against a full refresh.
+ */
+void city_refresh_dirty(struct city *pcity)
+{
+  refresh_stats.refreshes++;
+
+  if (pcity->tile_cache_radius_sq != city_map_radius_sq_get(pcity)) {
+    BV_SET(pcity->refresh_dirty, CRS_TILES);
+  }
+
+  for (int stage = 0; stage < CRS_LAST; stage++) {
+    if (!city_refresh_needed(pcity,
+                             static_cast<enum city_refresh_stage>(stage))) {
+      refresh_stats.skipped[stage]++;
+      continue;
+    }
+
+    refresh_stats.run[stage]++;
+    switch (stage) {
+    case CRS_BONUSES:
+      set_city_bonuses(pcity);
+      break;
+    case CRS_TILES:
+      city_tile_cache_update(pcity);
+      break;
+    case CRS_SUPPORT:
+      city_support(pcity);
+      break;
+    }
+  }
+  BV_CLR_ALL(pcity->refresh_dirty);
+
+  city_refresh_citizens(pcity, nullptr);
+
+#ifdef FREECIV_DEBUG
+  city_refresh_check(pcity);
+#endif
+}
+
+/**
+   Returns the work done by city_refresh_dirty() so far.
+ */
+const struct city_refresh_stats *city_refresh_stats_get()
+{
+  return &refresh_stats;
+}
+
+/**
+   Clears the counters of city_refresh_dirty().
+ */
+void city_refresh_stats_reset() { refresh_stats = city_refresh_stats(); }
+
 /**
    Give corruption/waste generated by city.  otype gives the output type
    (O_SHIELD/O_TRADE).  'total' gives the total output of this type in the
@@ -3229,6 +3434,7 @@ void city_add_improvement(struct city *pcity,
 {
   pcity->built[improvement_index(pimprove)].turn =
       game.info.turn; /*I_ACTIVE*/
+  city_refresh_invalidate_effects();
 
   if (is_server() && is_wonder(pimprove)) {
     // Client just read the info from the packets.
@@ -3246,6 +3452,7 @@ void city_remove_improvement(struct city *pcity,
             improvement_rule_name(pimprove), pcity->name);
 
   pcity->built[improvement_index(pimprove)].turn = I_DESTROYED;
+  city_refresh_invalidate_effects();
 
   if (is_server() && is_wonder(pimprove)) {
     // Client just read the info from the packets.
@@ -3253,6 +3460,54 @@ void city_remove_improvement(struct city *pcity,
   }
 }
 
+/**
+  Starts speculating about improvements in 'pcity' in the current thread.
+  Add them with city_speculation_add_improvement(). 'pspec' must stay
+  alive until city_speculation_end() is called. Speculations don't nest.
+ */
+void city_speculation_begin(struct city_speculation *pspec,
+                            const struct city *pcity)
+{
+  fc_assert_ret(nullptr == speculation);
+
+  pspec->pcity = pcity;
+  BV_CLR_ALL(pspec->improvements);
+  speculation = pspec;
+}
+
+/**
+  Pretends that the city of the speculation has the improvement. As with
+  city_add_improvement(), the caller should check that it can be built.
+ */
+void city_speculation_add_improvement(struct city_speculation *pspec,
+                                      const struct impr_type *pimprove)
+{
+  BV_SET(pspec->improvements, improvement_index(pimprove));
+}
+
+/**
+  Stops speculating; the city is seen as it is again.
+ */
+void city_speculation_end(struct city_speculation *pspec)
+{
+  fc_assert_ret(speculation == pspec);
+
+  speculation = nullptr;
+}
+
+/**
+  Returns the city in which the current thread speculates the wonder to be
+  built, or nullptr if it doesn't.
+ */
+const struct city *city_speculation_wonder(const struct impr_type *pimprove)
+{
+  if (nullptr != speculation
+      && BV_ISSET(speculation->improvements, improvement_index(pimprove))) {
+    return speculation->pcity;
+  }
+  return nullptr;
+}
+
 /**
   Returns TRUE iff the city has set the given option.
  */
@@ -3335,6 +3590,8 @@ struct city *create_city_virtual(struct player *pplayer, struct tile *ptile,
   pcity->turn_last_built = game.info.turn;
 
   pcity->tile_cache_radius_sq = -1; // -1 = tile_cache must be initialised
+  BV_SET_ALL(pcity->refresh_dirty);
+  pcity->refresh_generation = refresh_generation;
 
   // pcity->ai.act_cache: worker activities on the city map
 
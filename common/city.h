@@ -274,6 +274,31 @@ enum city_updates {
   CU_POPUP_DIALOG = 1 << 2
 };
 
+/* Stages of city_refresh_from_main_map() that only need to run again
+ * when something they depend on has changed. Not part of network
+ * protocol. */
+#define SPECENUM_NAME city_refresh_stage
+// Effect bonuses to the city outputs, pcity->bonus[].
+#define SPECENUM_VALUE0 CRS_BONUSES
+#define SPECENUM_VALUE0NAME "Bonuses"
+// Output of the tiles of the city map, pcity->tile_cache[].
+#define SPECENUM_VALUE1 CRS_TILES
+#define SPECENUM_VALUE1NAME "Tiles"
+// Upkeep and the unhappiness caused by units, see city_support().
+#define SPECENUM_VALUE2 CRS_SUPPORT
+#define SPECENUM_VALUE2NAME "Support"
+#define SPECENUM_COUNT CRS_LAST
+#define SPECENUM_BITVECTOR bv_city_refresh
+#include "specenum_gen.h"
+
+// Work done by city_refresh_dirty() since city_refresh_stats_reset().
+struct city_refresh_stats {
+  int refreshes;
+  int run[CRS_LAST];
+  int skipped[CRS_LAST];
+  int mismatches; // Only counted with FREECIV_DEBUG.
+};
+
 struct tile_cache; // defined and only used within city.c
 
 struct adv_city; /* defined in ./server/advisors/infracache.h */
@@ -325,6 +350,10 @@ struct city {
 
   // Cached values for CPU savings.
   int bonus[O_LAST];
+  // Stages of the refresh that the cached values above need.
+  bv_city_refresh refresh_dirty;
+  // See city_refresh_invalidate_effects().
+  int refresh_generation;
 
   // the physics
   int food_stock;
@@ -692,8 +721,34 @@ void city_add_improvement(struct city *pcity,
 void city_remove_improvement(struct city *pcity,
                              const struct impr_type *pimprove);
 
+/* Hypothetical improvements in a city. While a speculation is installed
+ * with city_speculation_begin(), city_has_building() and the wonder
+ * accessors answer as if the improvements had been built, but nothing in
+ * the game state changes. The speculation only applies to the thread that
+ * installed it. */
+struct city_speculation {
+  const struct city *pcity;
+  bv_imprs improvements;
+};
+
+void city_speculation_begin(struct city_speculation *pspec,
+                            const struct city *pcity);
+void city_speculation_add_improvement(struct city_speculation *pspec,
+                                      const struct impr_type *pimprove);
+void city_speculation_end(struct city_speculation *pspec);
+const struct city *city_speculation_wonder(const struct impr_type *pimprove);
+
 // city update functions
 void city_refresh_from_main_map(struct city *pcity, bool *workers_map);
+void city_refresh_invalidate(struct city *pcity,
+                             enum city_refresh_stage stage);
+void city_refresh_invalidate_all(struct city *pcity);
+void city_refresh_invalidate_tile(const struct tile *ptile);
+void city_refresh_invalidate_effects();
+bool city_refresh_needed(struct city *pcity, enum city_refresh_stage stage);
+void city_refresh_dirty(struct city *pcity);
+const struct city_refresh_stats *city_refresh_stats_get();
+void city_refresh_stats_reset();
 
 int city_waste(const struct city *pcity, Output_type_id otype, int total,
                int *breakdown);
@@ -734,7 +789,7 @@ bool city_exist(int id);
 #define city_built_iterate(_pcity, _p)                                      \
   improvement_iterate(_p)                                                   \
   {                                                                         \
-    if ((_pcity)->built[improvement_index(_p)].turn <= I_NEVER) {           \
+    if (!city_has_building((_pcity), _p)) {                                 \
       continue;                                                             \
     }
 
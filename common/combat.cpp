@@ -13,6 +13,10 @@
 
 #include <cmath>
 
+// Qt
+#include <QHash>
+#include <QVarLengthArray>
+
 // utility
 #include "bitvector.h"
 #include "log.h"
@@ -255,6 +259,143 @@ bool can_unit_attack_tile(const struct unit *punit,
           && unit_attack_units_at_tile_result(punit, dest_tile) == ATT_OK);
 }
 
+// Number of fights computed side by side by win_chances().
+#define COMBAT_LANES 4
+
+/* One fight of win_chances(): attack and defense strength, hit points and
+ * firepower of both units. */
+struct combat_fight {
+  int as, ahp, afp;
+  int ds, dhp, dfp;
+};
+
+/**
+ Computes the chances of the attacker winning for count fights, see
+ win_chance(). The fights are computed COMBAT_LANES at a time with the
+ rounds of all lanes in lockstep, so that the compiler can vectorize the
+ loop. Every lane does the same operations in the same order whatever its
+ neighbours are, so the result of a fight does not depend on the batch.
+ */
+static void win_chances(const struct combat_fight *fights, int count,
+                        double *chances)
+{
+  int first;
+
+  for (first = 0; first < count; first += COMBAT_LANES) {
+    int att_N_lose[COMBAT_LANES], def_N_lose[COMBAT_LANES];
+    double att_P_lose1[COMBAT_LANES], def_P_lose1[COMBAT_LANES];
+    double binom_save[COMBAT_LANES], accum_prob[COMBAT_LANES];
+    int lane, lr, max_rounds = 0;
+
+    for (lane = 0; lane < COMBAT_LANES; lane++) {
+      const struct combat_fight *f = &fights[MIN(first + lane, count - 1)];
+
+      if (first + lane >= count || f->afp == 0 || f->dfp == 0) {
+        // Fixed below, just keep the lane busy with harmless numbers.
+        att_N_lose[lane] = 0;
+        def_N_lose[lane] = 1;
+        att_P_lose1[lane] = 0.5;
+        def_P_lose1[lane] = 0.5;
+      } else {
+        // number of rounds a unit can fight without dying
+        att_N_lose[lane] = (f->ahp + f->dfp - 1) / f->dfp;
+        def_N_lose[lane] = (f->dhp + f->afp - 1) / f->afp;
+        // Probability of losing one round
+        att_P_lose1[lane] =
+            (f->as + f->ds == 0)
+                ? 0.5
+                : static_cast<double>(f->ds) / (f->as + f->ds);
+        def_P_lose1[lane] = 1 - att_P_lose1[lane];
+      }
+      max_rounds = MAX(max_rounds, att_N_lose[lane]);
+    }
+
+    /*
+      This calculates
+
+      binomial_coeff(def_N_lose-1 + lr, lr)
+        * def_P_lose1^(def_N_lose-1)
+        * att_P_lose1^(lr)
+        * def_P_lose1
+
+      for each possible number of rounds lost (rl) by the winning unit.
+      rl is of course less than the number of rounds the winning unit
+      should lose to lose all it's hit points.
+      The probabilities are then summed.
+
+      To see this is correct consider the set of series for all valid fights.
+      These series are the type (win, lose, lose...). The possible lenghts
+      are def_N_lose to def_N_lose+att_N_lose-1. A series is not valid
+      unless it contains def_N_lose wins, and one of the wins must be the
+      last one, or the series would be equivalent the a shorter series (the
+      attacker would have won one or more fights previously).
+      So since the last fight is a win we disregard it while calculating. Now
+      a series contains def_N_lose-1 wins. So for each possible lenght of a
+      series we find the probability of every valid series and then sum.
+      For a specific lenght (a "lr") every series have the probability
+        def_P_lose1^(def_N_lose-1) * att_P_lose1^(lr)
+      and then getting from that to the real series requires a win, ie factor
+      def_N_lose. The number of series with lenght (def_N_lose-1 + lr) and
+      "lr" lost fights is
+        binomial_coeff(def_N_lose-1 + lr, lr)
+      And by multiplying we get the formula on the top of this code block.
+      Adding the cumulative probability for each valid lenght then gives the
+      total probability.
+
+      We clearly have all valid series this way. To see that we have counted
+      none twice note that would require a series with a smaller series
+      inbedded. But since the smaller series already included def_N_lose
+      wins, and the larger series ends with a win, it would have too many
+      wins and therefore cannot exist.
+
+      In practice each binomial coefficient for a series lenght can be
+      calculated from the previous. In the coefficient (n, k) n is increased
+      and k is unchanged. The "* def_P_lose1" is multiplied on the sum
+      afterwards.
+
+      (lots of talk for so little code)
+    */
+
+    for (lane = 0; lane < COMBAT_LANES; lane++) {
+      binom_save[lane] = pow(def_P_lose1[lane],
+                             static_cast<double>(def_N_lose[lane] - 1));
+      accum_prob[lane] = binom_save[lane]; // lr = 0
+    }
+
+    // lr is the number of Lost Rounds by the attacker
+    for (lr = 1; lr < max_rounds; lr++) {
+      for (lane = 0; lane < COMBAT_LANES; lane++) {
+        // update the coefficient
+        int n = lr + def_N_lose[lane] - 1;
+        double next = binom_save[lane];
+
+        next *= n;
+        next /= lr;
+        next *= att_P_lose1[lane];
+        // use it for this lr
+        if (lr < att_N_lose[lane]) {
+          binom_save[lane] = next;
+          accum_prob[lane] += next;
+        }
+      }
+    }
+
+    for (lane = 0; lane < COMBAT_LANES && first + lane < count; lane++) {
+      const struct combat_fight *f = &fights[first + lane];
+
+      if (f->afp == 0) {
+        chances[first + lane] = 0.0;
+      } else if (f->dfp == 0) {
+        chances[first + lane] = 1.0;
+      } else {
+        /* Every element of the sum needs a factor for the very last fight
+         * round */
+        chances[first + lane] = accum_prob[lane] * def_P_lose1[lane];
+      }
+    }
+  }
+}
+
 /**
  Returns the chance of the attacker winning, a number between 0 and 1.
  If you want the chance that the defender wins just use 1-chance(...)
@@ -269,89 +410,75 @@ bool can_unit_attack_tile(const struct unit *punit,
  */
 double win_chance(int as, int ahp, int afp, int ds, int dhp, int dfp)
 {
-  if (afp == 0)
-    return 0.0;
-  if (dfp == 0)
-    return 1.0;
-  // number of rounds a unit can fight without dying
-  int att_N_lose = (ahp + dfp - 1) / dfp;
-  int def_N_lose = (dhp + afp - 1) / afp;
-  // Probability of losing one round
-  double att_P_lose1 =
-      (as + ds == 0) ? 0.5 : static_cast<double>(ds) / (as + ds);
-  double def_P_lose1 = 1 - att_P_lose1;
+  struct combat_fight fight = {as, ahp, afp, ds, dhp, dfp};
+  double chance;
 
-  /*
-    This calculates
-
-    binomial_coeff(def_N_lose-1 + lr, lr)
-      * def_P_lose1^(def_N_lose-1)
-      * att_P_lose1^(lr)
-      * def_P_lose1
-
-    for each possible number of rounds lost (rl) by the winning unit.
-    rl is of course less than the number of rounds the winning unit
-    should lose to lose all it's hit points.
-    The probabilities are then summed.
-
-    To see this is correct consider the set of series for all valid fights.
-    These series are the type (win, lose, lose...). The possible lenghts are
-    def_N_lose to def_N_lose+att_N_lose-1. A series is not valid unless it
-    contains def_N_lose wins, and one of the wins must be the last one, or
-    the series would be equivalent the a shorter series (the attacker would
-    have won one or more fights previously).
-    So since the last fight is a win we disregard it while calculating. Now
-    a series contains def_N_lose-1 wins. So for each possible lenght of a
-    series we find the probability of every valid series and then sum.
-    For a specific lenght (a "lr") every series have the probability
-      def_P_lose1^(def_N_lose-1) * att_P_lose1^(lr)
-    and then getting from that to the real series requires a win, ie factor
-    def_N_lose. The number of series with lenght (def_N_lose-1 + lr) and
-    "lr" lost fights is
-      binomial_coeff(def_N_lose-1 + lr, lr)
-    And by multiplying we get the formula on the top of this code block.
-    Adding the cumulative probability for each valid lenght then gives the
-    total probability.
+  win_chances(&fight, 1, &chance);
+
+  return chance;
+}
 
-    We clearly have all valid series this way. To see that we have counted
-    none twice note that would require a series with a smaller series
-    inbedded. But since the smaller series already included def_N_lose wins,
-    and the larger series ends with a win, it would have too many wins and
-    therefore cannot exist.
+/* Key of the effect values cached while evaluating many fights, see
+ * combat_unittype_bonus(). */
+struct combat_bonus_key {
+  const struct player *owner;
+  const struct tile *ptile;
+  const struct unit_type *utype;
+  enum effect_type effect;
+
+  bool operator==(const combat_bonus_key &other) const
+  {
+    return owner == other.owner && ptile == other.ptile
+           && utype == other.utype && effect == other.effect;
+  }
+};
 
-    In practice each binomial coefficient for a series lenght can be
-    calculated from the previous. In the coefficient (n, k) n is increased
-    and k is unchanged. The "* def_P_lose1" is multiplied on the sum
-    afterwards.
+/**
+   Hash function for combat_bonus_key.
+ */
+static inline uint qHash(const combat_bonus_key &key, uint seed = 0)
+{
+  return ::qHash(key.owner, seed) ^ ::qHash(key.ptile, seed)
+         ^ ::qHash(key.utype, seed) ^ ::qHash(int(key.effect), seed);
+}
 
-    (lots of talk for so little code)
-  */
+typedef QHash<combat_bonus_key, int> combat_bonus_cache;
 
-  double binom_save = pow(def_P_lose1, static_cast<double>(def_N_lose - 1));
-  double accum_prob = binom_save; // lr = 0
+/**
+   get_unittype_bonus(), remembered in cache if it is not nullptr. The
+   cache only lives as long as one unit_win_chances() call, during which
+   the game doesn't change.
+ */
+static int combat_unittype_bonus(combat_bonus_cache *cache,
+                                 const struct player *owner,
+                                 const struct tile *ptile,
+                                 const struct unit_type *utype,
+                                 enum effect_type effect)
+{
+  combat_bonus_key key = {owner, ptile, utype, effect};
+  combat_bonus_cache::const_iterator it;
+  int value;
 
-  int lr; // the number of Lost Rounds by the attacker
-  for (lr = 1; lr < att_N_lose; lr++) {
-    // update the coefficient
-    int n = lr + def_N_lose - 1;
-    binom_save *= n;
-    binom_save /= lr;
-    binom_save *= att_P_lose1;
-    // use it for this lr
-    accum_prob += binom_save;
+  if (nullptr == cache) {
+    return get_unittype_bonus(owner, ptile, utype, effect);
   }
-  // Every element of the sum needs a factor for the very last fight round
-  accum_prob *= def_P_lose1;
 
-  return accum_prob;
+  it = cache->constFind(key);
+  if (it != cache->constEnd()) {
+    return it.value();
+  }
+  value = get_unittype_bonus(owner, ptile, utype, effect);
+  cache->insert(key, value);
+  return value;
 }
 
 /**
  A unit's effective firepower depend on the situation.
  */
-void get_modified_firepower(const struct unit *attacker,
-                            const struct unit *defender, int *att_fp,
-                            int *def_fp)
+static void modified_firepower(combat_bonus_cache *cache,
+                               const struct unit *attacker,
+                               const struct unit *defender, int *att_fp,
+                               int *def_fp)
 {
   struct city *pcity = tile_city(unit_tile(defender));
 
@@ -369,8 +496,9 @@ void get_modified_firepower(const struct unit *attacker,
    * city walls).
    */
   if (unit_has_type_flag(attacker, UTYF_BADWALLATTACKER)
-      && get_unittype_bonus(unit_owner(defender), unit_tile(defender),
-                            unit_type_get(attacker), EFT_DEFEND_BONUS)
+      && combat_unittype_bonus(cache, unit_owner(defender),
+                               unit_tile(defender), unit_type_get(attacker),
+                               EFT_DEFEND_BONUS)
              > 0) {
     *att_fp = 1;
   }
@@ -401,6 +529,16 @@ void get_modified_firepower(const struct unit *attacker,
   }
 }
 
+/**
+ A unit's effective firepower depend on the situation.
+ */
+void get_modified_firepower(const struct unit *attacker,
+                            const struct unit *defender, int *att_fp,
+                            int *def_fp)
+{
+  modified_firepower(nullptr, attacker, defender, att_fp, def_fp);
+}
+
 /**
  Returns a double in the range [0;1] indicating the attackers chance of
  winning. The calculation takes all factors into account.
@@ -408,18 +546,13 @@ void get_modified_firepower(const struct unit *attacker,
 double unit_win_chance(const struct unit *attacker,
                        const struct unit *defender)
 {
-  int def_power = get_total_defense_power(attacker, defender);
-  int att_power = get_total_attack_power(attacker, defender);
-
-  double chance;
-
-  int def_fp, att_fp;
-  get_modified_firepower(attacker, defender, &att_fp, &def_fp);
+  struct combat_pairing pairing;
 
-  chance = win_chance(att_power, attacker->hp, att_fp, def_power,
-                      defender->hp, def_fp);
+  pairing.attacker = attacker;
+  pairing.defender = defender;
+  unit_win_chances(&pairing, 1);
 
-  return chance;
+  return pairing.win_chance;
 }
 
 /**
@@ -523,19 +656,30 @@ static int get_defense_power(const struct unit *punit)
 /**
    Return the modified attack power of a unit.
  */
-int get_total_attack_power(const struct unit *attacker,
-                           const struct unit *defender)
+static int total_attack_power(combat_bonus_cache *cache,
+                              const struct unit *attacker,
+                              const struct unit *defender)
 {
   int mod;
   int attackpower = get_attack_power(attacker);
 
   mod = 100
-        + get_unittype_bonus(unit_owner(attacker), unit_tile(defender),
-                             unit_type_get(attacker), EFT_ATTACK_BONUS);
+        + combat_unittype_bonus(cache, unit_owner(attacker),
+                                unit_tile(defender),
+                                unit_type_get(attacker), EFT_ATTACK_BONUS);
 
   return attackpower * mod / 100;
 }
 
+/**
+   Return the modified attack power of a unit.
+ */
+int get_total_attack_power(const struct unit *attacker,
+                           const struct unit *defender)
+{
+  return total_attack_power(nullptr, attacker, defender);
+}
+
 /**
   Return an increased defensepower. Effects which increase the
   defensepower are:
@@ -546,7 +690,8 @@ int get_total_attack_power(const struct unit *attacker,
  May be called with a non-existing att_type to avoid any unit type
  effects.
  */
-static int defense_multiplication(const struct unit_type *att_type,
+static int defense_multiplication(combat_bonus_cache *cache,
+                                  const struct unit_type *att_type,
                                   const struct unit *def,
                                   const struct player *def_player,
                                   const struct tile *ptile, int defensepower)
@@ -564,9 +709,9 @@ static int defense_multiplication(const struct unit_type *att_type,
     defensepower = defensepower * defense_multiplier_pct / 100;
 
     // This applies even if pcity is nullptr.
-    mod =
-        100
-        + get_unittype_bonus(def_player, ptile, att_type, EFT_DEFEND_BONUS);
+    mod = 100
+          + combat_unittype_bonus(cache, def_player, ptile, att_type,
+                                  EFT_DEFEND_BONUS);
     defensepower = MAX(0, defensepower * mod / 100);
 
     defense_divider_pct =
@@ -638,7 +783,7 @@ int get_virtual_defense_power(const struct unit_type *att_type,
     defensepower = defensepower * defclass->non_native_def_pct / 100;
   }
 
-  def = defense_multiplication(att_type, vdef, def_player, ptile,
+  def = defense_multiplication(nullptr, att_type, vdef, def_player, ptile,
                                defensepower);
 
   unit_virtual_destroy(vdef);
@@ -654,11 +799,46 @@ int get_virtual_defense_power(const struct unit_type *att_type,
 int get_total_defense_power(const struct unit *attacker,
                             const struct unit *defender)
 {
-  return defense_multiplication(unit_type_get(attacker), defender,
+  return defense_multiplication(nullptr, unit_type_get(attacker), defender,
                                 unit_owner(defender), unit_tile(defender),
                                 get_defense_power(defender));
 }
 
+/**
+   Fill the powers, firepowers and chance of the attacker winning of count
+   pairings. The results are the same as get_total_attack_power(),
+   get_total_defense_power(), get_modified_firepower() and
+   unit_win_chance(), but the effect values shared by the pairings are
+   only computed once and the win chances are computed side by side.
+ */
+void unit_win_chances(struct combat_pairing *pairings, int count)
+{
+  combat_bonus_cache cache;
+  combat_bonus_cache *pcache = (count > 1 ? &cache : nullptr);
+  QVarLengthArray<struct combat_fight, COMBAT_LANES> fights(count);
+  QVarLengthArray<double, COMBAT_LANES> chances(count);
+  int i;
+
+  for (i = 0; i < count; i++) {
+    struct combat_pairing *p = &pairings[i];
+
+    p->att_power = total_attack_power(pcache, p->attacker, p->defender);
+    p->def_power = defense_multiplication(
+        pcache, unit_type_get(p->attacker), p->defender,
+        unit_owner(p->defender), unit_tile(p->defender),
+        get_defense_power(p->defender));
+    modified_firepower(pcache, p->attacker, p->defender, &p->att_fp,
+                       &p->def_fp);
+    fights[i] = {p->att_power, p->attacker->hp, p->att_fp,
+                 p->def_power, p->defender->hp, p->def_fp};
+  }
+
+  win_chances(fights.constData(), count, chances.data());
+  for (i = 0; i < count; i++) {
+    pairings[i].win_chance = chances[i];
+  }
+}
+
 /**
    Return total defense power of the unit if it fortifies, if possible,
    where it is. attacker might be nullptr to skip calculating attacker
@@ -683,8 +863,8 @@ int get_fortified_defense_power(const struct unit *attacker,
     defender->activity = ACTIVITY_FORTIFIED;
   }
 
-  def = defense_multiplication(att_type, defender, unit_owner(defender),
-                               unit_tile(defender),
+  def = defense_multiplication(nullptr, att_type, defender,
+                               unit_owner(defender), unit_tile(defender),
                                get_defense_power(defender));
 
   defender->activity = real_act;
@@ -697,18 +877,15 @@ int get_fortified_defense_power(const struct unit *attacker,
  Unlike the one got from win chance this doesn't potentially get insanely
  small if the units are unevenly matched, unlike win_chance.
  */
-static int get_defense_rating(const struct unit *attacker,
-                              const struct unit *defender)
+static int get_defense_rating(const struct combat_pairing *pairing)
 {
-  int afp, dfp;
-
-  int rating = get_total_defense_power(attacker, defender);
-  get_modified_firepower(attacker, defender, &afp, &dfp);
+  int rating = pairing->def_power;
 
   // How many rounds the defender will last
-  rating *= (defender->hp + afp - 1) / (afp ?: 1);
+  rating *= (pairing->defender->hp + pairing->att_fp - 1)
+            / (pairing->att_fp ?: 1);
 
-  rating *= dfp;
+  rating *= pairing->def_fp;
 
   return rating;
 }
@@ -721,10 +898,43 @@ static int get_defense_rating(const struct unit *attacker,
 struct unit *get_defender(const struct unit *attacker,
                           const struct tile *ptile)
 {
+  return get_defender_odds(attacker, ptile, nullptr);
+}
+
+/**
+   Same as get_defender(), and if win_chance is not nullptr, also returns
+   the chance of the attacker winning against that defender (as
+   unit_win_chance() would), which has been computed anyway. All the
+   possible defenders are evaluated in one unit_win_chances() call.
+ */
+struct unit *get_defender_odds(const struct unit *attacker,
+                               const struct tile *ptile,
+                               double *win_chance)
+{
+  QVarLengthArray<struct combat_pairing, 16> pairings;
   struct unit *bestdef = nullptr;
   int bestvalue = -99, best_cost = 0, rating_of_best = 0;
+  double best_chance = 0.0;
 
-  /* Simply call win_chance with all the possible defenders in turn, and
+  unit_list_iterate(ptile->units, defender)
+  {
+    /* We used to skip over allied units, but the logic for that is
+     * complicated and is now handled elsewhere. */
+    if (unit_can_defend_here(&(wld.map), defender)
+        && unit_attack_unit_at_tile_result(attacker, defender, ptile)
+               == ATT_OK) {
+      struct combat_pairing pairing;
+
+      pairing.attacker = attacker;
+      pairing.defender = defender;
+      pairings.append(pairing);
+    }
+  }
+  unit_list_iterate_end;
+
+  unit_win_chances(pairings.data(), pairings.size());
+
+  /* Simply compare the win chances against all the possible defenders, and
    * take the best one.  It currently uses build cost as a tiebreaker in
    * case 2 units are identical, but this is crude as build cost does not
    * neccesarily have anything to do with the value of a unit.  This function
@@ -733,50 +943,47 @@ struct unit *get_defender(const struct unit *attacker,
    * making it able to fx choose a 1a/9d unit over a 10a/10d unit. It should
    * also be able to spare units without full hp's to some extent, as these
    * could be more valuable later. */
-  unit_list_iterate(ptile->units, defender)
-  {
-    /* We used to skip over allied units, but the logic for that is
-     * complicated and is now handled elsewhere. */
-    if (unit_can_defend_here(&(wld.map), defender)
-        && unit_attack_unit_at_tile_result(attacker, defender, ptile)
-               == ATT_OK) {
-      bool change = false;
-      int build_cost = unit_build_shield_cost_base(defender);
-      int defense_rating = get_defense_rating(attacker, defender);
-      // This will make units roughly evenly good defenders look alike.
-      int unit_def = static_cast<int>(
-          100000 * (1 - unit_win_chance(attacker, defender)));
-
-      fc_assert_action(0 <= unit_def, continue);
-
-      if (unit_has_type_flag(defender, UTYF_GAMELOSS)
-          && !is_stack_vulnerable(unit_tile(defender))) {
-        unit_def = -1; // then always use leader as last defender.
-        /* FIXME: multiple gameloss units with varying defense value
-         * not handled. */
-      }
+  for (const auto &pairing : pairings) {
+    struct unit *defender = const_cast<struct unit *>(pairing.defender);
+    bool change = false;
+    int build_cost = unit_build_shield_cost_base(defender);
+    int defense_rating = get_defense_rating(&pairing);
+    // This will make units roughly evenly good defenders look alike.
+    int unit_def = static_cast<int>(100000 * (1 - pairing.win_chance));
+
+    fc_assert_action(0 <= unit_def, continue);
+
+    if (unit_has_type_flag(defender, UTYF_GAMELOSS)
+        && !is_stack_vulnerable(unit_tile(defender))) {
+      unit_def = -1; // then always use leader as last defender.
+      /* FIXME: multiple gameloss units with varying defense value
+       * not handled. */
+    }
 
-      if (unit_def > bestvalue) {
+    if (unit_def > bestvalue) {
+      change = true;
+    } else if (unit_def == bestvalue) {
+      if (build_cost < best_cost) {
         change = true;
-      } else if (unit_def == bestvalue) {
-        if (build_cost < best_cost) {
+      } else if (build_cost == best_cost) {
+        if (rating_of_best < defense_rating) {
           change = true;
-        } else if (build_cost == best_cost) {
-          if (rating_of_best < defense_rating) {
-            change = true;
-          }
         }
       }
+    }
 
-      if (change) {
-        bestvalue = unit_def;
-        bestdef = defender;
-        best_cost = build_cost;
-        rating_of_best = defense_rating;
-      }
+    if (change) {
+      bestvalue = unit_def;
+      bestdef = defender;
+      best_cost = build_cost;
+      rating_of_best = defense_rating;
+      best_chance = pairing.win_chance;
     }
   }
-  unit_list_iterate_end;
+
+  if (nullptr != win_chance) {
+    *win_chance = best_chance;
+  }
 
   return bestdef;
 }
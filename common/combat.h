@@ -43,6 +43,17 @@ unit_attack_units_at_tile_result(const struct unit *punit,
 bool can_unit_attack_tile(const struct unit *punit,
                           const struct tile *ptile);
 
+/* An attacker and a defender evaluated by unit_win_chances(), and the
+ * results of the evaluation. */
+struct combat_pairing {
+  const struct unit *attacker;
+  const struct unit *defender;
+
+  int att_power, def_power;
+  int att_fp, def_fp;
+  double win_chance;
+};
+
 double win_chance(int as, int ahp, int afp, int ds, int dhp, int dfp);
 
 void get_modified_firepower(const struct unit *attacker,
@@ -50,6 +61,7 @@ void get_modified_firepower(const struct unit *attacker,
                             int *def_fp);
 double unit_win_chance(const struct unit *attacker,
                        const struct unit *defender);
+void unit_win_chances(struct combat_pairing *pairings, int count);
 
 struct city *sdi_try_defend(const struct player *owner,
                             const struct tile *ptile);
@@ -73,6 +85,9 @@ int get_total_attack_power(const struct unit *attacker,
 
 struct unit *get_defender(const struct unit *attacker,
                           const struct tile *ptile);
+struct unit *get_defender_odds(const struct unit *attacker,
+                               const struct tile *ptile,
+                               double *win_chance);
 
 struct unit *get_diplomatic_defender(const struct unit *act_unit,
                                      const struct unit *pvictim,
@@ -167,6 +167,7 @@ struct civ_game {
       int revolution_length;
       int spaceship_travel_time;
       bool threaded_save;
+      int ai_threads;
       enum compress_type save_compress_type;
       int save_nturns;
       int save_frequency;
@@ -641,6 +642,10 @@ extern struct world wld;
 
 #define GAME_DEFAULT_THREADED_SAVE false
 
+#define GAME_DEFAULT_AI_THREADS 0
+#define GAME_MIN_AI_THREADS 0
+#define GAME_MAX_AI_THREADS 64
+
 #define GAME_DEFAULT_USER_META_MESSAGE ""
 
 #define GAME_DEFAULT_SKILL_LEVEL AI_LEVEL_EASY
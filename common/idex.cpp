@@ -15,11 +15,14 @@
    idex = ident index: a lookup table for quick mapping of unit and city
    id values to unit and city pointers.
 
-   Method: use separate hash tables for each type.
-   Means code duplication for city/unit cases, but simplicity advantages.
+   Method: use separate tables for each type, indexed directly by the id.
+   The server hands out ids densely from a bounded range (see
+   identity_number()), so a flat array of slots is small and a lookup is a
+   single bounds-checked load. The tables grow as larger ids get
+   registered and are never shrunk; going over a table visits the objects
+   in id order.
    Don't have to manage memory at all: store pointers to unit and city
-   structs allocated elsewhere, and keys are pointers to id values inside
-   the structs.
+   structs allocated elsewhere.
 
    Note id values should probably be unsigned int: here leave as plain int
    so can use pointers to pcity->id etc.
@@ -34,17 +37,42 @@
 
 #include "idex.h"
 
+/**
+    Returns the object registered under 'id' in the table, or nullptr.
+ */
+template <typename T>
+static const T *idex_slot_get(const QVector<const T *> *table, int id)
+{
+  if (id < 0 || id >= table->size()) {
+    return nullptr;
+  }
+  return table->at(id);
+}
+
+/**
+    Makes sure the table has a slot for 'id' and returns it.
+ */
+template <typename T>
+static const T *&idex_slot(QVector<const T *> *table, int id)
+{
+  if (id >= table->size()) {
+    // Grow geometrically; new slots are empty.
+    table->resize(qMax(id + 1, 2 * table->size()));
+  }
+  return (*table)[id];
+}
+
 /**
     Initialize.  Should call this at the start before use.
  */
 void idex_init(struct world *iworld)
 {
-  iworld->cities = new QHash<int, const struct city *>;
-  iworld->units = new QHash<int, const struct unit *>;
+  iworld->cities = new QVector<const struct city *>;
+  iworld->units = new QVector<const struct unit *>;
 }
 
 /**
-    Free the hashs.
+    Free the tables.
  */
 void idex_free(struct world *iworld)
 {
@@ -62,14 +90,14 @@ void idex_register_city(struct world *iworld, struct city *pcity)
 {
   const struct city *old;
 
-  if (iworld->cities->contains(pcity->id)) {
-    old = iworld->cities->value(pcity->id);
-    fc_assert_ret_msg(nullptr == old,
-                      "IDEX: city collision: new %d %p %s, old %d %p %s",
-                      pcity->id, (void *) pcity, city_name_get(pcity),
-                      old->id, (void *) old, city_name_get(old));
-  }
-  iworld->cities->insert(pcity->id, pcity);
+  fc_assert_ret(0 <= pcity->id);
+
+  old = idex_slot_get(iworld->cities, pcity->id);
+  fc_assert_ret_msg(nullptr == old,
+                    "IDEX: city collision: new %d %p %s, old %d %p %s",
+                    pcity->id, (void *) pcity, city_name_get(pcity),
+                    old->id, (void *) old, city_name_get(old));
+  idex_slot(iworld->cities, pcity->id) = pcity;
 }
 
 /**
@@ -80,14 +108,14 @@ void idex_register_unit(struct world *iworld, struct unit *punit)
 {
   const struct unit *old;
 
-  if (iworld->units->contains(punit->id)) {
-    old = iworld->units->value(punit->id);
-    fc_assert_ret_msg(nullptr == old,
-                      "IDEX: unit collision: new %d %p %s, old %d %p %s",
-                      punit->id, (void *) punit, unit_rule_name(punit),
-                      old->id, (void *) old, unit_rule_name(old));
-  }
-  iworld->units->insert(punit->id, punit);
+  fc_assert_ret(0 <= punit->id);
+
+  old = idex_slot_get(iworld->units, punit->id);
+  fc_assert_ret_msg(nullptr == old,
+                    "IDEX: unit collision: new %d %p %s, old %d %p %s",
+                    punit->id, (void *) punit, unit_rule_name(punit),
+                    old->id, (void *) old, unit_rule_name(old));
+  idex_slot(iworld->units, punit->id) = punit;
 }
 
 /**
@@ -96,19 +124,18 @@ void idex_register_unit(struct world *iworld, struct unit *punit)
  */
 void idex_unregister_city(struct world *iworld, struct city *pcity)
 {
-  const struct city *old;
+  const struct city *old = idex_slot_get(iworld->cities, pcity->id);
 
-  if (!iworld->units->contains(pcity->id)) {
-    old = pcity;
-    fc_assert_ret_msg(nullptr != old, "IDEX: city unreg missing: %d %p %s",
-                      pcity->id, (void *) pcity, city_name_get(pcity));
-    fc_assert_ret_msg(old == pcity,
-                      "IDEX: city unreg mismatch: "
-                      "unreg %d %p %s, old %d %p %s",
-                      pcity->id, (void *) pcity, city_name_get(pcity),
-                      old->id, (void *) old, city_name_get(old));
+  if (nullptr == old) {
+    // Not registered, nothing to do.
+    return;
   }
-  iworld->cities->remove(pcity->id);
+  fc_assert_ret_msg(old == pcity,
+                    "IDEX: city unreg mismatch: "
+                    "unreg %d %p %s, old %d %p %s",
+                    pcity->id, (void *) pcity, city_name_get(pcity),
+                    old->id, (void *) old, city_name_get(old));
+  (*iworld->cities)[pcity->id] = nullptr;
 }
 
 /**
@@ -117,19 +144,18 @@ void idex_unregister_city(struct world *iworld, struct city *pcity)
  */
 void idex_unregister_unit(struct world *iworld, struct unit *punit)
 {
-  const struct unit *old;
+  const struct unit *old = idex_slot_get(iworld->units, punit->id);
 
-  if (!iworld->units->contains(punit->id)) {
-    old = punit;
-    fc_assert_ret_msg(nullptr != old, "IDEX: unit unreg missing: %d %p %s",
-                      punit->id, (void *) punit, unit_rule_name(punit));
-    fc_assert_ret_msg(old == punit,
-                      "IDEX: unit unreg mismatch: "
-                      "unreg %d %p %s, old %d %p %s",
-                      punit->id, (void *) punit, unit_rule_name(punit),
-                      old->id, (void *) old, unit_rule_name(old));
+  if (nullptr == old) {
+    // Not registered, nothing to do.
+    return;
   }
-  iworld->units->remove(punit->id);
+  fc_assert_ret_msg(old == punit,
+                    "IDEX: unit unreg mismatch: "
+                    "unreg %d %p %s, old %d %p %s",
+                    punit->id, (void *) punit, unit_rule_name(punit),
+                    old->id, (void *) old, unit_rule_name(old));
+  (*iworld->units)[punit->id] = nullptr;
 }
 
 /**
@@ -140,7 +166,7 @@ struct city *idex_lookup_city(struct world *iworld, int id)
 {
   const struct city *pcity;
 
-  pcity = iworld->cities->value(id);
+  pcity = idex_slot_get(iworld->cities, id);
 
   return const_cast<struct city *>(pcity);
 }
@@ -153,7 +179,7 @@ struct unit *idex_lookup_unit(struct world *iworld, int id)
 {
   const struct unit *punit;
 
-  punit = iworld->units->value(id);
+  punit = idex_slot_get(iworld->units, id);
 
   return const_cast<struct unit *>(punit);
 }
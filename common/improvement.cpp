@@ -18,6 +18,7 @@
 #include "support.h"
 
 // common
+#include "city.h"
 #include "game.h"
 #include "victory.h"
 
@@ -801,6 +802,27 @@ void wonder_destroyed(const struct city *pcity,
   }
 }
 
+/**
+   Returns the city where the current thread speculates the wonder to be
+   built (see city_speculation_begin()) if it belongs to 'pplayer', or
+   nullptr.
+
+   A speculated wonder is seen as built and in effect. This is how the AI
+   used to see it when it really added the wonder with
+   city_add_improvement(): wonder_built() sets the build turn to -1 rather
+   than to the current turn, so wonder_is_built() returned TRUE.
+ */
+static const struct city *speculated_wonder(const struct player *pplayer,
+                                            const struct impr_type *pimprove)
+{
+  const struct city *pcity = city_speculation_wonder(pimprove);
+
+  if (nullptr != pcity && city_owner(pcity) == pplayer) {
+    return pcity;
+  }
+  return nullptr;
+}
+
 /**
    Returns whether the player has lost this wonder after having owned it
    (small or great).
@@ -811,6 +833,10 @@ bool wonder_is_lost(const struct player *pplayer,
   fc_assert_ret_val(nullptr != pplayer, false);
   fc_assert_ret_val(is_wonder(pimprove), false);
 
+  if (nullptr != speculated_wonder(pplayer, pimprove)) {
+    return false;
+  }
+
   return pplayer->wonders[improvement_index(pimprove)] == WONDER_LOST;
 }
 
@@ -826,6 +852,11 @@ bool wonder_is_built(const struct player *pplayer,
   fc_assert_ret_val(nullptr != pplayer, false);
   fc_assert_ret_val(is_wonder(pimprove), false);
 
+  if (nullptr != speculated_wonder(pplayer, pimprove)) {
+    // In effect at once, see speculated_wonder()
+    return true;
+  }
+
   /* New city turn: Wonders don't take effect until the next
    * turn after building */
 
@@ -846,10 +877,15 @@ struct city *city_from_wonder(const struct player *pplayer,
                               const struct impr_type *pimprove)
 {
   int city_id = pplayer->wonders[improvement_index(pimprove)];
+  const struct city *pspec = speculated_wonder(pplayer, pimprove);
 
   fc_assert_ret_val(nullptr != pplayer, nullptr);
   fc_assert_ret_val(is_wonder(pimprove), nullptr);
 
+  if (nullptr != pspec) {
+    return const_cast<struct city *>(pspec);
+  }
+
   if (!WONDER_BUILT(city_id)) {
     return nullptr;
   }
@@ -891,6 +927,10 @@ bool great_wonder_is_built(const struct impr_type *pimprove)
   int owner;
   fc_assert_ret_val(is_great_wonder(pimprove), false);
 
+  if (nullptr != city_speculation_wonder(pimprove)) {
+    return true;
+  }
+
   owner = game.info.great_wonder_owners[windex];
   /* call wonder_is_built() to check the build turn */
   return (WONDER_OWNED(owner)
@@ -904,6 +944,10 @@ bool great_wonder_is_destroyed(const struct impr_type *pimprove)
 {
   fc_assert_ret_val(is_great_wonder(pimprove), false);
 
+  if (nullptr != city_speculation_wonder(pimprove)) {
+    return false;
+  }
+
   return (WONDER_DESTROYED
           == game.info.great_wonder_owners[improvement_index(pimprove)]);
 }
@@ -915,6 +959,10 @@ bool great_wonder_is_available(const struct impr_type *pimprove)
 {
   fc_assert_ret_val(is_great_wonder(pimprove), false);
 
+  if (nullptr != city_speculation_wonder(pimprove)) {
+    return false;
+  }
+
   return (WONDER_NOT_OWNED
           == game.info.great_wonder_owners[improvement_index(pimprove)]);
 }
@@ -926,9 +974,14 @@ bool great_wonder_is_available(const struct impr_type *pimprove)
 struct city *city_from_great_wonder(const struct impr_type *pimprove)
 {
   int player_id = game.info.great_wonder_owners[improvement_index(pimprove)];
+  const struct city *pspec = city_speculation_wonder(pimprove);
 
   fc_assert_ret_val(is_great_wonder(pimprove), nullptr);
 
+  if (nullptr != pspec) {
+    return const_cast<struct city *>(pspec);
+  }
+
   if (WONDER_OWNED(player_id)) {
 #ifdef FREECIV_DEBUG
     const struct player *pplayer = player_by_number(player_id);
@@ -958,9 +1011,14 @@ struct city *city_from_great_wonder(const struct impr_type *pimprove)
 struct player *great_wonder_owner(const struct impr_type *pimprove)
 {
   int player_id = game.info.great_wonder_owners[improvement_index(pimprove)];
+  const struct city *pspec = city_speculation_wonder(pimprove);
 
   fc_assert_ret_val(is_great_wonder(pimprove), nullptr);
 
+  if (nullptr != pspec) {
+    return city_owner(pspec);
+  }
+
   if (WONDER_OWNED(player_id)) {
     return player_by_number(player_id);
   } else {
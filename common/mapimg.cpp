@@ -10,16 +10,25 @@ received a copy of the GNU General Public License along with Freeciv21.
  */
 
 #include <cstdarg>
+#include <vector>
 
 #ifdef HAVE_MAPIMG_MAGICKWAND
 #include <wand/MagickWand.h>
 #endif // HAVE_MAPIMG_MAGICKWAND
 
+// Qt
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+
 // utility
 #include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
-#include "timing.h"
 
 // common
 #include "calendar.h"
@@ -84,8 +93,8 @@ struct tile_shape {
 
 struct img;
 
-typedef bv_pixel (*plot_func)(const struct tile *ptile,
-                              const struct player *pplayer, bool knowledge);
+typedef bv_pixel (*plot_func)(const struct img *pimg,
+                              const struct tile *ptile);
 typedef void (*base_coor_func)(struct img *pimg, int *base_x, int *base_y,
                                int x, int y);
 
@@ -96,21 +105,16 @@ static struct tile_shape tile_rect = {
     .y = {0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2,
           3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5}};
 
-static bv_pixel pixel_tile_rect(const struct tile *ptile,
-                                const struct player *pplayer,
-                                bool knowledge);
-static bv_pixel pixel_city_rect(const struct tile *ptile,
-                                const struct player *pplayer,
-                                bool knowledge);
-static bv_pixel pixel_unit_rect(const struct tile *ptile,
-                                const struct player *pplayer,
-                                bool knowledge);
-static bv_pixel pixel_fogofwar_rect(const struct tile *ptile,
-                                    const struct player *pplayer,
-                                    bool knowledge);
-static bv_pixel pixel_border_rect(const struct tile *ptile,
-                                  const struct player *pplayer,
-                                  bool knowledge);
+static bv_pixel pixel_tile_rect(const struct img *pimg,
+                                const struct tile *ptile);
+static bv_pixel pixel_city_rect(const struct img *pimg,
+                                const struct tile *ptile);
+static bv_pixel pixel_unit_rect(const struct img *pimg,
+                                const struct tile *ptile);
+static bv_pixel pixel_fogofwar_rect(const struct img *pimg,
+                                    const struct tile *ptile);
+static bv_pixel pixel_border_rect(const struct img *pimg,
+                                  const struct tile *ptile);
 static void base_coor_rect(struct img *pimg, int *base_x, int *base_y, int x,
                            int y);
 
@@ -126,21 +130,16 @@ static struct tile_shape tile_hexa = {
         4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7,
     }};
 
-static bv_pixel pixel_tile_hexa(const struct tile *ptile,
-                                const struct player *pplayer,
-                                bool knowledge);
-static bv_pixel pixel_city_hexa(const struct tile *ptile,
-                                const struct player *pplayer,
-                                bool knowledge);
-static bv_pixel pixel_unit_hexa(const struct tile *ptile,
-                                const struct player *pplayer,
-                                bool knowledge);
-static bv_pixel pixel_fogofwar_hexa(const struct tile *ptile,
-                                    const struct player *pplayer,
-                                    bool knowledge);
-static bv_pixel pixel_border_hexa(const struct tile *ptile,
-                                  const struct player *pplayer,
-                                  bool knowledge);
+static bv_pixel pixel_tile_hexa(const struct img *pimg,
+                                const struct tile *ptile);
+static bv_pixel pixel_city_hexa(const struct img *pimg,
+                                const struct tile *ptile);
+static bv_pixel pixel_unit_hexa(const struct img *pimg,
+                                const struct tile *ptile);
+static bv_pixel pixel_fogofwar_hexa(const struct img *pimg,
+                                    const struct tile *ptile);
+static bv_pixel pixel_border_hexa(const struct img *pimg,
+                                  const struct tile *ptile);
 static void base_coor_hexa(struct img *pimg, int *base_x, int *base_y, int x,
                            int y);
 
@@ -151,21 +150,16 @@ static struct tile_shape tile_isohexa = {
     .y = {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2,
           3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5}};
 
-static bv_pixel pixel_tile_isohexa(const struct tile *ptile,
-                                   const struct player *pplayer,
-                                   bool knowledge);
-static bv_pixel pixel_city_isohexa(const struct tile *ptile,
-                                   const struct player *pplayer,
-                                   bool knowledge);
-static bv_pixel pixel_unit_isohexa(const struct tile *ptile,
-                                   const struct player *pplayer,
-                                   bool knowledge);
-static bv_pixel pixel_fogofwar_isohexa(const struct tile *ptile,
-                                       const struct player *pplayer,
-                                       bool knowledge);
-static bv_pixel pixel_border_isohexa(const struct tile *ptile,
-                                     const struct player *pplayer,
-                                     bool knowledge);
+static bv_pixel pixel_tile_isohexa(const struct img *pimg,
+                                   const struct tile *ptile);
+static bv_pixel pixel_city_isohexa(const struct img *pimg,
+                                   const struct tile *ptile);
+static bv_pixel pixel_unit_isohexa(const struct img *pimg,
+                                   const struct tile *ptile);
+static bv_pixel pixel_fogofwar_isohexa(const struct img *pimg,
+                                       const struct tile *ptile);
+static bv_pixel pixel_border_isohexa(const struct img *pimg,
+                                     const struct tile *ptile);
 static void base_coor_isohexa(struct img *pimg, int *base_x, int *base_y,
                               int x, int y);
 
@@ -209,6 +203,8 @@ BV_DEFINE(bv_mapdef_arg, MAPDEF_COUNT);
 #define SPECENUM_VALUE2NAME "ppm"
 #define SPECENUM_VALUE3 IMGFORMAT_JPG
 #define SPECENUM_VALUE3NAME "jpg"
+#define SPECENUM_VALUE4 IMGFORMAT_DELTA
+#define SPECENUM_VALUE4NAME "delta"
 #include "specenum_gen.h"
 
 // image format
@@ -217,6 +213,8 @@ BV_DEFINE(bv_mapdef_arg, MAPDEF_COUNT);
 #define SPECENUM_VALUE0NAME "ppm"
 #define SPECENUM_VALUE1 IMGTOOL_MAGICKWAND
 #define SPECENUM_VALUE1NAME "magick"
+#define SPECENUM_VALUE2 IMGTOOL_DELTA
+#define SPECENUM_VALUE2NAME "delta"
 #include "specenum_gen.h"
 
 // player definitions
@@ -313,11 +311,40 @@ struct mapdef;
 #define IMG_LINE_HEIGHT 5
 #define IMG_TEXT_HEIGHT 12
 
+/* The game data needed to draw an image is copied by img_snapshot() so
+ * that the image can be drawn and saved on a worker thread while the game
+ * goes on. */
+struct img_tile {
+  enum known_type known;
+  const struct terrain *terrain;
+  int owner; // player index of the tile owner or -1
+  int city;  // player index of the city owner or -1
+  int unit;  // player index of the unit owner or -1
+};
+
+struct img_player {
+  bool used;
+  bool alive;
+  bool allied;        // allied with the only player shown
+  bool shared_vision; // gives shared vision to the only player shown
+  struct rgbcolor color;
+  QByteArray str; // see img_playerstr()
+};
+
 struct img {
-  struct mapdef *def; // map definition
-  int turn;           // save turn
+  struct mapdef *def;    // map definition; points to 'defcopy'
+  struct mapdef defcopy; // copy of the map definition
+  int turn;              // save turn
   char title[MAX_LEN_MAPDEF];
 
+  // snapshot of the game
+  bool borders;
+  bool fogofwar;
+  int viewer; // index of the only player shown or -1
+  int player_count;
+  std::vector<struct img_tile> tiles;
+  std::vector<struct img_player> players;
+
   // topology definition
   struct tile_shape *tileshape;
   plot_func pixel_tile;
@@ -341,6 +368,13 @@ struct img {
 static struct img *img_new(struct mapdef *mapdef, int topo, int xsize,
                            int ysize);
 static void img_destroy(struct img *pimg);
+static void img_snapshot(struct img *pimg);
+static void img_render_async(struct img *pimg, const char *mapimgfile,
+                             const char *path);
+static inline const struct img_tile *img_tile(const struct img *pimg,
+                                              const struct tile *ptile);
+static const struct rgbcolor *img_player_color(const struct img *pimg,
+                                               int plr_id);
 static inline void img_set_pixel(struct img *pimg, const int mindex,
                                  const struct rgbcolor *pcolor);
 static inline int img_index(const int x, const int y,
@@ -354,6 +388,7 @@ static void img_plot_tile(struct img *pimg, const struct tile *ptile,
 static bool img_save(const struct img *pimg, const char *mapimgfile,
                      const char *path);
 static bool img_save_ppm(const struct img *pimg, const char *mapimgfile);
+static bool img_save_delta(const struct img *pimg, const char *mapimgfile);
 #ifdef HAVE_MAPIMG_MAGICKWAND
 static bool img_save_magickwand(const struct img *pimg,
                                 const char *mapimgfile);
@@ -386,8 +421,27 @@ static struct toolkit img_toolkits[] = {
                         + IMGFORMAT_JPG,
                     img_save_magickwand, N_("ImageMagick"))
 #endif // HAVE_MAPIMG_MAGICKWAND
+        GEN_TOOLKIT(IMGTOOL_DELTA, IMGFORMAT_DELTA, IMGFORMAT_DELTA,
+                    img_save_delta, N_("Changes between images"))
+};
+
+/* State of the streams written by the 'delta' toolkit. The key is the map
+ * definition together with the players shown. */
+struct img_delta_stream {
+  QString filename;
+  int width;
+  int height;
+  int frames; // frames written since the last keyframe
+  std::vector<quint32> pixels;
 };
 
+// A keyframe is written every IMG_DELTA_KEYFRAMES frames.
+#define IMG_DELTA_KEYFRAMES 25
+
+Q_GLOBAL_STATIC(QMutex, img_delta_mutex)
+typedef QHash<QByteArray, struct img_delta_stream> img_delta_hash;
+Q_GLOBAL_STATIC(img_delta_hash, img_delta_streams)
+
 static const int img_toolkits_count = ARRAY_SIZE(img_toolkits);
 
 #ifdef HAVE_MAPIMG_MAGICKWAND
@@ -414,6 +468,8 @@ static const struct toolkit *img_toolkit_get(enum imagetool tool);
 #define MAX_LEN_ERRORBUF 1024
 
 static char error_buffer[MAX_LEN_ERRORBUF] = "\0";
+// Images are saved on worker threads, which also log their errors.
+static QMutex error_mutex;
 static void mapimg_log(const char *file, const char *function, int line,
                        const char *format, ...)
     fc__attribute((__format__(__printf__, 4, 5)));
@@ -422,6 +478,16 @@ static void mapimg_log(const char *file, const char *function, int line,
 #define MAPIMG_ASSERT_RET_VAL(cond, expr)                                   \
   fc_assert_action(cond, MAPIMG_LOG(_("internal error")); return (expr))
 
+// == worker threads ==
+// Map images are drawn and saved by these threads.
+Q_GLOBAL_STATIC(QThreadPool, img_pool)
+/* Images of the 'delta' toolkit are appended to a stream and depend on the
+ * previous frame, so they are saved one after another on a single thread
+ * in the order they were requested. */
+Q_GLOBAL_STATIC(QThreadPool, img_delta_pool)
+// Number of images which could not be saved since the last mapimg_wait().
+static QAtomicInt img_failures;
+
 // == additional functions ==
 
 static int bvplayers_count(const struct mapdef *pmapdef);
@@ -481,6 +547,8 @@ void mapimg_init(mapimg_tile_known_func mapimg_tile_known,
   fc_assert_ret(mapimg_plrcolor_get != nullptr);
   mapimg.mapimg_plrcolor_get = mapimg_plrcolor_get;
 
+  img_delta_pool->setMaxThreadCount(1);
+
   mapimg.init = true;
 }
 
@@ -493,6 +561,9 @@ void mapimg_reset()
     return;
   }
 
+  mapimg_wait();
+  img_delta_streams->clear();
+
   if (mapdef_list_size(mapimg.mapdef) > 0) {
     mapdef_list_iterate(mapimg.mapdef, pmapdef)
     {
@@ -711,9 +782,18 @@ char *mapimg_help(const char *cmdname)
 }
 
 /**
-   Returns the last error.
+   Returns the last error. The message is copied out under the lock, as the
+   worker threads may log a new one at any time. The returned string stays
+   valid until the next call.
  */
-const char *mapimg_error() { return error_buffer; }
+const char *mapimg_error()
+{
+  static char error_copy[MAX_LEN_ERRORBUF];
+  QMutexLocker locker(&error_mutex);
+
+  fc_strlcpy(error_copy, error_buffer, sizeof(error_copy));
+  return error_copy;
+}
 
 /**
    Define on map image.
@@ -1270,16 +1350,16 @@ bool mapimg_id2str(int id, char *str, size_t str_len)
    contains the map definition and <mapext> the selected image extension.
    If 'force' is FALSE, the image is only created if game.info.turn is a
    multiple of the map setting turns.
+
+   The image is drawn and saved later by a worker thread; use mapimg_wait()
+   to know whether it could be saved.
  */
 bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
                    const char *path)
 {
   struct img *pimg;
   char mapimgfile[MAX_LEN_PATH];
-  bool ret = true;
-#ifdef FREECIV_DEBUG
-  civtimer *timer_cpu, *timer_user;
-#endif
+  QElapsedTimer timer;
 
   if (map_is_empty()) {
     MAPIMG_LOG(_("map not yet created"));
@@ -1304,14 +1384,10 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
     return true;
   }
 
-#ifdef FREECIV_DEBUG
-  timer_cpu = timer_new(TIMER_CPU, TIMER_ACTIVE);
-  timer_start(timer_cpu);
-  timer_user = timer_new(TIMER_USER, TIMER_ACTIVE);
-  timer_start(timer_user);
-#endif // FREECIV_DEBUG
+  timer.start();
 
-  // create map
+  /* Only the snapshot of the game is taken here. The images are drawn and
+   * saved by the worker threads; see mapimg_wait(). */
   switch (pmapdef->player.show) {
   case SHOW_PLRNAME: // display player given by name
   case SHOW_PLRID:   // display player given by id
@@ -1322,11 +1398,8 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
                        mapimg_generate_name(pmapdef));
 
     pimg = img_new(pmapdef, CURRENT_TOPOLOGY, wld.map.xsize, wld.map.ysize);
-    img_createmap(pimg);
-    if (!img_save(pimg, mapimgfile, path)) {
-      ret = false;
-    }
-    img_destroy(pimg);
+    img_snapshot(pimg);
+    img_render_async(pimg, mapimgfile, path);
     break;
   case SHOW_EACH:  // one map for each player
   case SHOW_HUMAN: // one map for each human player
@@ -1347,29 +1420,30 @@ bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
 
       pimg =
           img_new(pmapdef, CURRENT_TOPOLOGY, wld.map.xsize, wld.map.ysize);
-      img_createmap(pimg);
-      if (!img_save(pimg, mapimgfile, path)) {
-        ret = false;
-      }
-      img_destroy(pimg);
-
-      if (!ret) {
-        break;
-      }
+      img_snapshot(pimg);
+      img_render_async(pimg, mapimgfile, path);
     }
     players_iterate_end;
     break;
   }
 
-#ifdef FREECIV_DEBUG
-  log_debug("Image generation time: %g seconds (%g apparent)",
-            timer_read_seconds(timer_cpu), timer_read_seconds(timer_user));
+  log_time(QStringLiteral("Map image snapshot: %1 milliseconds")
+               .arg(timer.elapsed()));
 
-  timer_destroy(timer_cpu);
-  timer_destroy(timer_user);
-#endif // FREECIV_DEBUG
+  return true;
+}
 
-  return ret;
+/**
+   Wait until all the map images requested with mapimg_create() are saved.
+   Returns FALSE if one of them could not be saved; the error message of
+   the last failure is available with mapimg_error().
+ */
+bool mapimg_wait()
+{
+  img_pool->waitForDone();
+  img_delta_pool->waitForDone();
+
+  return img_failures.fetchAndStoreOrdered(0) == 0;
 }
 
 /**
@@ -1397,7 +1471,7 @@ bool mapimg_colortest(const char *savename, const char *path)
   pimg = img_new(pmapdef, 0, SIZE_X + 2,
                  SIZE_Y * (max_playercolor / SIZE_X) + 2);
 
-  pixel = pimg->pixel_tile(nullptr, nullptr, false);
+  pixel = pimg->pixel_tile(pimg, nullptr);
 
   pcolor = imgcolor_special(IMGCOLOR_OCEAN);
   for (i = 0; i < MAX(max_playercolor, max_terraincolor); i++) {
@@ -1647,6 +1721,7 @@ static void mapimg_log(const char *file, const char *function, int line,
                        const char *format, ...)
 {
   va_list args;
+  QMutexLocker locker(&error_mutex);
 
   va_start(args, format);
   fc_vsnprintf(error_buffer, sizeof(error_buffer), format, args);
@@ -1814,7 +1889,12 @@ static struct img *img_new(struct mapdef *mapdef, int topo, int xsize,
 {
   auto *pimg = new img;
 
-  pimg->def = mapdef;
+  pimg->defcopy = *mapdef;
+  pimg->def = &pimg->defcopy;
+  pimg->borders = false;
+  pimg->fogofwar = false;
+  pimg->viewer = -1;
+  pimg->player_count = 0;
   pimg->turn = game.info.turn;
   fc_snprintf(pimg->title, sizeof(pimg->title), _("Turn: %4d - Year: %10s"),
               game.info.turn, calendar_text());
@@ -1903,13 +1983,123 @@ static struct img *img_new(struct mapdef *mapdef, int topo, int xsize,
 static void img_destroy(struct img *pimg)
 {
   if (pimg != nullptr) {
-    // do not free pimg->def
+    // pimg->def points into pimg
     delete[] pimg->map;
     delete pimg;
     pimg = nullptr;
   }
 }
 
+/**
+   Copy the data of the tiles and players needed to draw the image. This is
+   all the image needs from the game besides the map topology.
+ */
+static void img_snapshot(struct img *pimg)
+{
+  struct player *viewer = nullptr, *pplayer;
+  bool plr_knowledge = pimg->def->layers[MAPIMG_LAYER_KNOWLEDGE];
+  int i;
+
+  pimg->borders = (game.info.borders > 0);
+  pimg->fogofwar = game.info.fogofwar;
+  pimg->player_count = player_count();
+
+  if (bvplayers_count(pimg->def) == 1) {
+    // only one player; its knowledge is shown
+    players_iterate(aplayer)
+    {
+      if (BV_ISSET(pimg->def->player.checked_plrbv,
+                   player_index(aplayer))) {
+        viewer = aplayer;
+        break;
+      }
+    }
+    players_iterate_end;
+  }
+  pimg->viewer = (viewer != nullptr ? player_index(viewer) : -1);
+
+  pimg->players.resize(player_slot_count());
+  for (i = 0; i < player_slot_count(); i++) {
+    struct img_player *pplr = &pimg->players[i];
+
+    pplayer = player_by_number(i);
+    pplr->used = (pplayer != nullptr);
+    if (!pplr->used) {
+      continue;
+    }
+
+    pplr->alive = pplayer->is_alive;
+    pplr->allied = (viewer != nullptr && pplayers_allied(pplayer, viewer));
+    pplr->shared_vision =
+        (viewer != nullptr && gives_shared_vision(pplayer, viewer));
+    pplr->color = *imgcolor_player(i);
+    pplr->str = img_playerstr(pplayer);
+  }
+
+  pimg->tiles.resize(MAP_INDEX_SIZE);
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    struct img_tile *ptinfo = &pimg->tiles[tile_index(ptile)];
+
+    ptinfo->known = mapimg.mapimg_tile_known(ptile, viewer, plr_knowledge);
+    ptinfo->terrain =
+        mapimg.mapimg_tile_terrain(ptile, viewer, plr_knowledge);
+    pplayer = mapimg.mapimg_tile_owner(ptile, viewer, plr_knowledge);
+    ptinfo->owner = (pplayer != nullptr ? player_index(pplayer) : -1);
+    pplayer = mapimg.mapimg_tile_city(ptile, viewer, plr_knowledge);
+    ptinfo->city = (pplayer != nullptr ? player_index(pplayer) : -1);
+    pplayer = mapimg.mapimg_tile_unit(ptile, viewer, plr_knowledge);
+    ptinfo->unit = (pplayer != nullptr ? player_index(pplayer) : -1);
+  }
+  whole_map_iterate_end;
+}
+
+/**
+   Draw and save the image on a worker thread. The image is destroyed
+   afterwards.
+ */
+static void img_render_async(struct img *pimg, const char *mapimgfile,
+                             const char *path)
+{
+  QByteArray file = mapimgfile;
+  QByteArray dir = (path != nullptr ? path : QByteArray());
+  bool has_path = (path != nullptr);
+  QThreadPool *pool =
+      (pimg->def->tool == IMGTOOL_DELTA ? img_delta_pool() : img_pool());
+
+  pool->start([pimg, file, dir, has_path]() {
+    img_createmap(pimg);
+    if (!img_save(pimg, file.constData(),
+                  has_path ? dir.constData() : nullptr)) {
+      qCritical(_("Error saving map image '%s'."), file.constData());
+      img_failures.ref();
+    }
+    img_destroy(pimg);
+  });
+}
+
+/**
+   Return the snapshot data of a tile.
+ */
+static inline const struct img_tile *img_tile(const struct img *pimg,
+                                              const struct tile *ptile)
+{
+  return &pimg->tiles[tile_index(ptile)];
+}
+
+/**
+   Return the color of a player as copied by img_snapshot().
+ */
+static const struct rgbcolor *img_player_color(const struct img *pimg,
+                                               int plr_id)
+{
+  fc_assert_ret_val(plr_id >= 0 && plr_id < (int) pimg->players.size()
+                        && pimg->players[plr_id].used,
+                    imgcolor_special(IMGCOLOR_ERROR));
+
+  return &pimg->players[plr_id].color;
+}
+
 /**
    Set the color of one pixel.
  */
@@ -2038,7 +2228,7 @@ static bool img_save_magickwand(const struct img *pimg,
                                 const char *mapimgfile)
 {
   const struct rgbcolor *pcolor = nullptr;
-  struct player *pplr_now = nullptr, *pplr_only = nullptr;
+  const struct img_player *pplr_now = nullptr;
   bool ret = true;
   char imagefile[MAX_LEN_PATH];
   char str_color[32], comment[2048] = "", title[258];
@@ -2078,22 +2268,12 @@ static bool img_save_magickwand(const struct img *pimg,
 
   textoffset = 0;
   if (withplr) {
-    if (bvplayers_count(pimg->def) == 1) {
-      // only one player
-      for (i = 0; i < player_slot_count(); i++) {
-        if (BV_ISSET(pimg->def->player.checked_plrbv, i)) {
-          pplr_only = player_by_number(i);
-          break;
-        }
-      }
-    }
-
-    if (pplr_only) {
+    if (pimg->viewer >= 0) {
       magickwand_size_t plr_color_square = IMG_TEXT_HEIGHT;
 
       textoffset += IMG_TEXT_HEIGHT + IMG_BORDER_HEIGHT;
 
-      pcolor = imgcolor_player(player_index(pplr_only));
+      pcolor = img_player_color(pimg, pimg->viewer);
       SET_COLOR(str_color, pcolor);
 
       // Show the color of the selected player.
@@ -2112,8 +2292,9 @@ static bool img_save_magickwand(const struct img *pimg,
     }
 
     // Show a line displaying the colors of alive players
-    plrwidth = map_width / MIN(map_width, player_count());
-    plroffset = (map_width - MIN(map_width, plrwidth * player_count())) / 2;
+    plrwidth = map_width / MIN(map_width, pimg->player_count);
+    plroffset =
+        (map_width - MIN(map_width, plrwidth * pimg->player_count)) / 2;
 
     imw = NewPixelRegionIterator(mw, IMG_BORDER_WIDTH,
                                  IMG_BORDER_HEIGHT + IMG_TEXT_HEIGHT
@@ -2126,19 +2307,19 @@ static bool img_save_magickwand(const struct img *pimg,
       // x coordinate
       for (x = plroffset; x < map_width; x++) {
         i = (x - plroffset) / plrwidth;
-        pplr_now = player_by_number(i);
 
-        if (i > player_count() || pplr_now == nullptr
-            || !pplr_now->is_alive) {
+        if (i >= (int) pimg->players.size() || !pimg->players[i].used
+            || !pimg->players[i].alive) {
           continue;
         }
+        pplr_now = &pimg->players[i];
 
         if (BV_ISSET(pimg->def->player.checked_plrbv, i)) {
           // The selected player is alive - display it.
-          pcolor = imgcolor_player(i);
+          pcolor = img_player_color(pimg, i);
           SET_COLOR(str_color, pcolor);
           PixelSetColor(pmw[x], str_color);
-        } else if (pplr_only != nullptr) {
+        } else if (pimg->viewer >= 0) {
           /* Display the state between pplr_only and pplr_now:
            *  - if allied:
            *      - show each second pixel
@@ -2151,9 +2332,9 @@ static bool img_save_magickwand(const struct img *pimg,
            *                # # #       # # #
            *   shared      allied      shared vision
            *   vision                   + allied */
-          if ((pplayers_allied(pplr_now, pplr_only) && (x + y) % 2 == 0)
-              || (y % 2 == 0 && gives_shared_vision(pplr_now, pplr_only))) {
-            pcolor = imgcolor_player(i);
+          if ((pplr_now->allied && (x + y) % 2 == 0)
+              || (y % 2 == 0 && pplr_now->shared_vision)) {
+            pcolor = img_player_color(pimg, i);
             SET_COLOR(str_color, pcolor);
             PixelSetColor(pmw[x], str_color);
           }
@@ -2210,17 +2391,13 @@ static bool img_save_magickwand(const struct img *pimg,
   cat_snprintf(comment, sizeof(comment), "map definition: %s\n",
                pimg->def->maparg);
   if (BV_ISSET_ANY(pimg->def->player.checked_plrbv)) {
-    players_iterate(pplayer)
-    {
-      if (!BV_ISSET(pimg->def->player.checked_plrbv,
-                    player_index(pplayer))) {
-        continue;
+    for (i = 0; i < (int) pimg->players.size(); i++) {
+      if (pimg->players[i].used
+          && BV_ISSET(pimg->def->player.checked_plrbv, i)) {
+        cat_snprintf(comment, sizeof(comment), "%s\n",
+                     pimg->players[i].str.constData());
       }
-
-      pcolor = imgcolor_player(player_index(pplayer));
-      cat_snprintf(comment, sizeof(comment), "%s\n", img_playerstr(pplayer));
     }
-    players_iterate_end;
   }
   MagickCommentImage(mw, comment);
 
@@ -2249,7 +2426,7 @@ static bool img_save_ppm(const struct img *pimg, const char *mapimgfile)
 {
   char ppmname[MAX_LEN_PATH];
   FILE *fp;
-  int x, y, xxx, yyy, mindex;
+  int i, x, y, xxx, yyy, mindex;
   const struct rgbcolor *pcolor;
 
   if (pimg->def->format != IMGFORMAT_PPM) {
@@ -2276,16 +2453,12 @@ static bool img_save_ppm(const struct img *pimg, const char *mapimgfile)
   if (pimg->def->colortest) {
     fprintf(fp, "# color test\n");
   } else if (BV_ISSET_ANY(pimg->def->player.checked_plrbv)) {
-    players_iterate(pplayer)
-    {
-      if (!BV_ISSET(pimg->def->player.checked_plrbv,
-                    player_index(pplayer))) {
-        continue;
+    for (i = 0; i < (int) pimg->players.size(); i++) {
+      if (pimg->players[i].used
+          && BV_ISSET(pimg->def->player.checked_plrbv, i)) {
+        fprintf(fp, "# %s\n", pimg->players[i].str.constData());
       }
-
-      fprintf(fp, "# %s\n", img_playerstr(pplayer));
     }
-    players_iterate_end;
   } else {
     fprintf(fp, "# no players\n");
   }
@@ -2320,6 +2493,144 @@ static bool img_save_ppm(const struct img *pimg, const char *mapimgfile)
   return true;
 }
 
+/**
+   Save an image to a delta stream (toolkit: delta).
+
+   The stream starts with MAPIMG_DELTA_MAGIC, MAPIMG_DELTA_VERSION and the
+   map definition. Each image is appended as a frame (see QDataStream):
+
+     quint8      MAPIMG_DELTA_KEYFRAME or MAPIMG_DELTA_FRAME
+     qint32      turn
+     QByteArray  title
+     qint32      width, height, zoom
+     QByteArray  qCompress()ed data
+
+   The data of a keyframe are the RGB values of all pixels. The data of a
+   frame are runs of changed pixels: quint32 start, quint32 length and the
+   RGB values of the run. A new stream is started for each map definition
+   and player selection the first time it is saved; the following images
+   are appended to it.
+ */
+static bool img_save_delta(const struct img *pimg, const char *mapimgfile)
+{
+  char deltaname[MAX_LEN_PATH];
+  int npixels = pimg->imgsize.x * pimg->imgsize.y;
+  std::vector<quint32> pixels(npixels);
+  struct img_delta_stream fresh, *pstream;
+  QByteArray key = pimg->def->maparg;
+  QByteArray data;
+  bool keyframe;
+  int i, start;
+  qint64 good_size;
+
+  if (!img_filename(mapimgfile, IMGFORMAT_DELTA, deltaname,
+                    sizeof(deltaname))) {
+    MAPIMG_LOG(_("error generating the file name"));
+    return false;
+  }
+
+  for (i = 0; i < npixels; i++) {
+    const struct rgbcolor *pcolor = pimg->map[i];
+
+    if (pcolor == nullptr) {
+      pcolor = imgcolor_special(IMGCOLOR_BACKGROUND);
+    }
+    pixels[i] = (pcolor->r << 16) | (pcolor->g << 8) | pcolor->b;
+  }
+
+  QMutexLocker locker(img_delta_mutex());
+
+  key.append(reinterpret_cast<const char *>(
+                 pimg->def->player.checked_plrbv.vec),
+             sizeof(pimg->def->player.checked_plrbv.vec));
+  if (pimg->def->colortest || !img_delta_streams->contains(key)) {
+    fresh.filename = deltaname;
+    fresh.width = 0;
+    fresh.height = 0;
+    fresh.frames = 0;
+    pstream = &fresh;
+  } else {
+    pstream = &(*img_delta_streams)[key];
+  }
+
+  QFile file(pstream->filename);
+  if (!file.open(pstream == &fresh ? QIODevice::WriteOnly
+                                   : QIODevice::Append)) {
+    MAPIMG_LOG(_("could not open file: %s"),
+               qUtf8Printable(pstream->filename));
+    return false;
+  }
+
+  keyframe = (pstream->width != pimg->imgsize.x
+              || pstream->height != pimg->imgsize.y
+              || pstream->frames >= IMG_DELTA_KEYFRAMES);
+
+  /* The frame is put together in memory first, so that the file never
+   * ends with part of a frame. */
+  QByteArray frame;
+  QDataStream out(&frame, QIODevice::WriteOnly);
+  if (pstream == &fresh) {
+    out.writeRawData(MAPIMG_DELTA_MAGIC, qstrlen(MAPIMG_DELTA_MAGIC));
+    out << quint32(MAPIMG_DELTA_VERSION);
+    out << QByteArray(pimg->def->maparg);
+  }
+
+  if (keyframe) {
+    data.reserve(npixels * 3);
+    for (i = 0; i < npixels; i++) {
+      data.append(char(pixels[i] >> 16));
+      data.append(char(pixels[i] >> 8));
+      data.append(char(pixels[i]));
+    }
+  } else {
+    QDataStream runs(&data, QIODevice::WriteOnly);
+
+    for (i = 0; i < npixels;) {
+      if (pixels[i] == pstream->pixels[i]) {
+        i++;
+        continue;
+      }
+      start = i;
+      while (i < npixels && pixels[i] != pstream->pixels[i]) {
+        i++;
+      }
+      runs << quint32(start) << quint32(i - start);
+      for (int j = start; j < i; j++) {
+        runs << quint8(pixels[j] >> 16) << quint8(pixels[j] >> 8)
+             << quint8(pixels[j]);
+      }
+    }
+  }
+
+  out << quint8(keyframe ? MAPIMG_DELTA_KEYFRAME : MAPIMG_DELTA_FRAME);
+  out << qint32(pimg->turn) << QByteArray(pimg->title);
+  out << qint32(pimg->imgsize.x) << qint32(pimg->imgsize.y)
+      << qint32(pimg->def->zoom);
+  out << qCompress(data);
+
+  good_size = file.size();
+  if (out.status() != QDataStream::Ok
+      || file.write(frame) != frame.size() || !file.flush()) {
+    // Cut off what was written, the stream ends at the last good frame.
+    file.resize(good_size);
+    MAPIMG_LOG(_("error saving map image '%s'"),
+               qUtf8Printable(pstream->filename));
+    return false;
+  }
+
+  pstream->width = pimg->imgsize.x;
+  pstream->height = pimg->imgsize.y;
+  pstream->frames = (keyframe ? 1 : pstream->frames + 1);
+  pstream->pixels = std::move(pixels);
+  qDebug("Map image saved to '%s'.", qUtf8Printable(pstream->filename));
+
+  if (pstream == &fresh && !pimg->def->colortest) {
+    img_delta_streams->insert(key, std::move(fresh));
+  }
+
+  return true;
+}
+
 /**
    Generate the final filename.
  */
@@ -2359,47 +2670,31 @@ static void img_createmap(struct img *pimg)
   const struct rgbcolor *pcolor;
   bv_pixel pixel;
   int player_id;
-  struct player *pplayer = nullptr;
-  struct player *plr_tile = nullptr, *plr_city = nullptr,
-                *plr_unit = nullptr;
-  enum known_type tile_knowledge = TILE_UNKNOWN;
-  struct terrain *pterrain = nullptr;
   bool plr_knowledge = pimg->def->layers[MAPIMG_LAYER_KNOWLEDGE];
+  bool viewer = (pimg->viewer >= 0);
 
   whole_map_iterate(&(wld.map), ptile)
   {
-    if (bvplayers_count(pimg->def) == 1) {
-      // only one player; get player id for 'known' and 'fogofwar'
-      players_iterate(aplayer)
-      {
-        if (BV_ISSET(pimg->def->player.checked_plrbv,
-                     player_index(aplayer))) {
-          pplayer = aplayer;
-          tile_knowledge =
-              mapimg.mapimg_tile_known(ptile, pplayer, plr_knowledge);
-          break;
-        }
-      }
-      players_iterate_end;
-    }
+    const struct img_tile *ptinfo = img_tile(pimg, ptile);
+    // 'known' and 'fogofwar' are only used if one player is shown
+    enum known_type tile_knowledge = viewer ? ptinfo->known : TILE_UNKNOWN;
+    const struct terrain *pterrain = ptinfo->terrain;
 
     // known tiles
-    if (plr_knowledge && pplayer != nullptr
-        && tile_knowledge == TILE_UNKNOWN) {
+    if (plr_knowledge && viewer && tile_knowledge == TILE_UNKNOWN) {
       // plot nothing iff tile is not known
       continue;
     }
 
     // terrain
-    pterrain = mapimg.mapimg_tile_terrain(ptile, pplayer, plr_knowledge);
     if (pimg->def->layers[MAPIMG_LAYER_TERRAIN]) {
       // full terrain
-      pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
+      pixel = pimg->pixel_tile(pimg, ptile);
       pcolor = imgcolor_terrain(pterrain);
       img_plot_tile(pimg, ptile, pcolor, pixel);
     } else {
       // basic terrain
-      pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
+      pixel = pimg->pixel_tile(pimg, ptile);
       if (is_ocean(pterrain)) {
         img_plot_tile(pimg, ptile, imgcolor_special(IMGCOLOR_OCEAN), pixel);
       } else {
@@ -2408,55 +2703,52 @@ static void img_createmap(struct img *pimg)
     }
 
     // (land) area within borders and borders
-    plr_tile = mapimg.mapimg_tile_owner(ptile, pplayer, plr_knowledge);
-    if (game.info.borders > 0 && nullptr != plr_tile) {
-      player_id = player_index(plr_tile);
+    player_id = ptinfo->owner;
+    if (pimg->borders && player_id >= 0) {
       if (pimg->def->layers[MAPIMG_LAYER_AREA] && !is_ocean(pterrain)
           && BV_ISSET(pimg->def->player.checked_plrbv, player_id)) {
         // the tile is land and inside the players borders
-        pixel = pimg->pixel_tile(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
+        pixel = pimg->pixel_tile(pimg, ptile);
+        pcolor = img_player_color(pimg, player_id);
         img_plot_tile(pimg, ptile, pcolor, pixel);
       } else if (pimg->def->layers[MAPIMG_LAYER_BORDERS]
                  && (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-                     || (plr_knowledge && pplayer != nullptr))) {
+                     || (plr_knowledge && viewer))) {
         /* plot borders if player is selected or view range of the one
          * displayed player */
-        pixel = pimg->pixel_border(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
+        pixel = pimg->pixel_border(pimg, ptile);
+        pcolor = img_player_color(pimg, player_id);
         img_plot_tile(pimg, ptile, pcolor, pixel);
       }
     }
 
     // cities and units
-    plr_city = mapimg.mapimg_tile_city(ptile, pplayer, plr_knowledge);
-    plr_unit = mapimg.mapimg_tile_unit(ptile, pplayer, plr_knowledge);
-    if (pimg->def->layers[MAPIMG_LAYER_CITIES] && plr_city) {
-      player_id = player_index(plr_city);
+    if (pimg->def->layers[MAPIMG_LAYER_CITIES] && ptinfo->city >= 0) {
+      player_id = ptinfo->city;
       if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-          || (plr_knowledge && pplayer != nullptr)) {
+          || (plr_knowledge && viewer)) {
         /* plot cities if player is selected or view range of the one
          * displayed player */
-        pixel = pimg->pixel_city(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
+        pixel = pimg->pixel_city(pimg, ptile);
+        pcolor = img_player_color(pimg, player_id);
         img_plot_tile(pimg, ptile, pcolor, pixel);
       }
-    } else if (pimg->def->layers[MAPIMG_LAYER_UNITS] && plr_unit) {
-      player_id = player_index(plr_unit);
+    } else if (pimg->def->layers[MAPIMG_LAYER_UNITS] && ptinfo->unit >= 0) {
+      player_id = ptinfo->unit;
       if (BV_ISSET(pimg->def->player.checked_plrbv, player_id)
-          || (plr_knowledge && pplayer != nullptr)) {
+          || (plr_knowledge && viewer)) {
         /* plot units if player is selected or view range of the one
          * displayed player */
-        pixel = pimg->pixel_unit(ptile, pplayer, plr_knowledge);
-        pcolor = imgcolor_player(player_id);
+        pixel = pimg->pixel_unit(pimg, ptile);
+        pcolor = img_player_color(pimg, player_id);
         img_plot_tile(pimg, ptile, pcolor, pixel);
       }
     }
 
     // fogofwar; if only 1 player is plotted
-    if (game.info.fogofwar && pimg->def->layers[MAPIMG_LAYER_FOGOFWAR]
-        && pplayer != nullptr && tile_knowledge == TILE_KNOWN_UNSEEN) {
-      pixel = pimg->pixel_fogofwar(ptile, pplayer, plr_knowledge);
+    if (pimg->fogofwar && pimg->def->layers[MAPIMG_LAYER_FOGOFWAR]
+        && viewer && tile_knowledge == TILE_KNOWN_UNSEEN) {
+      pixel = pimg->pixel_fogofwar(pimg, ptile);
       pcolor = nullptr;
       img_plot_tile(pimg, ptile, pcolor, pixel);
     }
@@ -2486,12 +2778,11 @@ static void img_createmap(struct img *pimg)
    24 25 26 27 28 29
    30 31 32 33 34 35
  */
-static bv_pixel pixel_tile_rect(const struct tile *ptile,
-                                const struct player *pplayer, bool knowledge)
+static bv_pixel pixel_tile_rect(const struct img *pimg,
+                                const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_SET_ALL(pixel);
@@ -2507,12 +2798,11 @@ static bv_pixel pixel_tile_rect(const struct tile *ptile,
    -- 25 26 27 28 --
    -- -- -- -- -- --
  */
-static bv_pixel pixel_city_rect(const struct tile *ptile,
-                                const struct player *pplayer, bool knowledge)
+static bv_pixel pixel_city_rect(const struct img *pimg,
+                                const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -2545,12 +2835,11 @@ static bv_pixel pixel_city_rect(const struct tile *ptile,
    -- -- -- -- -- --
    -- -- -- -- -- --
  */
-static bv_pixel pixel_unit_rect(const struct tile *ptile,
-                                const struct player *pplayer, bool knowledge)
+static bv_pixel pixel_unit_rect(const struct img *pimg,
+                                const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -2570,13 +2859,11 @@ static bv_pixel pixel_unit_rect(const struct tile *ptile,
    24 -- 26 -- 28 --
    -- 31 -- 33 -- 35
  */
-static bv_pixel pixel_fogofwar_rect(const struct tile *ptile,
-                                    const struct player *pplayer,
-                                    bool knowledge)
+static bv_pixel pixel_fogofwar_rect(const struct img *pimg,
+                                    const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -2615,28 +2902,27 @@ static bv_pixel pixel_fogofwar_rect(const struct tile *ptile,
 
               [S]
  */
-static bv_pixel pixel_border_rect(const struct tile *ptile,
-                                  const struct player *pplayer,
-                                  bool knowledge)
+static bv_pixel pixel_border_rect(const struct img *pimg,
+                                  const struct tile *ptile)
 {
   bv_pixel pixel;
   struct tile *pnext;
-  struct player *owner;
+  int owner;
 
   BV_CLR_ALL(pixel);
 
   fc_assert_ret_val(ptile != nullptr, pixel);
 
-  owner = mapimg.mapimg_tile_owner(ptile, pplayer, knowledge);
-  if (nullptr == owner) {
+  owner = img_tile(pimg, ptile)->owner;
+  if (owner < 0) {
     // no border
     return pixel;
   }
 
   pnext = mapstep(&(wld.map), ptile, DIR8_NORTH);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 0);
     BV_SET(pixel, 1);
     BV_SET(pixel, 2);
@@ -2647,8 +2933,8 @@ static bv_pixel pixel_border_rect(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_EAST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 5);
     BV_SET(pixel, 11);
     BV_SET(pixel, 17);
@@ -2659,8 +2945,8 @@ static bv_pixel pixel_border_rect(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_SOUTH);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 30);
     BV_SET(pixel, 31);
     BV_SET(pixel, 32);
@@ -2671,8 +2957,8 @@ static bv_pixel pixel_border_rect(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_WEST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 0);
     BV_SET(pixel, 6);
     BV_SET(pixel, 12);
@@ -2705,12 +2991,11 @@ static void base_coor_rect(struct img *pimg, int *base_x, int *base_y, int x,
       30 31 32 33
          34 35
  */
-static bv_pixel pixel_tile_hexa(const struct tile *ptile,
-                                const struct player *pplayer, bool knowledge)
+static bv_pixel pixel_tile_hexa(const struct img *pimg,
+                                const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_SET_ALL(pixel);
@@ -2728,12 +3013,11 @@ static bv_pixel pixel_tile_hexa(const struct tile *ptile,
       -- 31 32 --
          -- --
  */
-static bv_pixel pixel_city_hexa(const struct tile *ptile,
-                                const struct player *pplayer, bool knowledge)
+static bv_pixel pixel_city_hexa(const struct img *pimg,
+                                const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -2771,12 +3055,11 @@ static bv_pixel pixel_city_hexa(const struct tile *ptile,
       -- -- -- --
          -- --
  */
-static bv_pixel pixel_unit_hexa(const struct tile *ptile,
-                                const struct player *pplayer, bool knowledge)
+static bv_pixel pixel_unit_hexa(const struct img *pimg,
+                                const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -2798,13 +3081,11 @@ static bv_pixel pixel_unit_hexa(const struct tile *ptile,
       30 -- 32 --
          -- 35
  */
-static bv_pixel pixel_fogofwar_hexa(const struct tile *ptile,
-                                    const struct player *pplayer,
-                                    bool knowledge)
+static bv_pixel pixel_fogofwar_hexa(const struct img *pimg,
+                                    const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -2840,28 +3121,27 @@ static bv_pixel pixel_fogofwar_hexa(const struct tile *ptile,
            30 -- -- 33
     [S]       34 35       [E]
  */
-static bv_pixel pixel_border_hexa(const struct tile *ptile,
-                                  const struct player *pplayer,
-                                  bool knowledge)
+static bv_pixel pixel_border_hexa(const struct img *pimg,
+                                  const struct tile *ptile)
 {
   bv_pixel pixel;
   struct tile *pnext;
-  struct player *owner;
+  int owner;
 
   BV_CLR_ALL(pixel);
 
   fc_assert_ret_val(ptile != nullptr, pixel);
 
-  owner = mapimg.mapimg_tile_owner(ptile, pplayer, knowledge);
-  if (nullptr == owner) {
+  owner = img_tile(pimg, ptile)->owner;
+  if (owner < 0) {
     // no border
     return pixel;
   }
 
   pnext = mapstep(&(wld.map), ptile, DIR8_WEST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 0);
     BV_SET(pixel, 2);
     BV_SET(pixel, 6);
@@ -2871,8 +3151,8 @@ static bv_pixel pixel_border_hexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_NORTH);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 1);
     BV_SET(pixel, 5);
     BV_SET(pixel, 11);
@@ -2880,8 +3160,8 @@ static bv_pixel pixel_border_hexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_NORTHEAST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 11);
     BV_SET(pixel, 17);
     BV_SET(pixel, 23);
@@ -2890,8 +3170,8 @@ static bv_pixel pixel_border_hexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_EAST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 29);
     BV_SET(pixel, 33);
     BV_SET(pixel, 35);
@@ -2901,8 +3181,8 @@ static bv_pixel pixel_border_hexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_SOUTH);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 24);
     BV_SET(pixel, 30);
     BV_SET(pixel, 34);
@@ -2910,8 +3190,8 @@ static bv_pixel pixel_border_hexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_SOUTHWEST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 6);
     BV_SET(pixel, 12);
     BV_SET(pixel, 18);
@@ -2943,13 +3223,11 @@ static void base_coor_hexa(struct img *pimg, int *base_x, int *base_y, int x,
       26 27 28 29 30 31
          32 33 34 35
  */
-static bv_pixel pixel_tile_isohexa(const struct tile *ptile,
-                                   const struct player *pplayer,
-                                   bool knowledge)
+static bv_pixel pixel_tile_isohexa(const struct img *pimg,
+                                   const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_SET_ALL(pixel);
@@ -2965,13 +3243,11 @@ static bv_pixel pixel_tile_isohexa(const struct tile *ptile,
       -- 27 28 29 30 --
          -- -- -- --
  */
-static bv_pixel pixel_city_isohexa(const struct tile *ptile,
-                                   const struct player *pplayer,
-                                   bool knowledge)
+static bv_pixel pixel_city_isohexa(const struct img *pimg,
+                                   const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -3007,13 +3283,11 @@ static bv_pixel pixel_city_isohexa(const struct tile *ptile,
       -- -- -- -- -- --
          -- -- -- --
  */
-static bv_pixel pixel_unit_isohexa(const struct tile *ptile,
-                                   const struct player *pplayer,
-                                   bool knowledge)
+static bv_pixel pixel_unit_isohexa(const struct img *pimg,
+                                   const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
   bv_pixel pixel;
 
   BV_CLR_ALL(pixel);
@@ -3033,13 +3307,11 @@ static bv_pixel pixel_unit_isohexa(const struct tile *ptile,
       -- 27 28 -- -- 31
          -- -- 34 35
  */
-static bv_pixel pixel_fogofwar_isohexa(const struct tile *ptile,
-                                       const struct player *pplayer,
-                                       bool knowledge)
+static bv_pixel pixel_fogofwar_isohexa(const struct img *pimg,
+                                       const struct tile *ptile)
 {
   Q_UNUSED(ptile)
-  Q_UNUSED(pplayer)
-  Q_UNUSED(knowledge)
+  Q_UNUSED(pimg)
 
   bv_pixel pixel;
 
@@ -3079,28 +3351,27 @@ static bv_pixel pixel_fogofwar_isohexa(const struct tile *ptile,
 
                 [S]
  */
-static bv_pixel pixel_border_isohexa(const struct tile *ptile,
-                                     const struct player *pplayer,
-                                     bool knowledge)
+static bv_pixel pixel_border_isohexa(const struct img *pimg,
+                                     const struct tile *ptile)
 {
   bv_pixel pixel;
   struct tile *pnext;
-  struct player *owner;
+  int owner;
 
   BV_CLR_ALL(pixel);
 
   fc_assert_ret_val(ptile != nullptr, pixel);
 
-  owner = mapimg.mapimg_tile_owner(ptile, pplayer, knowledge);
-  if (nullptr == owner) {
+  owner = img_tile(pimg, ptile)->owner;
+  if (owner < 0) {
     // no border
     return pixel;
   }
 
   pnext = mapstep(&(wld.map), ptile, DIR8_NORTH);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 0);
     BV_SET(pixel, 1);
     BV_SET(pixel, 2);
@@ -3111,8 +3382,8 @@ static bv_pixel pixel_border_isohexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_EAST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 3);
     BV_SET(pixel, 9);
     BV_SET(pixel, 17);
@@ -3120,8 +3391,8 @@ static bv_pixel pixel_border_isohexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_SOUTHEAST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 25);
     BV_SET(pixel, 31);
     BV_SET(pixel, 35);
@@ -3129,8 +3400,8 @@ static bv_pixel pixel_border_isohexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_SOUTH);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 32);
     BV_SET(pixel, 33);
     BV_SET(pixel, 34);
@@ -3141,8 +3412,8 @@ static bv_pixel pixel_border_isohexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_WEST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 18);
     BV_SET(pixel, 26);
     BV_SET(pixel, 32);
@@ -3150,8 +3421,8 @@ static bv_pixel pixel_border_isohexa(const struct tile *ptile,
 
   pnext = mapstep(&(wld.map), ptile, DIR8_NORTHWEST);
   if (!pnext
-      || (mapimg.mapimg_tile_known(pnext, pplayer, knowledge) != TILE_UNKNOWN
-          && mapimg.mapimg_tile_owner(pnext, pplayer, knowledge) != owner)) {
+      || (img_tile(pimg, pnext)->known != TILE_UNKNOWN
+          && img_tile(pimg, pnext)->owner != owner)) {
     BV_SET(pixel, 0);
     BV_SET(pixel, 4);
     BV_SET(pixel, 10);
@@ -28,7 +28,9 @@ received a copy of the GNU General Public License along with Freeciv21.
     mapimg_show()       Show the map image definition.
     mapimg_id2str()     Convert the map image definition to a string. Usefull
                         to save the definitions.
-    mapimg_create()     ...
+    mapimg_create()     Take a snapshot of the game and save the map image
+                        on a worker thread.
+    mapimg_wait()       Wait for the map images created by mapimg_create().
     mapimg_colortest()  ...
 
     These functions return TRUE on success and FALSE on error. In the later
@@ -74,6 +76,14 @@ received a copy of the GNU General Public License along with Freeciv21.
 /* If you change this enum, the default values for the client have to be
  * adapted (see options.c). */
 
+/* The 'delta' toolkit appends the changes between the images of a map
+ * definition to one stream with a keyframe from time to time. The stream
+ * is turned back into images by freeciv21-mapframes. */
+#define MAPIMG_DELTA_MAGIC "FC21MAPDELTA"
+#define MAPIMG_DELTA_VERSION 1
+#define MAPIMG_DELTA_KEYFRAME 0
+#define MAPIMG_DELTA_FRAME 1
+
 typedef enum known_type (*mapimg_tile_known_func)(
     const struct tile *ptile, const struct player *pplayer, bool knowledge);
 typedef struct terrain *(*mapimg_tile_terrain_func)(
@@ -106,6 +116,7 @@ bool mapimg_show(int id, char *str, size_t str_len, bool detail);
 bool mapimg_id2str(int id, char *str, size_t str_len);
 bool mapimg_create(struct mapdef *pmapdef, bool force, const char *savename,
                    const char *path);
+bool mapimg_wait();
 bool mapimg_colortest(const char *savename, const char *path);
 
 struct mapdef *mapimg_isvalid(int id);
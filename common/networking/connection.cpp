@@ -243,6 +243,11 @@ bool connection_send_data(struct connection *pconn,
 
   pconn->statistics.bytes_send += len;
 
+  if (pconn->record != nullptr) {
+    pconn->record->append(reinterpret_cast<const char *>(data), len);
+    return true;
+  }
+
   if (0 < pconn->send_buffer->do_buffer_sends) {
     flush_connection_send_buffer_packets(pconn);
     if (!add_connection_data(pconn, data, len)) {
@@ -567,8 +572,10 @@ void connection_common_close(struct connection *pconn)
   if (!pconn->used) {
     qCritical("WARNING: Trying to close already closed connection");
   } else {
-    pconn->sock->deleteLater();
-    pconn->sock = nullptr;
+    if (pconn->sock != nullptr) {
+      pconn->sock->deleteLater();
+      pconn->sock = nullptr;
+    }
     pconn->used = false;
     pconn->established = false;
 
@@ -619,6 +626,26 @@ void conn_reset_delta_state(struct connection *pc)
   }
 }
 
+/**
+   Remove all the cached packets sent to the connection, or all the ones
+   received from it. The other end of the connection has to drop the
+   opposite direction at the same point of the packet stream.
+ */
+void conn_clear_delta_cache(struct connection *pc, bool sent)
+{
+  struct genhash **hashes = sent ? pc->phs.sent : pc->phs.received;
+  int i;
+
+  if (nullptr == hashes) {
+    return;
+  }
+  for (i = 0; i < PACKET_LAST; i++) {
+    if (nullptr != hashes[i]) {
+      genhash_clear(hashes[i]);
+    }
+  }
+}
+
 /**
    Freeze the connection. Then the packets sent to it won't be sent
    immediatly, but later, using a compression method. See futher details in
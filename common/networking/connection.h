@@ -85,6 +85,7 @@ enum auth_status {
   AS_FAILED,
   AS_REQUESTING_NEW_PASS,
   AS_REQUESTING_OLD_PASS,
+  AS_WAITING_DATABASE,
   AS_ESTABLISHED
 };
 
@@ -127,6 +128,10 @@ struct packet_header {
 struct connection {
   int id; /* used for server/client communication */
   QTcpSocket *sock = nullptr;
+  /* When set, the data sent to the connection is appended here instead of
+   * being written to sock. Used to serialize packets once and send them
+   * to many connections with send_recorded_packets(). */
+  QByteArray *record = nullptr;
   bool used;
   bool established; // have negotiated initial packets
   struct packet_header packet_header;
@@ -283,6 +288,7 @@ void connection_common_close(struct connection *pconn);
 void conn_set_capability(struct connection *pconn, const char *capability);
 void free_compression_queue(struct connection *pconn);
 void conn_reset_delta_state(struct connection *pconn);
+void conn_clear_delta_cache(struct connection *pconn, bool sent);
 
 void conn_compression_freeze(struct connection *pconn);
 bool conn_compression_thaw(struct connection *pconn);
@@ -563,6 +563,134 @@ void remove_packet_from_buffer(struct socket_packet_buffer *buffer)
             buffer->ndata);
 }
 
+/**
+   Send packets recorded earlier in their wire format, see the record
+   field of struct connection. The data queued for compression is sent
+   first to keep the packet stream in order; the recorded data itself is
+   not compressed again. Returns TRUE on success.
+ */
+bool send_recorded_packets(struct connection *pc, const QByteArray &data)
+{
+  int offset;
+
+  if (conn_compression_frozen(pc)
+      && byte_vector_size(&pc->compression.queue) > 0) {
+    if (!conn_compression_flush(pc)) {
+      return false;
+    }
+    byte_vector_reserve(&pc->compression.queue, 0);
+  }
+
+  // Small pieces, so that the send buffer never has to hold all of it.
+  for (offset = 0; offset < data.size(); offset += MAX_LEN_PACKET) {
+    if (!connection_send_data(
+            pc,
+            reinterpret_cast<const unsigned char *>(data.constData())
+                + offset,
+            MIN(MAX_LEN_PACKET, data.size() - offset))) {
+      return false;
+    }
+  }
+  return pc->used;
+}
+
+/**
+   Put packets recorded in their wire format in front of the data read
+   from the connection, so that they are the next packets handled.
+ */
+void inject_recorded_packets(struct connection *pc, const QByteArray &data)
+{
+  struct socket_packet_buffer *buffer = pc->buffer;
+
+  if (buffer->ndata + data.size() > buffer->nsize) {
+    buffer->nsize += data.size();
+    buffer->data = static_cast<unsigned char *>(
+        fc_realloc(buffer->data, buffer->nsize));
+  }
+  memmove(buffer->data + data.size(), buffer->data, buffer->ndata);
+  memcpy(buffer->data, data.constData(), data.size());
+  buffer->ndata += data.size();
+}
+
+/**
+   Check that packets recorded in their wire format can be read back with
+   the packet header of pc: every frame must fit the data, compressed
+   frames must uncompress, and every packet must be one that pc is sent.
+ */
+bool recorded_packets_check(const struct connection *pc,
+                            const QByteArray &data)
+{
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+  int header_len = data_type_size(data_type(pc->packet_header.length))
+                   + data_type_size(data_type(pc->packet_header.type));
+  int offset = 0;
+
+  while (offset < data.size()) {
+    struct data_in din;
+    int len_read, whole_packet_len, itype;
+    int header_size = 0;
+
+    dio_input_init(&din, bytes + offset, data.size() - offset);
+    if (!dio_get_type_raw(&din, data_type(pc->packet_header.length),
+                          &len_read)) {
+      return false;
+    }
+
+    whole_packet_len = len_read;
+    if (len_read == JUMBO_SIZE) {
+      header_size = 6;
+      if (!dio_get_uint32_raw(&din, &whole_packet_len)) {
+        return false;
+      }
+    } else if (len_read >= COMPRESSION_BORDER) {
+      header_size = 2;
+      whole_packet_len = len_read - COMPRESSION_BORDER;
+    }
+
+    if (whole_packet_len > data.size() - offset
+        || whole_packet_len < header_size) {
+      return false;
+    }
+
+    if (header_size > 0) {
+      uLong compressed_size = whole_packet_len - header_size;
+      uLongf decompressed_size = 80 * compressed_size + MAX_LEN_PACKET;
+      QByteArray decompressed;
+      int error;
+
+      do {
+        decompressed.resize(decompressed_size);
+        error = uncompress(
+            reinterpret_cast<Bytef *>(decompressed.data()),
+            &decompressed_size, bytes + offset + header_size,
+            compressed_size);
+        if (error == Z_BUF_ERROR) {
+          decompressed_size = 2 * decompressed.size();
+        }
+      } while (error == Z_BUF_ERROR
+               && decompressed.size() < MAX_DECOMPRESSION * data.size());
+      if (error != Z_OK) {
+        return false;
+      }
+      decompressed.resize(decompressed_size);
+      if (!recorded_packets_check(pc, decompressed)) {
+        return false;
+      }
+    } else {
+      if (whole_packet_len < header_len
+          || !dio_get_type_raw(&din, data_type(pc->packet_header.type),
+                               &itype)
+          || itype < 0 || itype >= PACKET_LAST
+          || pc->phs.handlers->send[itype].no_packet == nullptr) {
+        return false;
+      }
+    }
+    offset += whole_packet_len;
+  }
+
+  return true;
+}
+
 /**
    Set the packet header field lengths used for the login protocol,
    before the capability of the connection could be checked.
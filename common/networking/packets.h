@@ -48,6 +48,21 @@ struct data_in;
  */
 #define ATTRIBUTE_CHUNK_SIZE (1400)
 
+/* Tile snapshots are sent in one go on joining a game, so they use the
+ * largest chunks that fit in a packet.
+ *
+ * Used in network protocol.
+ */
+#define TILE_SNAPSHOT_CHUNK_SIZE (MAX_LEN_PACKET - 64)
+#define TILE_SNAPSHOT_VERSION 1
+
+/* Ruleset bundles are identified by the hex SHA-1 of their content.
+ *
+ * Used in network protocol.
+ */
+#define RULESET_BUNDLE_HASH_LEN (40 + 1)
+#define RULESET_BUNDLE_CHUNK_SIZE (MAX_LEN_PACKET - 128)
+
 // Used in network protocol.
 enum report_type {
   REPORT_WONDERS_OF_THE_WORLD,
@@ -91,6 +106,10 @@ void *get_packet_from_connection_raw(struct connection *pc,
   get_packet_from_connection_raw(pc, ptype)
 
 void remove_packet_from_buffer(struct socket_packet_buffer *buffer);
+bool send_recorded_packets(struct connection *pc, const QByteArray &data);
+void inject_recorded_packets(struct connection *pc, const QByteArray &data);
+bool recorded_packets_check(const struct connection *pc,
+                            const QByteArray &data);
 
 void send_attribute_block(const struct player *pplayer,
                           struct connection *pconn);
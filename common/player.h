@@ -310,6 +310,9 @@ struct player {
                             * (Previously 'capital'.) */
 
       struct player_tile *private_map;
+      /* Tiles with private_map[tile_index].seen_count[V_MAIN] != 0, kept
+       * as a bit plane alongside tile_known for bulk operations. */
+      QBitArray *tile_seen;
 
       // Player can see inside his borders.
       bool border_vision;
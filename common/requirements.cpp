@@ -1602,7 +1602,7 @@ static enum fc_tristate is_tech_in_range(const struct player *target_player,
 {
   if (survives) {
     fc_assert(range == REQ_RANGE_WORLD);
-    return BOOL_TO_TRISTATE(game.info.global_advances[tech]);
+    return BOOL_TO_TRISTATE(research_world_knows(tech));
   }
 
   // Not a 'surviving' requirement.
@@ -3315,7 +3315,7 @@ bool is_req_active(
     switch (req->range) {
     case REQ_RANGE_WORLD:
       // "None" does not count
-      eval = BOOL_TO_TRISTATE((game.info.global_advance_count - 1)
+      eval = BOOL_TO_TRISTATE((research_world_count() - 1)
                               >= req->source.value.min_techs);
       break;
     case REQ_RANGE_PLAYER:
@@ -16,6 +16,7 @@ _   ._       Copyright (c) 1996-2021 Freeciv21 and Freeciv contributors.
 #include "support.h"
 
 // common
+#include "city.h"
 #include "fc_types.h"
 #include "game.h"
 #include "name_translation.h"
@@ -44,6 +45,10 @@ static struct name_translation advance_unknown_name = NAME_INIT;
 Q_GLOBAL_STATIC(QVector<QString>, future_rule_name)
 Q_GLOBAL_STATIC(QVector<QString>, future_name_translation);
 
+// The speculation installed by the current thread, if any.
+static thread_local const struct research_speculation *speculation =
+    nullptr;
+
 /**
    Initializes all player research structure.
  */
@@ -368,136 +373,166 @@ static bool research_allowed(
   return false;
 }
 
+// Memoized results of research_get_reachable_rreqs().
+enum research_rreqs {
+  RREQS_UNCHECKED,
+  RREQS_CHECKING,
+  RREQS_REACHABLE,
+  RREQS_UNREACHABLE
+};
+
 /**
    Returns TRUE iff the given tech is ever reachable by the players sharing
    the research as far as research_reqs are concerned.
 
+   The results are kept in 'rreqs' so that each tech is checked only once
+   per research_update(). 'loop' is set when a requirement loop is found,
+   in which case a positive result isn't final and thus not kept.
+
    Helper for research_get_reachable().
  */
 static bool research_get_reachable_rreqs(const struct research *presearch,
-                                         Tech_type_id tech)
+                                         Tech_type_id tech,
+                                         enum research_rreqs *rreqs,
+                                         bool *loop)
 {
-  bv_techs done;
-  std::vector<Tech_type_id> techs{tech};
-  BV_CLR_ALL(done);
-  BV_SET(done, A_NONE);
-  BV_SET(done, tech);
-  /* Check that all recursive requirements have their research_reqs
-   * in order. */
-  while (!techs.empty()) { // Iterate till there is no-more techs to check
-    auto iter_tech = techs[techs.size() - 1]; // Last Element
-    techs.pop_back();                         // Remove Last element
-    if (presearch->inventions[iter_tech].state == TECH_KNOWN) {
-      /* This tech is already reached. What is required to research it and
-       * the techs it depends on is therefore irrelevant. */
-      continue;
-    }
+  bool reachable;
 
-    if (!research_allowed(presearch, iter_tech, reqs_may_activate)) {
-      /* It will always be illegal to start researching this tech because
-       * of unchanging requirements. Since it isn't already known and can't
-       * be researched it must be unreachable. */
-      return false;
-    }
+  switch (rreqs[tech]) {
+  case RREQS_UNCHECKED:
+    break;
+  case RREQS_CHECKING:
+    *loop = true;
+    return true;
+  case RREQS_REACHABLE:
+    return true;
+  case RREQS_UNREACHABLE:
+    return false;
+  }
 
-    // Check if required techs are research_reqs reachable.
-    for (int req = 0; req < AR_SIZE; req++) {
-      Tech_type_id req_tech = advance_required(iter_tech, tech_req(req));
+  if (presearch->inventions[tech].state == TECH_KNOWN) {
+    /* This tech is already reached. What is required to research it and
+     * the techs it depends on is therefore irrelevant. */
+    rreqs[tech] = RREQS_REACHABLE;
+    return true;
+  }
 
-      if (valid_advance_by_number(req_tech) == nullptr) {
-        return false;
-      } else if (!BV_ISSET(done, req_tech)) {
-        techs.push_back(req_tech);
-        BV_SET(done, req_tech);
-      }
+  /* If it will always be illegal to start researching this tech because
+   * of unchanging requirements, then since it isn't already known and
+   * can't be researched it must be unreachable. */
+  reachable = research_allowed(presearch, tech, reqs_may_activate);
+
+  // Check if required techs are research_reqs reachable.
+  rreqs[tech] = RREQS_CHECKING;
+  for (int req = 0; reachable && req < AR_SIZE; req++) {
+    Tech_type_id req_tech = advance_required(tech, tech_req(req));
+
+    if (valid_advance_by_number(req_tech) == nullptr) {
+      reachable = false;
+    } else if (req_tech != A_NONE && req_tech != tech) {
+      reachable =
+          research_get_reachable_rreqs(presearch, req_tech, rreqs, loop);
     }
   }
 
-  return true;
+  if (!reachable) {
+    rreqs[tech] = RREQS_UNREACHABLE;
+  } else if (*loop) {
+    rreqs[tech] = RREQS_UNCHECKED;
+  } else {
+    rreqs[tech] = RREQS_REACHABLE;
+  }
+
+  return reachable;
 }
 
 /**
    Returns TRUE iff the given tech is ever reachable by the players sharing
-   the research by checking tech tree limitations.
+   the research by checking tech tree limitations. 'unknown' holds the
+   techs the research doesn't know.
 
    Helper for research_update().
  */
 static bool research_get_reachable(const struct research *presearch,
-                                   Tech_type_id tech)
+                                   Tech_type_id tech,
+                                   const bv_techs *unknown,
+                                   enum research_rreqs *rreqs)
 {
-  if (valid_advance_by_number(tech) == nullptr) {
+  const struct advance *padvance = valid_advance_by_number(tech);
+  bool loop = false;
+
+  if (padvance == nullptr || !padvance->roots_valid) {
+    return false;
+  }
+
+  /* A tech which requires itself can only be reached by special means
+   * (init_techs, lua script, ...). If you already know it, you can
+   * "reach" it; if not, not. (This case is needed for descendants of this
+   * tech.) */
+  if (BV_CHECK_MASK(padvance->self_root_reqs, *unknown)) {
     return false;
-  } else {
-    advance_root_req_iterate(advance_by_number(tech), proot)
-    {
-      if (advance_requires(proot, AR_ROOT) == proot) {
-        /* This tech requires itself; it can only be reached by special
-         * means (init_techs, lua script, ...).
-         * If you already know it, you can "reach" it; if not, not. (This
-         * case is needed for descendants of this tech.) */
-        if (presearch->inventions[advance_number(proot)].state
-            != TECH_KNOWN) {
-          return false;
-        }
-      } else {
-        for (int req = 0; req < AR_SIZE; req++) {
-          if (valid_advance(advance_requires(proot, tech_req(req)))
-              == nullptr) {
-            return false;
-          }
-        }
-      }
-    }
-    advance_root_req_iterate_end;
   }
 
   // Check research reqs reachability.
-  return research_get_reachable_rreqs(presearch, tech);
+  return research_get_reachable_rreqs(presearch, tech, rreqs, &loop);
 }
 
 /**
    Returns TRUE iff the players sharing 'presearch' already have got the
    knowledge of all root requirement technologies for 'tech' (without which
-   it's impossible to gain 'tech').
+   it's impossible to gain 'tech'). 'unknown' holds the techs the research
+   doesn't know.
 
    Helper for research_update().
  */
-static bool research_get_root_reqs_known(const struct research *presearch,
-                                         Tech_type_id tech)
+static bool research_get_root_reqs_known(Tech_type_id tech,
+                                         const bv_techs *unknown)
 {
-  advance_root_req_iterate(advance_by_number(tech), proot)
-  {
-    if (presearch->inventions[advance_number(proot)].state != TECH_KNOWN) {
-      return false;
-    }
-  }
-  advance_root_req_iterate_end;
-
-  return true;
+  return !BV_CHECK_MASK(advance_by_number(tech)->root_reqs, *unknown);
 }
 
 /**
    Mark as TECH_PREREQS_KNOWN each tech which is available, not known and
    which has all requirements fullfiled.
 
+   The tech tree walks are precalculated as bit vectors by
+   techs_precalc_closures(), so this only needs the set of known techs.
+
    Recalculate presearch->num_known_tech_with_flag
    Should always be called after research_invention_set().
  */
 void research_update(struct research *presearch)
 {
+  enum research_rreqs rreqs[A_LAST];
+  int bulbs[A_LAST];
+  bv_techs known, unknown;
   int techs_researched;
 
+  BV_CLR_ALL(known);
+  BV_CLR_ALL(unknown);
+  advance_index_iterate(A_NONE, i)
+  {
+    rreqs[i] = RREQS_UNCHECKED;
+    bulbs[i] = -1;
+    if (presearch->inventions[i].state == TECH_KNOWN) {
+      BV_SET(known, i);
+    } else {
+      BV_SET(unknown, i);
+    }
+  }
+  advance_index_iterate_end;
+
   advance_index_iterate(A_FIRST, i)
   {
     enum tech_state state = presearch->inventions[i].state;
     bool root_reqs_known = true;
-    bool reachable = research_get_reachable(presearch, i);
+    bool reachable = research_get_reachable(presearch, i, &unknown, rreqs);
 
     /* Finding if the root reqs of an unreachable tech isn't redundant.
      * A tech can be unreachable via research but have known root reqs
      * because of unfilfilled research_reqs. Unfulfilled research_reqs
      * doesn't prevent the player from aquiring the tech by other means. */
-    root_reqs_known = research_get_root_reqs_known(presearch, i);
+    root_reqs_known = research_get_root_reqs_known(i, &unknown);
 
     if (reachable) {
       if (state != TECH_KNOWN) {
@@ -530,6 +565,28 @@ void research_update(struct research *presearch)
       continue;
     }
 
+    if (game.info.tech_cost_style != TECH_COST_CIV1CIV2) {
+      /* The cost of a tech doesn't depend on the order the techs are
+       * researched in, so each one is calculated only once. */
+      presearch->inventions[i].required_techs =
+          advance_by_number(i)->closure;
+      BV_CLR_ALL_FROM(presearch->inventions[i].required_techs, known);
+
+      advance_index_iterate(A_FIRST, j)
+      {
+        if (!BV_ISSET(presearch->inventions[i].required_techs, j)) {
+          continue;
+        }
+        if (bulbs[j] < 0) {
+          bulbs[j] = research_total_bulbs_required(presearch, j, false);
+        }
+        presearch->inventions[i].num_required_techs++;
+        presearch->inventions[i].bulbs_required += bulbs[j];
+      }
+      advance_index_iterate_end;
+      continue;
+    }
+
     techs_researched = presearch->techs_researched;
     advance_req_iterate(valid_advance_by_number(i), preq)
     {
@@ -612,7 +669,10 @@ enum tech_state research_invention_state(const struct research *presearch,
   fc_assert_ret_val(nullptr != valid_advance_by_number(tech),
                     tech_state(-1));
 
-  if (nullptr != presearch) {
+  if (nullptr != speculation && tech == speculation->tech
+      && (nullptr == presearch || presearch == speculation->presearch)) {
+    return TECH_KNOWN;
+  } else if (nullptr != presearch) {
     return presearch->inventions[tech].state;
   } else if (game.info.global_advances[tech]) {
     return TECH_KNOWN;
@@ -638,6 +698,7 @@ enum tech_state research_invention_set(struct research *presearch,
     return old;
   }
   presearch->inventions[tech].state = value;
+  city_refresh_invalidate_effects();
 
   if (value == TECH_KNOWN) {
     if (!game.info.global_advances[tech]) {
@@ -649,6 +710,56 @@ enum tech_state research_invention_set(struct research *presearch,
   return old;
 }
 
+/**
+   Starts speculating in the current thread that 'presearch' knows 'tech'.
+   'pspec' must stay alive until research_speculation_end() is called.
+   Speculations don't nest.
+ */
+void research_speculation_begin(struct research_speculation *pspec,
+                                const struct research *presearch,
+                                Tech_type_id tech)
+{
+  fc_assert_ret(nullptr == speculation);
+
+  pspec->presearch = presearch;
+  pspec->tech = tech;
+  speculation = pspec;
+}
+
+/**
+   Stops speculating; the research is seen as it is again.
+ */
+void research_speculation_end(struct research_speculation *pspec)
+{
+  fc_assert_ret(speculation == pspec);
+
+  speculation = nullptr;
+}
+
+/**
+   Returns whether anybody in the world knows the tech, including a tech
+   the current thread speculates about.
+ */
+bool research_world_knows(Tech_type_id tech)
+{
+  return game.info.global_advances[tech]
+         || (nullptr != speculation && tech == speculation->tech);
+}
+
+/**
+   Returns the number of techs known in the world, as
+   game.info.global_advance_count, including a tech the current thread
+   speculates about.
+ */
+int research_world_count()
+{
+  if (nullptr != speculation
+      && !game.info.global_advances[speculation->tech]) {
+    return game.info.global_advance_count + 1;
+  }
+  return game.info.global_advance_count;
+}
+
 /**
    Returns TRUE iff the given tech is ever reachable via research by the
    players sharing the research by checking tech tree limitations.
@@ -127,6 +127,23 @@ bool research_invention_reachable(const struct research *presearch,
 bool research_invention_gettable(const struct research *presearch,
                                  const Tech_type_id tech, bool allow_holes);
 
+/* A hypothetically known tech. While a speculation is installed with
+ * research_speculation_begin(), research_invention_state() and the world
+ * range tech requirements answer as if the tech had been invented, but
+ * nothing in the game state changes. The speculation only applies to the
+ * thread that installed it. */
+struct research_speculation {
+  const struct research *presearch;
+  Tech_type_id tech;
+};
+
+void research_speculation_begin(struct research_speculation *pspec,
+                                const struct research *presearch,
+                                Tech_type_id tech);
+void research_speculation_end(struct research_speculation *pspec);
+bool research_world_knows(Tech_type_id tech);
+int research_world_count();
+
 Tech_type_id research_goal_step(const struct research *presearch,
                                 Tech_type_id goal);
 int research_goal_unknown_techs(const struct research *presearch,
@@ -622,6 +622,9 @@ int luascript_do_string(struct fc_lua *fcl, const char *str,
   fc_assert_ret_val(fcl, 0);
   fc_assert_ret_val(fcl->state, 0);
 
+  // The code may redefine callback functions.
+  luascript_signal_refs_invalidate(fcl);
+
   status = luaL_loadbuffer(fcl->state, str, qstrlen(str), name);
   if (status) {
     luascript_report(fcl, status, str);
@@ -641,6 +644,9 @@ int luascript_do_file(struct fc_lua *fcl, const char *filename)
   fc_assert_ret_val(fcl, 0);
   fc_assert_ret_val(fcl->state, 0);
 
+  // The code may redefine callback functions.
+  luascript_signal_refs_invalidate(fcl);
+
   status = luaL_loadfile(fcl->state, filename);
   if (status) {
     luascript_report(fcl, status, nullptr);
@@ -650,6 +656,35 @@ int luascript_do_file(struct fc_lua *fcl, const char *filename)
   return status;
 }
 
+/**
+   Call the callback function on top of the stack with the given arguments.
+   Returns whether the signal emission shall be stopped.
+ */
+static bool luascript_callback_call(struct fc_lua *fcl,
+                                    const char *callback_name, int nargs,
+                                    enum api_types *parg_types,
+                                    va_list args)
+{
+  bool stop_emission = false;
+
+  luascript_log(fcl, LOG_DEBUG, "lua callback: '%s'", callback_name);
+
+  luascript_push_args(fcl, nargs, parg_types, args);
+
+  // Call the function with nargs arguments, return 1 results
+  if (luascript_call(fcl, nargs, 1, nullptr)) {
+    return false;
+  }
+
+  // Shall we stop the emission of this signal?
+  if (lua_isboolean(fcl->state, -1)) {
+    stop_emission = lua_toboolean(fcl->state, -1);
+  }
+  lua_pop(fcl->state, 1); // pop return value
+
+  return stop_emission;
+}
+
 /**
    Invoke the 'callback_name' Lua function.
  */
@@ -657,8 +692,6 @@ bool luascript_callback_invoke(struct fc_lua *fcl, const char *callback_name,
                                int nargs, enum api_types *parg_types,
                                va_list args)
 {
-  bool stop_emission = false;
-
   fc_assert_ret_val(fcl, false);
   fc_assert_ret_val(fcl->state, false);
 
@@ -672,22 +705,42 @@ bool luascript_callback_invoke(struct fc_lua *fcl, const char *callback_name,
     return false;
   }
 
-  luascript_log(fcl, LOG_DEBUG, "lua callback: '%s'", callback_name);
+  return luascript_callback_call(fcl, callback_name, nargs, parg_types,
+                                 args);
+}
 
-  luascript_push_args(fcl, nargs, parg_types, args);
+/**
+   Invoke the 'callback_name' Lua function through the registry reference
+   cached in *pref. The global is only resolved by name when no reference
+   is cached yet (*pref is LUA_NOREF).
+ */
+bool luascript_callback_ref_invoke(struct fc_lua *fcl,
+                                   const char *callback_name, int *pref,
+                                   int nargs, enum api_types *parg_types,
+                                   va_list args)
+{
+  fc_assert_ret_val(fcl, false);
+  fc_assert_ret_val(fcl->state, false);
+  fc_assert_ret_val(pref, false);
 
-  // Call the function with nargs arguments, return 1 results
-  if (luascript_call(fcl, nargs, 1, nullptr)) {
-    return false;
-  }
+  if (*pref == LUA_NOREF) {
+    lua_getglobal(fcl->state, callback_name);
 
-  // Shall we stop the emission of this signal?
-  if (lua_isboolean(fcl->state, -1)) {
-    stop_emission = lua_toboolean(fcl->state, -1);
+    if (!lua_isfunction(fcl->state, -1)) {
+      luascript_log(fcl, LOG_ERROR, "lua error: Unknown callback '%s'",
+                    callback_name);
+      lua_pop(fcl->state, 1);
+      return false;
+    }
+
+    // Pops the function
+    *pref = luaL_ref(fcl->state, LUA_REGISTRYINDEX);
   }
-  lua_pop(fcl->state, 1); // pop return value
 
-  return stop_emission;
+  lua_rawgeti(fcl->state, LUA_REGISTRYINDEX, *pref);
+
+  return luascript_callback_call(fcl, callback_name, nargs, parg_types,
+                                 args);
 }
 
 /**
@@ -45,6 +45,12 @@ struct fc_lua {
 
   QHash<QString, struct signal *> *signals_hash;
   QVector<QString> *signal_names;
+  // Signals indexed by id (creation order), parallel to signal_names.
+  QVector<struct signal *> *signals_by_id;
+
+  // Callback profiling, see luascript_profile_enable().
+  bool profiling;
+  qint64 budget_nsec; // per callback and turn, 0 for none
 };
 
 // Error functions for lua scripts.
@@ -84,6 +90,10 @@ int luascript_do_file(struct fc_lua *fcl, const char *filename);
 bool luascript_callback_invoke(struct fc_lua *fcl, const char *callback_name,
                                int nargs, enum api_types *parg_types,
                                va_list args);
+bool luascript_callback_ref_invoke(struct fc_lua *fcl,
+                                   const char *callback_name, int *pref,
+                                   int nargs, enum api_types *parg_types,
+                                   va_list args);
 
 void luascript_remove_exported_object(struct fc_lua *fcl, void *object);
 
@@ -32,7 +32,20 @@
     return false
 
   If the value is 'true' the current signal emission will be stopped.
+
+  Every signal also gets an integer id, which is its creation index. Callers
+  that know the id (see script_server_signal_emit()) skip the name lookup,
+  and can test for connected callbacks before doing any work. Callbacks
+  keep a registry reference to their Lua function, resolved on first use
+  and dropped whenever new code is loaded into the state.
+
+  When profiling is enabled, the number of calls and the time spent are
+  recorded for each signal and callback. A per-turn time budget can be set
+  for callbacks; a warning is logged the first time a callback exceeds it
+  during a turn.
  */
+#include <QElapsedTimer>
+
 // utility
 #include "deprecations.h"
 
@@ -43,26 +56,32 @@
 #include "luascript_signal.h"
 
 static struct signal_callback *signal_callback_new(const char *name);
-static void signal_callback_destroy(struct signal_callback *pcallback);
+static void signal_callback_destroy(struct fc_lua *fcl,
+                                    struct signal_callback *pcallback);
 static struct signal *signal_new(int nargs, enum api_types *parg_types);
-static void signal_destroy(struct signal *psignal);
+static void signal_destroy(struct fc_lua *fcl, struct signal *psignal);
 
 /**
    Create a new signal callback.
  */
 static struct signal_callback *signal_callback_new(const char *name)
 {
-  auto *pcallback = new signal_callback;
+  auto *pcallback = new signal_callback();
 
   pcallback->name = fc_strdup(name);
+  pcallback->ref = LUA_NOREF;
   return pcallback;
 }
 
 /**
    Free a signal callback.
  */
-static void signal_callback_destroy(struct signal_callback *pcallback)
+static void signal_callback_destroy(struct fc_lua *fcl,
+                                    struct signal_callback *pcallback)
 {
+  if (fcl->state != nullptr) {
+    luaL_unref(fcl->state, LUA_REGISTRYINDEX, pcallback->ref);
+  }
   delete[] pcallback->name;
   delete pcallback;
 }
@@ -72,7 +91,7 @@ static void signal_callback_destroy(struct signal_callback *pcallback)
  */
 static struct signal *signal_new(int nargs, enum api_types *parg_types)
 {
-  auto *psignal = new struct signal;
+  auto *psignal = new struct signal();
 
   psignal->nargs = nargs;
   psignal->arg_types = parg_types;
@@ -85,18 +104,84 @@ static struct signal *signal_new(int nargs, enum api_types *parg_types)
 /**
    Free a signal.
  */
-static void signal_destroy(struct signal *psignal)
+static void signal_destroy(struct fc_lua *fcl, struct signal *psignal)
 {
   delete[] psignal->arg_types;
   delete[] psignal->depr_msg;
   while (!psignal->callbacks->isEmpty()) {
-    signal_callback_destroy(psignal->callbacks->takeFirst());
+    signal_callback_destroy(fcl, psignal->callbacks->takeFirst());
   }
 
   delete psignal->callbacks;
   delete psignal;
 }
 
+/**
+   Account an invocation that took nsec nanoseconds.
+ */
+static void profile_add(struct luascript_profile *profile, qint64 nsec)
+{
+  profile->calls++;
+  profile->nsec += nsec;
+  profile->turn_nsec += nsec;
+  profile->max_nsec = MAX(profile->max_nsec, nsec);
+}
+
+/**
+   Invoke all the callback functions attached to a given signal.
+ */
+static void signal_emit_valist(struct fc_lua *fcl, struct signal *psignal,
+                               va_list args)
+{
+  /* Iterate over a copy: a callback may disconnect itself (or others)
+   * while the signal is being emitted. */
+  const auto callbacks = *psignal->callbacks;
+  bool timed = fcl->profiling || fcl->budget_nsec > 0;
+  QElapsedTimer timer;
+  qint64 signal_nsec = 0;
+
+  for (auto *pcallback : callbacks) {
+    va_list args_cb;
+    bool stop;
+
+    if (timed) {
+      timer.start();
+    }
+
+    va_copy(args_cb, args);
+    stop = luascript_callback_ref_invoke(fcl, pcallback->name,
+                                         &pcallback->ref, psignal->nargs,
+                                         psignal->arg_types, args_cb);
+    va_end(args_cb);
+
+    if (timed) {
+      qint64 nsec = timer.nsecsElapsed();
+
+      signal_nsec += nsec;
+      profile_add(&pcallback->profile, nsec);
+
+      if (fcl->budget_nsec > 0 && !pcallback->over_budget
+          && pcallback->profile.turn_nsec > fcl->budget_nsec) {
+        pcallback->over_budget = true;
+        luascript_log(fcl, LOG_WARN,
+                      "Callback '%s' used %.1f ms this turn, over its "
+                      "budget of %.1f ms.",
+                      pcallback->name,
+                      pcallback->profile.turn_nsec / 1.0e6,
+                      fcl->budget_nsec / 1.0e6);
+      }
+    }
+
+    if (stop) {
+      break;
+    }
+  }
+
+  if (timed) {
+    profile_add(&psignal->profile, signal_nsec);
+  }
+}
+
 /**
    Invoke all the callback functions attached to a given signal.
  */
@@ -110,16 +195,8 @@ void luascript_signal_emit_valist(struct fc_lua *fcl,
 
   psignal = fcl->signals_hash->value(signal_name, nullptr);
   if (psignal) {
-    for (auto *pcallback : qAsConst(*psignal->callbacks)) {
-      va_list args_cb;
-
-      va_copy(args_cb, args);
-      if (luascript_callback_invoke(fcl, pcallback->name, psignal->nargs,
-                                    psignal->arg_types, args_cb)) {
-        va_end(args_cb);
-        break;
-      }
-      va_end(args_cb);
+    if (!psignal->callbacks->isEmpty()) {
+      signal_emit_valist(fcl, psignal, args);
     }
   } else {
     luascript_log(fcl, LOG_ERROR,
@@ -129,6 +206,70 @@ void luascript_signal_emit_valist(struct fc_lua *fcl,
   }
 }
 
+/**
+   Invoke all the callback functions attached to the signal with the given
+   id.
+ */
+void luascript_signal_emit_by_id_valist(struct fc_lua *fcl, int signal_id,
+                                        va_list args)
+{
+  struct signal *psignal;
+
+  fc_assert_ret(fcl);
+  fc_assert_ret(fcl->signals_by_id);
+  fc_assert_ret(signal_id >= 0 && signal_id < fcl->signals_by_id->size());
+
+  psignal = fcl->signals_by_id->at(signal_id);
+  if (!psignal->callbacks->isEmpty()) {
+    signal_emit_valist(fcl, psignal, args);
+  }
+}
+
+/**
+   Returns whether any callback is connected to the signal with the given
+   id. Emitters can use this to skip preparing the signal arguments.
+ */
+bool luascript_signal_has_callbacks(struct fc_lua *fcl, int signal_id)
+{
+  fc_assert_ret_val(fcl, false);
+  fc_assert_ret_val(fcl->signals_by_id, false);
+  fc_assert_ret_val(
+      signal_id >= 0 && signal_id < fcl->signals_by_id->size(), false);
+
+  return !fcl->signals_by_id->at(signal_id)->callbacks->isEmpty();
+}
+
+/**
+   Return the id of the signal with the given name, or -1 if there is no
+   such signal.
+ */
+int luascript_signal_id(struct fc_lua *fcl, const char *signal_name)
+{
+  fc_assert_ret_val(fcl, -1);
+  fc_assert_ret_val(fcl->signal_names, -1);
+
+  return fcl->signal_names->indexOf(QString(signal_name));
+}
+
+/**
+   Drop the cached function references of all callbacks. They are resolved
+   again by name on the next emission. Must be called whenever the callback
+   functions may have been redefined.
+ */
+void luascript_signal_refs_invalidate(struct fc_lua *fcl)
+{
+  if (!fcl || !fcl->signals_by_id || !fcl->state) {
+    return;
+  }
+
+  for (auto *psignal : qAsConst(*fcl->signals_by_id)) {
+    for (auto *pcallback : qAsConst(*psignal->callbacks)) {
+      luaL_unref(fcl->state, LUA_REGISTRYINDEX, pcallback->ref);
+      pcallback->ref = LUA_NOREF;
+    }
+  }
+}
+
 /**
    Invoke all the callback functions attached to a given signal.
  */
@@ -170,6 +311,7 @@ static struct signal *luascript_signal_create_valist(struct fc_lua *fcl,
     created = signal_new(nargs, parg_types);
     fcl->signals_hash->insert(signal_name, created);
     fcl->signal_names->append(sn);
+    fcl->signals_by_id->append(created);
 
     return created;
   }
@@ -262,6 +404,8 @@ void luascript_signal_callback(struct fc_lua *fcl, const char *signal_name,
     } else {
       if (pcallback_found) {
         psignal->callbacks->removeAll(pcallback_found);
+        luaL_unref(fcl->state, LUA_REGISTRYINDEX, pcallback_found->ref);
+        pcallback_found->ref = LUA_NOREF;
       }
     }
   } else {
@@ -305,6 +449,7 @@ void luascript_signal_init(struct fc_lua *fcl)
   if (nullptr == fcl->signals_hash) {
     fcl->signals_hash = new QHash<QString, struct signal *>;
     fcl->signal_names = new QVector<QString>;
+    fcl->signals_by_id = new QVector<struct signal *>;
   }
 }
 
@@ -317,12 +462,14 @@ void luascript_signal_free(struct fc_lua *fcl)
     return;
   }
   for (auto *nissan : qAsConst(*fcl->signals_hash)) {
-    signal_destroy(nissan);
+    signal_destroy(fcl, nissan);
   }
   delete fcl->signals_hash;
   delete fcl->signal_names;
+  delete fcl->signals_by_id;
   fcl->signals_hash = nullptr;
   fcl->signal_names = nullptr;
+  fcl->signals_by_id = nullptr;
 }
 
 /**
@@ -359,3 +506,65 @@ const char *luascript_signal_callback_by_index(struct fc_lua *fcl,
   }
   return nullptr;
 }
+
+/**
+   Enable or disable callback profiling.
+ */
+void luascript_profile_enable(struct fc_lua *fcl, bool enable)
+{
+  fc_assert_ret(fcl != nullptr);
+
+  fcl->profiling = enable;
+}
+
+/**
+   Set the time each callback may use per turn before a warning is logged.
+   Use 0 to disable the budget.
+ */
+void luascript_profile_set_budget(struct fc_lua *fcl, int msec)
+{
+  fc_assert_ret(fcl != nullptr);
+  fc_assert_ret(msec >= 0);
+
+  fcl->budget_nsec = static_cast<qint64>(msec) * 1000000;
+}
+
+/**
+   Clear all profiling data.
+ */
+void luascript_profile_reset(struct fc_lua *fcl)
+{
+  fc_assert_ret(fcl != nullptr);
+
+  if (fcl->signals_by_id == nullptr) {
+    return;
+  }
+
+  for (auto *psignal : qAsConst(*fcl->signals_by_id)) {
+    psignal->profile = luascript_profile();
+    for (auto *pcallback : qAsConst(*psignal->callbacks)) {
+      pcallback->profile = luascript_profile();
+      pcallback->over_budget = false;
+    }
+  }
+}
+
+/**
+   Start accounting a new turn for the callback budgets.
+ */
+void luascript_profile_turn_reset(struct fc_lua *fcl)
+{
+  fc_assert_ret(fcl != nullptr);
+
+  if (fcl->signals_by_id == nullptr) {
+    return;
+  }
+
+  for (auto *psignal : qAsConst(*fcl->signals_by_id)) {
+    psignal->profile.turn_nsec = 0;
+    for (auto *pcallback : qAsConst(*psignal->callbacks)) {
+      pcallback->profile.turn_nsec = 0;
+      pcallback->over_budget = false;
+    }
+  }
+}
@@ -16,9 +16,20 @@ struct fc_lua;
 
 typedef char *signal_deprecator;
 
+// Profiling data of a signal or a callback.
+struct luascript_profile {
+  int calls;        // number of invocations
+  qint64 nsec;      // total time spent
+  qint64 max_nsec;  // longest single invocation
+  qint64 turn_nsec; // time spent since the last turn reset
+};
+
 // Signal callback datastructure.
 struct signal_callback {
   char *name; // callback function name
+  int ref;    // cached registry reference to the function, or LUA_NOREF
+  struct luascript_profile profile;
+  bool over_budget; // already reported over budget this turn
 };
 
 // Signal datastructure.
@@ -27,6 +38,7 @@ struct signal {
   enum api_types *arg_types;           // argument types
   QList<signal_callback *> *callbacks; // connected callbacks
   char *depr_msg; // deprecation message to show if handler added
+  struct luascript_profile profile;
 };
 
 void luascript_signal_init(struct fc_lua *fcl);
@@ -35,6 +47,16 @@ void luascript_signal_free(struct fc_lua *fcl);
 void luascript_signal_emit_valist(struct fc_lua *fcl,
                                   const char *signal_name, va_list args);
 void luascript_signal_emit(struct fc_lua *fcl, const char *signal_name, ...);
+void luascript_signal_emit_by_id_valist(struct fc_lua *fcl, int signal_id,
+                                        va_list args);
+bool luascript_signal_has_callbacks(struct fc_lua *fcl, int signal_id);
+int luascript_signal_id(struct fc_lua *fcl, const char *signal_name);
+void luascript_signal_refs_invalidate(struct fc_lua *fcl);
+
+void luascript_profile_enable(struct fc_lua *fcl, bool enable);
+void luascript_profile_set_budget(struct fc_lua *fcl, int msec);
+void luascript_profile_reset(struct fc_lua *fcl);
+void luascript_profile_turn_reset(struct fc_lua *fcl);
 signal_deprecator *luascript_signal_create(struct fc_lua *fcl,
                                            const char *signal_name,
                                            int nargs, ...);
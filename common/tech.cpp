@@ -262,6 +262,48 @@ void techs_precalc_data()
   advance_iterate_end;
 }
 
+/**
+   Precalculate the requirement closures of all the technologies (see
+   struct advance). Must be called once the whole tech tree is known.
+ */
+void techs_precalc_closures()
+{
+  advance_iterate(A_NONE, padvance)
+  {
+    BV_CLR_ALL(padvance->closure);
+    BV_CLR_ALL(padvance->root_reqs);
+    BV_CLR_ALL(padvance->self_root_reqs);
+    padvance->roots_valid = true;
+
+    if (A_NONE == advance_number(padvance)) {
+      continue;
+    }
+
+    advance_req_iterate(padvance, preq)
+    {
+      BV_SET(padvance->closure, advance_number(preq));
+    }
+    advance_req_iterate_end;
+
+    advance_root_req_iterate(padvance, proot)
+    {
+      BV_SET(padvance->root_reqs, advance_number(proot));
+      if (advance_requires(proot, AR_ROOT) == proot) {
+        BV_SET(padvance->self_root_reqs, advance_number(proot));
+        continue;
+      }
+      for (int req = 0; req < AR_SIZE; req++) {
+        if (valid_advance(advance_requires(proot, tech_req(req)))
+            == nullptr) {
+          padvance->roots_valid = false;
+        }
+      }
+    }
+    advance_root_req_iterate_end;
+  }
+  advance_iterate_end;
+}
+
 /**
    Is the given tech a future tech.
  */
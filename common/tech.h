@@ -103,6 +103,8 @@ typedef int Tech_type_id;
 
 enum tech_req { AR_ONE = 0, AR_TWO = 1, AR_ROOT = 2, AR_SIZE };
 
+BV_DEFINE(bv_techs, A_LAST);
+
 struct tech_class {
   int idx;
   struct name_translation name;
@@ -142,9 +144,18 @@ struct advance {
    * itself. Precalculated at server then send to client.
    */
   int num_reqs;
-};
 
-BV_DEFINE(bv_techs, A_LAST);
+  /* Precalculated by techs_precalc_closures(), on both server and client.
+   * 'closure' holds the techs advance_req_iterate() visits, 'root_reqs'
+   * the ones advance_root_req_iterate() visits and 'self_root_reqs' those
+   * root requirements that are their own root requirement.
+   * 'roots_valid' is FALSE when the requirements of any other root
+   * requirement lead to a removed tech. */
+  bv_techs closure;
+  bv_techs root_reqs;
+  bv_techs self_root_reqs;
+  bool roots_valid;
+};
 
 /* General advance/technology accessor functions. */
 Tech_type_id advance_count();
@@ -213,6 +224,7 @@ void techs_init();
 void techs_free();
 
 void techs_precalc_data();
+void techs_precalc_closures();
 
 // Iteration
 
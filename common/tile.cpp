@@ -17,6 +17,7 @@
 #include "support.h"
 
 // common
+#include "city.h"
 #include "fc_interface.h"
 #include "game.h"
 #include "map.h"
@@ -61,6 +62,9 @@ void tile_set_owner(struct tile *ptile, struct player *pplayer,
   if (BORDERS_DISABLED != game.info.borders
       // City tiles are always owned by the city owner.
       || (tile_city(ptile) != nullptr || ptile->owner != nullptr)) {
+    if (ptile->owner != pplayer) {
+      city_refresh_invalidate_tile(ptile);
+    }
     ptile->owner = pplayer;
     ptile->claimer = claimer;
   }
@@ -132,6 +136,9 @@ void tile_set_terrain(struct tile *ptile, struct terrain *pterrain)
       TILE_XY(ptile), terrain_rule_name(pterrain), terrain_number(pterrain),
       city_name_get(tile_city(ptile)), tile_city(ptile)->id);
 
+  if (ptile->terrain != pterrain) {
+    city_refresh_invalidate_tile(ptile);
+  }
   ptile->terrain = pterrain;
   if (ptile->resource != nullptr) {
     if (nullptr != pterrain
@@ -973,8 +980,9 @@ bool tile_has_visible_extra(const struct tile *ptile,
  */
 void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 {
-  if (pextra != nullptr) {
+  if (pextra != nullptr && !BV_ISSET(ptile->extras, extra_index(pextra))) {
     BV_SET(ptile->extras, extra_index(pextra));
+    city_refresh_invalidate_tile(ptile);
   }
 }
 
@@ -983,8 +991,9 @@ void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
  */
 void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra)
 {
-  if (pextra != nullptr) {
+  if (pextra != nullptr && BV_ISSET(ptile->extras, extra_index(pextra))) {
     BV_CLR(ptile->extras, extra_index(pextra));
+    city_refresh_invalidate_tile(ptile);
   }
 }
 
@@ -13,12 +13,14 @@
 #pragma once
 
 #include <QHash>
+#include <QVector>
 
 // common
 #include "map_types.h"
 
 struct world {
   struct civ_map map;
-  QHash<int, const struct city *> *cities;
-  QHash<int, const struct unit *> *units;
+  // Indexed by id, see idex.cpp
+  QVector<const struct city *> *cities;
+  QVector<const struct unit *> *units;
 };
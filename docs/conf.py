@@ -175,6 +175,7 @@
   ('Manuals/Program/freeciv21-client', 'freeciv21-client', 'The client for the Freeciv21 game.', [author], 6),
   ('Manuals/Program/freeciv21-game-manual', 'freeciv21-game-manual', 'The game manual for the freeciv21-server.', [author], 6),
   ('Manuals/Program/freeciv21-manual', 'freeciv21-manual', 'Write a manual for a Freeciv21 ruleset.', [author], 6),
+  ('Manuals/Program/freeciv21-mapframes', 'freeciv21-mapframes', 'Turn a map image stream into images.', [author], 6),
   ('Manuals/Program/freeciv21-modpack-qt', 'freeciv21-modpack-qt', 'GUI modpack installer for Freeciv21.', [author], 6),
   ('Manuals/Program/freeciv21-modpack', 'freeciv21-modpack', 'Command line modpack installer for Freeciv21.', [author], 6),
   ('Manuals/Program/freeciv21-ruleup', 'freeciv21-ruleup', 'Command line ruleset upgrade tool for Freeciv21.', [author], 6),
@@ -33,7 +33,8 @@
 #include "aiiface.h"
 
 #ifdef AI_MOD_STATIC_THREADED
-bool fc_ai_threaded_setup(struct ai_type *ai);
+/* ai/threaded */
+#include "threadedai.h"
 #endif
 
 #ifdef AI_MOD_STATIC_TEX
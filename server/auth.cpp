@@ -46,6 +46,10 @@ static bool is_guest_name(const char *name);
 static void get_unique_guest_name(char *name);
 static bool is_good_password(const char *password, char *msg);
 
+static void auth_user_exists_reply(const struct fcdb_reply *preply);
+static void auth_user_save_reply(const struct fcdb_reply *preply);
+static void auth_user_verify_reply(const struct fcdb_reply *preply);
+
 /**
    Handle authentication of a user; called by handle_login_request() if
    authentication is enabled.
@@ -81,62 +85,21 @@ bool auth_user(struct connection *pconn, char *username)
   } else {
     /* we are not a guest, we need an extra check as to whether a
      * connection can be established: the client must authenticate itself */
-    char buffer[MAX_LEN_MSG];
-    bool exists = false;
+    if (script_fcdb_pending() >= srvarg.auth_limit) {
+      reject_new_connection(_("The server is busy. Please try again "
+                              "later."),
+                            pconn);
+      qInfo(_("%s was rejected: Too many logins waiting on the "
+              "database."),
+            username);
+      return false;
+    }
 
     sz_strlcpy(pconn->username, username);
-
-    if (!script_fcdb_user_exists(pconn, exists)) {
-      if (srvarg.auth_allow_guests) {
-        sz_strlcpy(tmpname, pconn->username);
-        get_unique_guest_name(tmpname); // don't pass pconn->username here
-        sz_strlcpy(pconn->username, tmpname);
-
-        qCritical("Error reading database; connection -> guest");
-        notify_conn_early(
-            pconn->self, nullptr, E_CONNECTION, ftc_warning,
-            _("There was an error reading the user "
-              "database, logging in as guest connection '%s'."),
-            pconn->username);
-        establish_new_connection(pconn);
-      } else {
-        reject_new_connection(
-            _("There was an error reading the user database "
-              "and guest logins are not allowed. Sorry"),
-            pconn);
-        qInfo(_("%s was rejected: Database error and guests not "
-                "allowed."),
-              pconn->username);
-        return false;
-      }
-    } else if (exists) {
-      // we found a user
-      fc_snprintf(buffer, sizeof(buffer), _("Enter password for %s:"),
-                  pconn->username);
-      dsend_packet_authentication_req(pconn, AUTH_LOGIN_FIRST, buffer);
-      pconn->server.auth_settime = time(nullptr);
-      pconn->server.status = AS_REQUESTING_OLD_PASS;
-    } else {
-      // we couldn't find the user, he is new
-      if (srvarg.auth_allow_newusers) {
-        /* TRANS: Try not to make the translation much longer than the
-         * original. */
-        sz_strlcpy(
-            buffer,
-            _("First time login. Set a new password and confirm it."));
-        dsend_packet_authentication_req(pconn, AUTH_NEWUSER_FIRST, buffer);
-        pconn->server.auth_settime = time(nullptr);
-        pconn->server.status = AS_REQUESTING_NEW_PASS;
-      } else {
-        reject_new_connection(_("This server allows only preregistered "
-                                "users. Sorry."),
-                              pconn);
-        qInfo(_("%s was rejected: Only preregistered users allowed."),
-              pconn->username);
-
-        return false;
-      }
-    }
+    pconn->server.auth_settime = time(nullptr);
+    pconn->server.status = AS_WAITING_DATABASE;
+    script_fcdb_call(FCDB_USER_EXISTS, pconn, nullptr,
+                     auth_user_exists_reply);
   }
   return true;
 }
@@ -164,25 +127,14 @@ bool auth_handle_reply(struct connection *pconn, char *password)
       }
     }
 
-    if (!script_fcdb_user_save(pconn, password)) {
-      notify_conn(pconn->self, nullptr, E_CONNECTION, ftc_warning,
-                  _("Warning: There was an error in saving to the database. "
-                    "Continuing, but your stats will not be saved."));
-      qCritical("Error writing to database for: %s", pconn->username);
-    }
-
-    establish_new_connection(pconn);
+    pconn->server.auth_settime = time(nullptr);
+    pconn->server.status = AS_WAITING_DATABASE;
+    script_fcdb_call(FCDB_USER_SAVE, pconn, password, auth_user_save_reply);
   } else if (pconn->server.status == AS_REQUESTING_OLD_PASS) {
-    bool success = false;
-
-    if (script_fcdb_user_verify(pconn, password, success) && success) {
-      establish_new_connection(pconn);
-    } else {
-      pconn->server.status = AS_FAILED;
-      pconn->server.auth_tries++;
-      pconn->server.auth_settime =
-          time(nullptr) + auth_fail_wait[pconn->server.auth_tries];
-    }
+    pconn->server.auth_settime = time(nullptr);
+    pconn->server.status = AS_WAITING_DATABASE;
+    script_fcdb_call(FCDB_USER_VERIFY, pconn, password,
+                     auth_user_verify_reply);
   } else {
     qDebug("%s is sending unrequested auth packets", pconn->username);
     return false;
@@ -234,6 +186,16 @@ void auth_process_status(struct connection *pconn)
       connection_close_server(pconn, _("auth failed"));
     }
     break;
+  case AS_WAITING_DATABASE:
+    // a late reply from the database is ignored
+    if (time(nullptr) >= pconn->server.auth_settime + MAX_WAIT_TIME) {
+      pconn->server.status = AS_NOT_ESTABLISHED;
+      reject_new_connection(_("Sorry, your connection timed out..."), pconn);
+      qInfo(_("%s was rejected: Timeout waiting for the database."),
+            pconn->username);
+      connection_close_server(pconn, _("auth failed"));
+    }
+    break;
   case AS_ESTABLISHED:
     // this better fail bigtime
     fc_assert(pconn->server.status != AS_ESTABLISHED);
@@ -241,6 +203,135 @@ void auth_process_status(struct connection *pconn)
   }
 }
 
+/**
+   Return the connection a database reply is for, or nullptr if it is gone
+   or no longer waiting on the database.
+ */
+static struct connection *auth_reply_conn(const struct fcdb_reply *preply)
+{
+  struct connection *pconn = conn_by_number(preply->conn_id);
+
+  if (pconn == nullptr || pconn->server.is_closing
+      || pconn->server.status != AS_WAITING_DATABASE) {
+    log_debug("Dropping database reply for connection %d",
+              preply->conn_id);
+    return nullptr;
+  }
+
+  return pconn;
+}
+
+/**
+   Reject a connection that is waiting on the database and close it.
+ */
+static void auth_reject(struct connection *pconn, const char *msg)
+{
+  pconn->server.status = AS_NOT_ESTABLISHED;
+  reject_new_connection(msg, pconn);
+  connection_close_server(pconn, _("auth failed"));
+}
+
+/**
+   Continue auth_user() once the database knows whether the user exists.
+ */
+static void auth_user_exists_reply(const struct fcdb_reply *preply)
+{
+  struct connection *pconn = auth_reply_conn(preply);
+  char buffer[MAX_LEN_MSG];
+
+  if (pconn == nullptr) {
+    return;
+  }
+
+  if (!preply->valid) {
+    if (srvarg.auth_allow_guests) {
+      char tmpname[MAX_LEN_NAME];
+
+      sz_strlcpy(tmpname, pconn->username);
+      get_unique_guest_name(tmpname); // don't pass pconn->username here
+      sz_strlcpy(pconn->username, tmpname);
+
+      qCritical("Error reading database; connection -> guest");
+      notify_conn_early(pconn->self, nullptr, E_CONNECTION, ftc_warning,
+                        _("There was an error reading the user "
+                          "database, logging in as guest connection '%s'."),
+                        pconn->username);
+      establish_new_connection(pconn);
+    } else {
+      qInfo(_("%s was rejected: Database error and guests not "
+              "allowed."),
+            pconn->username);
+      auth_reject(pconn, _("There was an error reading the user database "
+                           "and guest logins are not allowed. Sorry"));
+    }
+  } else if (preply->result) {
+    // we found a user
+    fc_snprintf(buffer, sizeof(buffer), _("Enter password for %s:"),
+                pconn->username);
+    dsend_packet_authentication_req(pconn, AUTH_LOGIN_FIRST, buffer);
+    pconn->server.auth_settime = time(nullptr);
+    pconn->server.status = AS_REQUESTING_OLD_PASS;
+  } else {
+    // we couldn't find the user, he is new
+    if (srvarg.auth_allow_newusers) {
+      /* TRANS: Try not to make the translation much longer than the
+       * original. */
+      sz_strlcpy(buffer,
+                 _("First time login. Set a new password and confirm it."));
+      dsend_packet_authentication_req(pconn, AUTH_NEWUSER_FIRST, buffer);
+      pconn->server.auth_settime = time(nullptr);
+      pconn->server.status = AS_REQUESTING_NEW_PASS;
+    } else {
+      qInfo(_("%s was rejected: Only preregistered users allowed."),
+            pconn->username);
+      auth_reject(pconn, _("This server allows only preregistered "
+                           "users. Sorry."));
+    }
+  }
+}
+
+/**
+   Let a new user in once the database has saved it, or failed to.
+ */
+static void auth_user_save_reply(const struct fcdb_reply *preply)
+{
+  struct connection *pconn = auth_reply_conn(preply);
+
+  if (pconn == nullptr) {
+    return;
+  }
+
+  if (!preply->valid) {
+    notify_conn(pconn->self, nullptr, E_CONNECTION, ftc_warning,
+                _("Warning: There was an error in saving to the database. "
+                  "Continuing, but your stats will not be saved."));
+    qCritical("Error writing to database for: %s", pconn->username);
+  }
+
+  establish_new_connection(pconn);
+}
+
+/**
+   Let a user in once the database has checked the password.
+ */
+static void auth_user_verify_reply(const struct fcdb_reply *preply)
+{
+  struct connection *pconn = auth_reply_conn(preply);
+
+  if (pconn == nullptr) {
+    return;
+  }
+
+  if (preply->valid && preply->result) {
+    establish_new_connection(pconn);
+  } else {
+    pconn->server.status = AS_FAILED;
+    pconn->server.auth_tries++;
+    pconn->server.auth_settime =
+        time(nullptr) + auth_fail_wait[pconn->server.auth_tries];
+  }
+}
+
 /**
    See if the name qualifies as a guest login name
  */
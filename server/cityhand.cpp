@@ -101,7 +101,7 @@ void handle_city_change_specialist(struct player *pplayer, int city_id,
   pcity->specialists[from]--;
   pcity->specialists[to]++;
 
-  city_refresh(pcity);
+  city_refresh_workers(pcity);
   sanity_check_city(pcity);
   send_city_info(pplayer, pcity);
 }
@@ -144,7 +144,7 @@ void handle_city_make_specialist(struct player *pplayer, int city_id,
            TILE_XY(ptile), city_name_get(pcity));
   }
 
-  city_refresh(pcity);
+  city_refresh_workers(pcity);
   sanity_check_city(pcity);
   sync_cities();
 }
@@ -213,7 +213,7 @@ void handle_city_make_worker(struct player *pplayer, int city_id,
   }
   specialist_type_iterate_end;
 
-  city_refresh(pcity);
+  city_refresh_workers(pcity);
   sanity_check_city(pcity);
   sync_cities();
 }
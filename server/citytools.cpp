@@ -1096,6 +1096,7 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
   int i;
 
   fc_assert_ret_val(pgiver != ptaker, true);
+  city_refresh_invalidate_effects();
 
   bv_player *could_see_unit =
       (units_num > 0 ? new bv_player[units_num] : nullptr);
@@ -1512,6 +1513,8 @@ void create_city(struct player *pplayer, struct tile *ptile,
   log_debug("create_city() %s", name);
 
   pcity = create_city_virtual(pplayer, ptile, name);
+  // Nearby units may stop being aggressive, and so on.
+  city_refresh_invalidate_effects();
 
   /* Remove units no more seen. Do it before city is really put into the
    * game. */
@@ -1654,7 +1657,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
 
   sanity_check_city(pcity);
 
-  script_server_signal_emit("city_built", pcity);
+  script_server_signal_emit(SSIG_CITY_BUILT, pcity);
 
   CALL_FUNC_EACH_AI(city_created, pcity);
   CALL_PLR_AI_FUNC(city_got, pplayer, pplayer, pcity);
@@ -1679,6 +1682,7 @@ void remove_city(struct city *pcity)
 
   CALL_PLR_AI_FUNC(city_lost, powner, powner, pcity);
   CALL_FUNC_EACH_AI(city_destroyed, pcity);
+  city_refresh_invalidate_effects();
 
   BV_CLR_ALL(had_small_wonders);
   city_built_iterate(pcity, pimprove)
@@ -2002,7 +2006,7 @@ bool unit_conquer_city(struct unit *punit, struct city *pcity)
     notify_player(cplayer, city_tile(pcity), E_CITY_LOST, ftc_server,
                   _("%s has been destroyed by %s."), city_tile_link(pcity),
                   player_name(pplayer));
-    script_server_signal_emit("city_destroyed", pcity, cplayer, pplayer);
+    script_server_signal_emit(SSIG_CITY_DESTROYED, pcity, cplayer, pplayer);
 
     // We cant't be sure of city existence after running some script
     if (city_exist(saved_id)) {
@@ -2093,9 +2097,9 @@ bool unit_conquer_city(struct unit *punit, struct city *pcity)
   }
 
   if (city_remains) {
-    script_server_signal_emit("city_transferred", pcity, cplayer, pplayer,
+    script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, cplayer, pplayer,
                               "conquest");
-    script_server_signal_emit("city_lost", pcity, cplayer, pplayer);
+    script_server_signal_emit(SSIG_CITY_LOST, pcity, cplayer, pplayer);
   }
 
   return true;
@@ -2309,6 +2313,8 @@ void send_city_info(struct player *dest, struct city *pcity)
     // We want to send the new total bulbs production of the team.
     send_research_info(research_get(powner), nullptr);
   }
+
+  CALL_FUNC_EACH_AI(city_info, pcity);
 }
 
 /**
@@ -2855,7 +2861,7 @@ bool building_removed(struct city *pcity, const struct impr_type *pimprove,
 
   city_remove_improvement(pcity, pimprove);
 
-  script_server_signal_emit("building_lost", pcity, pimprove, reason,
+  script_server_signal_emit(SSIG_BUILDING_LOST, pcity, pimprove, reason,
                             destroyer);
 
   return city_exist(backup);
@@ -2914,7 +2920,7 @@ void building_lost(struct city *pcity, const struct impr_type *pimprove,
 
    If the upkeep for a unit changes, an update is send to the player.
  */
-void city_units_upkeep(const struct city *pcity)
+void city_units_upkeep(struct city *pcity)
 {
   int free_uk[O_LAST];
   int cost;
@@ -2922,6 +2928,11 @@ void city_units_upkeep(const struct city *pcity)
   struct player *plr;
   bool update;
 
+  if (pcity != nullptr) {
+    // The upkeep is used by the support stage of the city refresh.
+    city_refresh_invalidate(pcity, CRS_SUPPORT);
+  }
+
   if (!pcity || !pcity->units_supported
       || unit_list_size(pcity->units_supported) < 1) {
     return;
@@ -76,7 +76,7 @@ bool building_removed(struct city *pcity, const struct impr_type *pimprove,
                       const char *reason, struct unit *destroyer);
 void building_lost(struct city *pcity, const struct impr_type *pimprove,
                    const char *reason, struct unit *destroyer);
-void city_units_upkeep(const struct city *pcity);
+void city_units_upkeep(struct city *pcity);
 
 void change_build_target(struct player *pplayer, struct city *pcity,
                          struct universal *target, enum event_type event);
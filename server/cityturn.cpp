@@ -163,12 +163,72 @@ bool city_refresh(struct city *pcity)
   return retval;
 }
 
+/**
+   Refreshes the city after its workers and specialists have been moved
+   around. Only the stages that have been invalidated since the last
+   refresh are redone. Returns whether city radius has changed.
+ */
+bool city_refresh_workers(struct city *pcity)
+{
+  if (pcity->server.needs_refresh
+      || city_refresh_needed(pcity, CRS_BONUSES)) {
+    /* Something else changed, too. If effects did, the city radius may
+     * have changed with them. */
+    return city_refresh(pcity);
+  }
+
+  if (city_refresh_needed(pcity, CRS_SUPPORT)) {
+    city_units_upkeep(pcity);
+  }
+  city_refresh_dirty(pcity);
+
+  return false;
+}
+
+/**
+   Refreshes the city after units have entered or left it, or its units
+   have moved somewhere that changes their unhappiness. Only the upkeep
+   part of the refresh needs to be redone for this.
+ */
+void city_refresh_units(struct city *pcity)
+{
+  city_refresh_invalidate(pcity, CRS_SUPPORT);
+  (void) city_refresh_workers(pcity);
+}
+
+/**
+   Reports how much of the incremental city refreshes could be skipped
+   since the last call.
+ */
+void city_refresh_log_stats()
+{
+  const struct city_refresh_stats *stats = city_refresh_stats_get();
+  QString msg = QStringLiteral("City refresh: %1 incremental")
+                    .arg(stats->refreshes);
+
+  for (int stage = 0; stage < CRS_LAST; stage++) {
+    msg += QStringLiteral(", %1 %2 run %3 skipped")
+               .arg(city_refresh_stage_name(
+                   static_cast<enum city_refresh_stage>(stage)))
+               .arg(stats->run[stage])
+               .arg(stats->skipped[stage]);
+  }
+#ifdef FREECIV_DEBUG
+  msg += QStringLiteral(", %1 mismatches").arg(stats->mismatches);
+#endif
+  log_time(msg);
+
+  city_refresh_stats_reset();
+}
+
 /**
    Called on government change or wonder completion or stuff like that
    -- Syela
  */
 void city_refresh_for_player(struct player *pplayer)
 {
+  // The change may reach the cities of other players, too.
+  city_refresh_invalidate_effects();
   conn_list_do_buffer(pplayer->connections);
   city_list_iterate(pplayer->cities, pcity)
   {
@@ -443,7 +503,7 @@ void auto_arrange_workers(struct city *pcity)
     cm_print_result(cmr);
   }
 
-  if (city_refresh(pcity)) {
+  if (city_refresh_workers(pcity)) {
     qCritical("%s radius changed when already arranged workers.",
               city_name_get(pcity));
     /* Can't do anything - don't want to enter infinite recursive loop
@@ -822,7 +882,7 @@ bool city_reduce_size(struct city *pcity, citizens pop_loss,
   }
 
   if (city_size_get(pcity) <= pop_loss) {
-    script_server_signal_emit("city_destroyed", pcity, pcity->owner,
+    script_server_signal_emit(SSIG_CITY_DESTROYED, pcity, pcity->owner,
                               destroyer);
 
     remove_city(pcity);
@@ -879,7 +939,8 @@ bool city_reduce_size(struct city *pcity, citizens pop_loss,
   if (reason != nullptr) {
     int id = pcity->id;
 
-    script_server_signal_emit("city_size_change", pcity, -pop_loss, reason);
+    script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, -pop_loss,
+                              reason);
 
     return city_exist(id);
   }
@@ -1050,7 +1111,7 @@ static bool city_increase_size(struct city *pcity,
   /* Deprecated signal. Connect your lua functions to "city_size_change"
    * that's emitted from calling functions which know the 'reason' of the
    * increase. */
-  script_server_signal_emit("city_growth", pcity, city_size_get(pcity));
+  script_server_signal_emit(SSIG_CITY_GROWTH, pcity, city_size_get(pcity));
   if (city_exist(saved_id)) {
     // Script didn't destroy this city
     sanity_check_city(pcity);
@@ -1083,7 +1144,7 @@ bool city_change_size(struct city *pcity, citizens size,
     if (real_change != 0 && reason != nullptr) {
       int id = pcity->id;
 
-      script_server_signal_emit("city_size_change", pcity, real_change,
+      script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, real_change,
                                 reason);
 
       if (!city_exist(id)) {
@@ -1131,7 +1192,7 @@ static void city_populate(struct city *pcity, struct player *nationality)
       map_claim_border(pcity->tile, pcity->owner, -1);
 
       if (success) {
-        script_server_signal_emit("city_size_change", pcity, 1, "growth");
+        script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, 1, "growth");
       }
     }
   } else if (pcity->food_stock < 0) {
@@ -1190,7 +1251,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
   const void *ptarget;
   const char *tgt_name;
   const struct requirement_vector *build_reqs;
-  const char *signal_name;
+  enum script_signal signal_id;
 
   bool purge = false;
   bool known = false;
@@ -1201,14 +1262,14 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
     build_reqs = &target->value.utype->build_reqs;
     tgt_name =
         utype_name_translation(static_cast<const unit_type *>(ptarget));
-    signal_name = "unit_cant_be_built";
+    signal_id = SSIG_UNIT_CANT_BE_BUILT;
     break;
   case VUT_IMPROVEMENT:
     ptarget = target->value.building;
     build_reqs = &target->value.building->reqs;
     tgt_name = city_improvement_name_translation(
         pcity, static_cast<const impr_type *>(ptarget));
-    signal_name = "building_cant_be_built";
+    signal_id = SSIG_BUILDING_CANT_BE_BUILT;
     break;
   default:
     fc_assert_ret_val(
@@ -1233,7 +1294,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "tech %s not yet available. Postponing..."),
               city_link(pcity), tgt_name,
               advance_name_translation(preq->source.value.advance));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_tech");
         } else {
           // While techs can be unlearned, this isn't useful feedback
@@ -1249,7 +1310,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "Postponing..."),
               city_link(pcity), tgt_name,
               tech_flag_id_name(tech_flag_id(preq->source.value.techflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_techflag");
         } else {
           // While techs can be unlearned, this isn't useful feedback
@@ -1265,7 +1326,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         city_improvement_name_translation(
                             pcity, preq->source.value.building));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_building");
         } else {
           notify_player(pplayer, city_tile(pcity), E_CITY_CANTBUILD,
@@ -1275,7 +1336,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         city_improvement_name_translation(
                             pcity, preq->source.value.building));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_building");
         }
         break;
@@ -1287,7 +1348,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "need to have %s first. Postponing..."),
               city_link(pcity), tgt_name,
               impr_genus_id_translated_name(preq->source.value.impr_genus));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_building_genus");
         } else {
           notify_player(
@@ -1296,7 +1357,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "need to not have %s. Postponing..."),
               city_link(pcity), tgt_name,
               impr_genus_id_translated_name(preq->source.value.impr_genus));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_building_genus");
         }
         break;
@@ -1308,7 +1369,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "it needs %s government. Postponing..."),
               city_link(pcity), tgt_name,
               government_name_translation(preq->source.value.govern));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_government");
         } else {
           notify_player(
@@ -1317,7 +1378,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "it cannot have %s government. Postponing..."),
               city_link(pcity), tgt_name,
               government_name_translation(preq->source.value.govern));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_government");
         }
         break;
@@ -1329,7 +1390,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "it needs \"%s\" achievement. Postponing..."),
               city_link(pcity), tgt_name,
               achievement_name_translation(preq->source.value.achievement));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_achievement");
         } else {
           // Can't unachieve things.
@@ -1344,7 +1405,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                            "%s is required. Postponing..."),
                         city_link(pcity), tgt_name,
                         extra_name_translation(preq->source.value.extra));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_extra");
         } else {
           notify_player(pplayer, city_tile(pcity), E_CITY_CANTBUILD,
@@ -1353,7 +1414,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                            "%s is prohibited. Postponing..."),
                         city_link(pcity), tgt_name,
                         extra_name_translation(preq->source.value.extra));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_extra");
         }
         break;
@@ -1365,7 +1426,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                            "%s is required. Postponing..."),
                         city_link(pcity), tgt_name,
                         goods_name_translation(preq->source.value.good));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_good");
         } else {
           notify_player(pplayer, city_tile(pcity), E_CITY_CANTBUILD,
@@ -1374,7 +1435,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                            "%s is prohibited. Postponing..."),
                         city_link(pcity), tgt_name,
                         goods_name_translation(preq->source.value.good));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_good");
         }
         break;
@@ -1386,7 +1447,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                  "%s terrain is required. Postponing..."),
               city_link(pcity), tgt_name,
               terrain_name_translation(preq->source.value.terrain));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_terrain");
         } else {
           notify_player(
@@ -1395,7 +1456,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                  "%s terrain is prohibited. Postponing..."),
               city_link(pcity), tgt_name,
               terrain_name_translation(preq->source.value.terrain));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_terrain");
         }
         break;
@@ -1409,7 +1470,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                  "%s nation is required. Postponing..."),
               city_link(pcity), tgt_name,
               nation_adjective_translation(preq->source.value.nation));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_nation");
         } else {
           notify_player(
@@ -1418,7 +1479,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                  "%s nation is prohibited. Postponing..."),
               city_link(pcity), tgt_name,
               nation_adjective_translation(preq->source.value.nation));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_nation");
         }
         break;
@@ -1433,7 +1494,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                  "%s nation is required. Postponing..."),
               city_link(pcity), tgt_name,
               nation_group_name_translation(preq->source.value.nationgroup));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_nationgroup");
         } else {
           notify_player(
@@ -1442,7 +1503,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                  "%s nation is prohibited. Postponing..."),
               city_link(pcity), tgt_name,
               nation_group_name_translation(preq->source.value.nationgroup));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_nationgroup");
         }
         break;
@@ -1457,7 +1518,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "only %s style cities may build this. Postponing..."),
               city_link(pcity), tgt_name,
               style_name_translation(preq->source.value.style));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_style");
         } else {
           notify_player(
@@ -1466,7 +1527,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "%s style cities may not build this. Postponing..."),
               city_link(pcity), tgt_name,
               style_name_translation(preq->source.value.style));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_style");
         }
         break;
@@ -1481,7 +1542,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "only city with %s may build this. Postponing..."),
               city_link(pcity), tgt_name,
               nation_plural_translation(preq->source.value.nationality));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_nationality");
         } else {
           notify_player(
@@ -1491,7 +1552,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "only city without %s may build this. Postponing..."),
               city_link(pcity), tgt_name,
               nation_plural_translation(preq->source.value.nationality));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_nationality");
         }
         break;
@@ -1507,7 +1568,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "  Postponing..."),
               city_link(pcity), tgt_name,
               diplrel_name_translation(preq->source.value.diplrel));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_diplrel");
         } else {
           notify_player(
@@ -1517,7 +1578,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "  Postponing..."),
               city_link(pcity), tgt_name,
               diplrel_name_translation(preq->source.value.diplrel));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_diplrel");
         }
         break;
@@ -1529,7 +1590,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "city must be of size %d or larger. "
                 "Postponing..."),
               city_link(pcity), tgt_name, preq->source.value.minsize);
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_minsize");
         } else {
           notify_player(
@@ -1538,7 +1599,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "city must be of size %d or smaller."
                 "Postponing..."),
               city_link(pcity), tgt_name, (preq->source.value.minsize - 1));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_minsize");
         }
         break;
@@ -1549,7 +1610,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
               _("%s can't build %s from the worklist; "
                 "city must have culture of %d. Postponing..."),
               city_link(pcity), tgt_name, preq->source.value.minculture);
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_minculture");
         } else {
           // What has been written may not be unwritten.
@@ -1563,7 +1624,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
               _("%s can't build %s from the worklist; "
                 "city must have %d%% foreign population. Postponing..."),
               city_link(pcity), tgt_name, preq->source.value.minforeignpct);
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_minforeignpct");
         } else {
           notify_player(
@@ -1572,7 +1633,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "city must have %d%% native population. Postponing..."),
               city_link(pcity), tgt_name,
               100 - preq->source.value.minforeignpct);
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_minforeignpct");
         }
         break;
@@ -1583,7 +1644,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
               _("%s can't build %s from the worklist; "
                 "%d techs must be known. Postponing..."),
               city_link(pcity), tgt_name, preq->source.value.min_techs);
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_mintechs");
         } else {
           purge = true;
@@ -1601,7 +1662,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                   "  Postponing...",
                   preq->source.value.max_tile_units),
               city_link(pcity), tgt_name, preq->source.value.max_tile_units);
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_tileunits");
         } else {
           notify_player(pplayer, city_tile(pcity), E_CITY_CANTBUILD,
@@ -1615,7 +1676,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                             preq->source.value.max_tile_units + 1),
                         city_link(pcity), tgt_name,
                         preq->source.value.max_tile_units + 1);
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_tileunits");
         }
         break;
@@ -1633,7 +1694,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         terrain_class_name_translation(
                             terrain_class(preq->source.value.terrainclass)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_terrainclass");
         } else {
           notify_player(pplayer, city_tile(pcity), E_CITY_CANTBUILD,
@@ -1644,7 +1705,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         terrain_class_name_translation(
                             terrain_class(preq->source.value.terrainclass)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_terrainclass");
         }
         break;
@@ -1658,7 +1719,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         terrain_flag_id_name(terrain_flag_id(
                             preq->source.value.terrainflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_terrainflag");
         } else {
           notify_player(pplayer, city_tile(pcity), E_CITY_CANTBUILD,
@@ -1669,7 +1730,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         terrain_flag_id_name(terrain_flag_id(
                             preq->source.value.terrainflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_terrainflag");
         }
         break;
@@ -1682,7 +1743,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "Postponing..."),
               city_link(pcity), tgt_name,
               base_flag_id_name(base_flag_id(preq->source.value.baseflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_baseflag");
         } else {
           notify_player(
@@ -1692,7 +1753,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "Postponing..."),
               city_link(pcity), tgt_name,
               base_flag_id_name(base_flag_id(preq->source.value.baseflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_baseflag");
         }
         break;
@@ -1705,7 +1766,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "Postponing..."),
               city_link(pcity), tgt_name,
               road_flag_id_name(road_flag_id(preq->source.value.roadflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_roadflag");
         } else {
           notify_player(
@@ -1715,7 +1776,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                 "Postponing..."),
               city_link(pcity), tgt_name,
               road_flag_id_name(road_flag_id(preq->source.value.roadflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_roadflag");
         }
         break;
@@ -1729,7 +1790,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         extra_flag_id_translated_name(
                             extra_flag_id(preq->source.value.extraflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_extraflag");
         } else {
           notify_player(pplayer, city_tile(pcity), E_CITY_CANTBUILD,
@@ -1740,7 +1801,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         city_link(pcity), tgt_name,
                         extra_flag_id_translated_name(
                             extra_flag_id(preq->source.value.extraflag)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_extraflag");
         }
         break;
@@ -1773,7 +1834,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                           "only available from %s. Postponing..."),
                         city_link(pcity), tgt_name,
                         textyear(preq->source.value.minyear));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_minyear");
         } else {
           // Can't go back in time.
@@ -1792,7 +1853,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                           "only available from %s. Postponing..."),
                         city_link(pcity), tgt_name,
                         textcalfrag(preq->source.value.mincalfrag));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_mincalfrag");
         } else {
           fc_assert_action(preq->source.value.mincalfrag > 0, break);
@@ -1804,7 +1865,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                           "not available after %s. Postponing..."),
                         city_link(pcity), tgt_name,
                         textcalfrag(preq->source.value.mincalfrag - 1));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "have_mincalfrag");
         }
         break;
@@ -1818,7 +1879,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                           "only available in worlds with %s map."),
                         city_link(pcity), tgt_name,
                         _(topo_flag_name(preq->source.value.topo_property)));
-          script_server_signal_emit(signal_name, ptarget, pcity,
+          script_server_signal_emit(signal_id, ptarget, pcity,
                                     "need_topo");
         }
         purge = true;
@@ -1837,7 +1898,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                       city_link(pcity), tgt_name,
                       qUtf8Printable(ssetv_human_readable(
                           preq->source.value.ssetval, preq->present)));
-        script_server_signal_emit(signal_name, ptarget, pcity,
+        script_server_signal_emit(signal_id, ptarget, pcity,
                                   "need_setting");
         // Don't assume that the server setting will be changed.
         purge = true;
@@ -1849,7 +1910,7 @@ static bool worklist_item_postpone_req_vec(struct universal *target,
                         _("%s can't build %s from the worklist; "
                           "only available once %d turns old. Postponing..."),
                         city_link(pcity), tgt_name, preq->source.value.age);
-          script_server_signal_emit(signal_name, ptarget, pcity, "need_age");
+          script_server_signal_emit(signal_id, ptarget, pcity, "need_age");
         } else {
           // Can't go back in time.
           purge = true;
@@ -1952,7 +2013,7 @@ static bool worklist_change_build_target(struct player *pplayer,
                           "tech %s not yet available. Postponing..."),
                         city_link(pcity), utype_name_translation(ptarget),
                         advance_name_translation(ptarget->require_advance));
-          script_server_signal_emit("unit_cant_be_built", ptarget, pcity,
+          script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, ptarget, pcity,
                                     "need_tech");
         } else {
           // Unknown or requirement from vector.
@@ -1976,7 +2037,7 @@ static bool worklist_change_build_target(struct player *pplayer,
                          in the worklist, not its obsolete-closure
                          pupdate. */
                       utype_name_translation(ptarget));
-        script_server_signal_emit("unit_cant_be_built", ptarget, pcity,
+        script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, ptarget, pcity,
                                   "never");
         if (city_exist(saved_id)) {
           city_checked = true;
@@ -2038,8 +2099,8 @@ static bool worklist_change_build_target(struct player *pplayer,
                       _("%s can't build %s from the worklist. Purging..."),
                       city_link(pcity),
                       city_improvement_name_translation(pcity, ptarget));
-        script_server_signal_emit("building_cant_be_built", ptarget, pcity,
-                                  "never");
+        script_server_signal_emit(SSIG_BUILDING_CANT_BE_BUILT, ptarget,
+                                  pcity, "never");
         if (city_exist(saved_id)) {
           city_checked = true;
           // Purge this worklist item.
@@ -2336,7 +2397,7 @@ static bool city_build_building(struct player *pplayer, struct city *pcity)
                   _("%s is building %s, which is no longer available."),
                   city_link(pcity),
                   city_improvement_name_translation(pcity, pimprove));
-    script_server_signal_emit("building_cant_be_built", pimprove, pcity,
+    script_server_signal_emit(SSIG_BUILDING_CANT_BE_BUILT, pimprove, pcity,
                               "unavailable");
     return true;
   }
@@ -2389,7 +2450,7 @@ static bool city_build_building(struct player *pplayer, struct city *pcity)
     notify_player(pplayer, city_tile(pcity), E_IMP_BUILD, ftc_server,
                   _("%s has finished building %s."), city_link(pcity),
                   improvement_name_translation(pimprove));
-    script_server_signal_emit("building_built", pimprove, pcity);
+    script_server_signal_emit(SSIG_BUILDING_BUILT, pimprove, pcity);
 
     if (!city_exist(saved_id)) {
       // Script removed city
@@ -2497,7 +2558,7 @@ static struct unit *city_create_unit(struct city *pcity,
   }
 
   /* This might destroy pcity and/or punit: */
-  script_server_signal_emit("unit_built", punit, pcity);
+  script_server_signal_emit(SSIG_UNIT_BUILT, punit, pcity);
 
   if (unit_is_alive(saved_unit_id)) {
     return punit;
@@ -2544,7 +2605,7 @@ static bool city_build_unit(struct player *pplayer, struct city *pcity)
     qDebug("%s %s tried to build %s, which is not available.",
            nation_rule_name(nation_of_city(pcity)), city_name_get(pcity),
            utype_rule_name(utype));
-    script_server_signal_emit("unit_cant_be_built", utype, pcity,
+    script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, utype, pcity,
                               "unavailable");
     return city_exist(saved_city_id);
   }
@@ -2566,7 +2627,7 @@ static bool city_build_unit(struct player *pplayer, struct city *pcity)
                       "(city size: %d, unit population cost: %d)"),
                     city_link(pcity), utype_name_translation(utype),
                     city_size_get(pcity), pop_cost);
-      script_server_signal_emit("unit_cant_be_built", utype, pcity,
+      script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, utype, pcity,
                                 "pop_cost");
       return city_exist(saved_city_id);
     }
@@ -3508,7 +3569,7 @@ static bool disband_city(struct city *pcity)
                   _("%s can't build %s yet, "
                     "as we can't disband our only city."),
                   city_link(pcity), utype_name_translation(utype));
-    script_server_signal_emit("unit_cant_be_built", utype, pcity,
+    script_server_signal_emit(SSIG_UNIT_CANT_BE_BUILT, utype, pcity,
                               "pop_cost");
     if (!city_exist(saved_id)) {
       // Script decided to remove even the last city
@@ -3538,7 +3599,7 @@ static bool disband_city(struct city *pcity)
                     utype_name_translation(utype));
     }
 
-    script_server_signal_emit("city_destroyed", pcity, pcity->owner,
+    script_server_signal_emit(SSIG_CITY_DESTROYED, pcity, pcity->owner,
                               nullptr);
 
     remove_city(pcity);
@@ -3839,11 +3900,11 @@ static bool do_city_migration(struct city *pcity_from, struct city *pcity_to)
                           true);
       sz_strlcpy(name_from, city_tile_link(pcity_from));
 
-      script_server_signal_emit("city_size_change", pcity_from, -1,
+      script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity_from, -1,
                                 "migration_from");
 
       if (city_exist(id)) {
-        script_server_signal_emit("city_destroyed", pcity_from,
+        script_server_signal_emit(SSIG_CITY_DESTROYED, pcity_from,
                                   pcity_from->owner, nullptr);
 
         if (city_exist(id)) {
@@ -3917,7 +3978,7 @@ static bool do_city_migration(struct city *pcity_from, struct city *pcity_to)
         auto_arrange_workers(pcity_to);
       }
       if (incr_success) {
-        script_server_signal_emit("city_size_change", pcity_to, 1,
+        script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity_to, 1,
                                   "migration_to");
       }
     }
@@ -4105,9 +4166,9 @@ static void apply_disaster(struct city *pcity, struct disaster_type *pdis)
     }
   }
 
-  script_server_signal_emit("disaster_occurred", pdis, pcity,
+  script_server_signal_emit(SSIG_DISASTER_OCCURRED, pdis, pcity,
                             had_internal_effect);
-  script_server_signal_emit("disaster", pdis, pcity);
+  script_server_signal_emit(SSIG_DISASTER, pdis, pcity);
 }
 
 /**
@@ -20,6 +20,9 @@ struct cm_result;
 
 bool city_refresh(struct city *pcity); // call if city has changed
 void city_refresh_for_player(struct player *pplayer); /* tax/govt changed */
+bool city_refresh_workers(struct city *pcity); // workers moved around
+void city_refresh_units(struct city *pcity);   // units moved in or out
+void city_refresh_log_stats();
 
 void city_refresh_queue_add(struct city *pcity);
 void city_refresh_queue_processing();
@@ -242,6 +242,11 @@ int main(int argc, char *argv[])
        _("FILE")},
       {{"G", "Guests"}, _("Allow guests to login if auth is enabled.")},
       {{"N", "Newusers"}, _("Allow new users to login if auth is enabled.")},
+      {"auth-limit",
+       _("Let at most N logins wait on the database at once "
+         "(default 32)."),
+       // TRANS: Command-line argument
+       _("N")},
 #ifdef AI_MODULES
       {"LoadAI", _("Load ai module MODULE. Can appear multiple times."),
        // TRANS: Command-line argument
@@ -341,6 +346,16 @@ int main(int argc, char *argv[])
   if (parser.isSet("Newusers")) {
     srvarg.auth_allow_newusers = true;
   }
+  if (parser.isSet(QStringLiteral("auth-limit"))) {
+    bool conversion_ok;
+    srvarg.auth_limit =
+        parser.value(QStringLiteral("auth-limit")).toUInt(&conversion_ok);
+    if (!conversion_ok || srvarg.auth_limit < 1) {
+      qFatal(_("Invalid number %s"),
+             qUtf8Printable(parser.value("auth-limit")));
+      exit(EXIT_FAILURE);
+    }
+  }
   if (parser.isSet(QStringLiteral("Serverid"))) {
     srvarg.serverid = parser.value(QStringLiteral("Serverid"));
   }
@@ -624,6 +624,21 @@ static struct command commands[] = {
         "server. Access to it is therefore limited to the console and "
         "connections with cmdlevel 'hack'"),
      nullptr, CMD_ECHO_ADMINS, VCF_NONE, 0},
+    {"luaprofile", ALLOW_ADMIN,
+     // TRANS: translate text between <> only
+     N_("luaprofile on|off\n"
+        "luaprofile show\n"
+        "luaprofile reset\n"
+        "luaprofile budget <milliseconds>"),
+     N_("Measure the time spent in ruleset and scenario script callbacks."),
+     N_("With 'on', the server records how often each signal and script "
+        "callback is invoked and how much time it takes. 'show' lists the "
+        "results, slowest signals first, and 'reset' clears them. "
+        "'budget' sets the time each callback may use in a turn; a "
+        "warning is logged when a callback goes over it. Budgets are "
+        "checked even when profiling is off. Use 0 to remove the "
+        "budget."),
+     nullptr, CMD_ECHO_ADMINS, VCF_NONE, 0},
     {"kick", ALLOW_CTRL,
      // TRANS: translate text between <>
      N_("kick <user>"), N_("Cut a connection and disallow reconnect."),
@@ -669,12 +684,15 @@ static struct command commands[] = {
     {"fcdb", ALLOW_ADMIN,
      // TRANS: translate text between <> only
      N_("fcdb reload\n"
-        "fcdb lua <script>"),
+        "fcdb lua <script>\n"
+        "fcdb stats"),
      N_("Manage the authentication database."),
      N_("The argument 'reload' causes the database script file to be "
         "re-read "
         "after a change, while the argument 'lua' evaluates a line of Lua "
-        "script in the context of the Lua instance for the database."),
+        "script in the context of the Lua instance for the database. "
+        "The argument 'stats' shows how long logins waited on the "
+        "database."),
      nullptr, CMD_ECHO_ADMINS, VCF_NONE, 0},
     {"mapimg", ALLOW_ADMIN,
      // TRANS: translate text between <> only
@@ -1095,6 +1095,7 @@ void handle_edit_player(struct connection *pc,
       if (turns >= 0) {
         pplayer->government = gov;
         pplayer->revolution_finishes = game.info.turn + turns;
+        city_refresh_invalidate_effects();
       }
     }
 
@@ -1249,6 +1250,7 @@ void handle_edit_player_vision(struct connection *pc, int plr_no, int tile,
  */
 void handle_edit_recalculate_borders(struct connection *pc)
 {
+  map_borders_invalidate();
   map_calculate_borders();
 }
 
@@ -145,6 +145,7 @@ const char *fcdb_option_get(const char *type)
  */
 void fcdb_free(void)
 {
+  script_fcdb_stop();
   script_fcdb_free();
 
   for (auto popt : qAsConst(fcdb_config)) {
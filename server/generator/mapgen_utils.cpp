@@ -19,6 +19,9 @@ _   ._       Copyright (c) 1996-2021 Freeciv21 and Freeciv contributors.
 #include "terrain.h"
 #include "tile.h"
 
+// server
+#include "maphand.h"
+
 #include "mapgen_utils.h"
 
 /**
@@ -436,6 +439,9 @@ int get_ocean_size(Continent_id id)
  */
 void assign_continent_numbers()
 {
+  // Claimable tiles depend on continents.
+  map_borders_invalidate();
+
   // Initialize
   wld.map.num_continents = 0;
   wld.map.num_oceans = 0;
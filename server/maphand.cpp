@@ -12,13 +12,21 @@
       \____/        ********************************************************/
 
 #include <QBitArray>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QtEndian>
+#include <vector>
 
 // utility
 #include "bitvector.h"
+#include "capability.h"
 #include "fcintl.h"
 #include "log.h"
 #include "rand.h"
 #include "support.h"
+#include "timing.h"
 
 // common
 #include "ai.h"
@@ -57,7 +65,48 @@
 // Suppress send_tile_info() during game_load()
 static bool send_tile_suppressed = false;
 
+static bool package_tile_info(struct packet_tile_info *info,
+                              const struct tile *ptile,
+                              const struct player *pplayer,
+                              bool send_unknown);
+
+/**
+   State of a border source as of its last map_claim_border() run in
+   map_calculate_borders().
+ */
+struct border_source_state {
+  const struct player *owner;
+  int radius_sq;
+  int strength;
+  int city_radius_sq;
+  bool claim_ocean;
+  bool claim_ocean_limited;
+  unsigned long long gen; // Value of border_cache.gen after the last run
+};
+
+/**
+   Data used by map_calculate_borders() to skip sources that would not
+   change anything. Every change to the claimer, knowledge or terrain of a
+   tile stores a new generation number for the tile. A source needs to run
+   again only when its own state changed or a tile within its radius has a
+   newer generation than its last run.
+ */
+static struct {
+  bool valid = false;
+  unsigned long long gen = 0;
+  std::vector<unsigned long long> tile_gen;
+  QHash<int, struct border_source_state> sources;
+} border_cache;
+
+static void border_tile_changed(const struct tile *ptile);
+
+// The player_tile_state most recently shared for each tile.
+static std::vector<std::shared_ptr<player_tile_state>> shared_states;
+
 static void player_tile_init(struct tile *ptile, struct player *pplayer);
+static void player_tile_share(const struct tile *ptile,
+                              struct player_tile *plrtile,
+                              const struct player_tile_state &state);
 static void player_tile_free(struct tile *ptile, struct player *pplayer);
 static void give_tile_info_from_player_to_player(struct player *pfrom,
                                                  struct player *pdest,
@@ -376,11 +425,13 @@ void give_map_from_player_to_player(struct player *pfrom,
 {
   buffer_shared_vision(pdest);
 
-  whole_map_iterate(&(wld.map), ptile)
+  // Tiles pfrom doesn't know have nothing to give.
+  bitplane_iterate(*pfrom->tile_known, nullptr, index)
   {
-    give_tile_info_from_player_to_player(pfrom, pdest, ptile);
+    give_tile_info_from_player_to_player(pfrom, pdest,
+                                         index_to_tile(&(wld.map), index));
   }
-  whole_map_iterate_end;
+  bitplane_iterate_end;
 
   unbuffer_shared_vision(pdest);
   city_thaw_workers_queue();
@@ -395,13 +446,15 @@ void give_seamap_from_player_to_player(struct player *pfrom,
 {
   buffer_shared_vision(pdest);
 
-  whole_map_iterate(&(wld.map), ptile)
+  bitplane_iterate(*pfrom->tile_known, nullptr, index)
   {
+    struct tile *ptile = index_to_tile(&(wld.map), index);
+
     if (is_ocean_tile(ptile)) {
       give_tile_info_from_player_to_player(pfrom, pdest, ptile);
     }
   }
-  whole_map_iterate_end;
+  bitplane_iterate_end;
 
   unbuffer_shared_vision(pdest);
   city_thaw_workers_queue();
@@ -469,6 +522,138 @@ void send_all_known_tiles(struct conn_list *dest)
   flush_packets();
 }
 
+/**
+   Send the tiles pconn knows as one snapshot: the fields of the tile info
+   packets column by column, compressed and split in chunks.
+ */
+static void send_tile_snapshot(struct connection *pconn)
+{
+  const struct player *pplayer = pconn->playing;
+  struct packet_tile_info info;
+  struct packet_tile_snapshot packet;
+  QByteArray tiles, known, continent, owner, extras_owner, worked, terrain,
+      resource, extras, placing, place_turn, strings;
+  QDataStream tiles_out(&tiles, QIODevice::WriteOnly);
+  QDataStream known_out(&known, QIODevice::WriteOnly);
+  QDataStream continent_out(&continent, QIODevice::WriteOnly);
+  QDataStream owner_out(&owner, QIODevice::WriteOnly);
+  QDataStream extras_owner_out(&extras_owner, QIODevice::WriteOnly);
+  QDataStream worked_out(&worked, QIODevice::WriteOnly);
+  QDataStream terrain_out(&terrain, QIODevice::WriteOnly);
+  QDataStream resource_out(&resource, QIODevice::WriteOnly);
+  QDataStream extras_out(&extras, QIODevice::WriteOnly);
+  QDataStream placing_out(&placing, QIODevice::WriteOnly);
+  QDataStream place_turn_out(&place_turn, QIODevice::WriteOnly);
+  QDataStream strings_out(&strings, QIODevice::WriteOnly);
+  QByteArray raw, data;
+  QDataStream out(&raw, QIODevice::WriteOnly);
+  QElapsedTimer timer;
+  int count = 0, last = -1, chunks = 0;
+
+  timer.start();
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    if (!package_tile_info(&info, ptile, pplayer, false)) {
+      continue;
+    }
+
+    // Gaps between the known tiles, mostly 0
+    tiles_out << quint32(info.tile - last - 1);
+    last = info.tile;
+    known_out << quint8(info.known);
+    continent_out << qint16(info.continent);
+    owner_out << quint16(info.owner);
+    extras_owner_out << quint16(info.extras_owner);
+    worked_out << quint16(info.worked);
+    terrain_out << quint8(info.terrain);
+    resource_out << quint8(info.resource);
+    extras_out.writeRawData(reinterpret_cast<const char *>(info.extras.vec),
+                            sizeof(info.extras.vec));
+    placing_out << qint8(info.placing);
+    place_turn_out << qint16(info.place_turn);
+    // Few tiles have a label or a special sprite
+    if (info.label[0] != '\0' || info.spec_sprite[0] != '\0') {
+      strings_out << quint32(count) << QByteArray(info.label)
+                  << QByteArray(info.spec_sprite);
+    }
+    count++;
+  }
+  whole_map_iterate_end;
+
+  out << quint8(TILE_SNAPSHOT_VERSION) << quint32(count);
+  for (const auto &column :
+       {tiles, known, continent, owner, extras_owner, worked, terrain,
+        resource, extras, placing, place_turn, strings}) {
+    out << column;
+  }
+  data = qCompress(raw);
+
+  connection_do_buffer(pconn);
+  packet.total_length = data.size();
+  for (packet.offset = 0; packet.offset < data.size();
+       packet.offset += packet.chunk_length) {
+    packet.chunk_length =
+        MIN(TILE_SNAPSHOT_CHUNK_SIZE, data.size() - packet.offset);
+    memcpy(packet.data, data.constData() + packet.offset,
+           packet.chunk_length);
+    send_packet_tile_snapshot(pconn, &packet);
+
+    // Don't let the send buffer overflow, see send_all_known_tiles()
+    if (++chunks % 16 == 0) {
+      connection_do_unbuffer(pconn);
+      flush_packets();
+      connection_do_buffer(pconn);
+    }
+  }
+  connection_do_unbuffer(pconn);
+  flush_packets();
+
+  log_time(QStringLiteral("Tile snapshot for %1: %2 tiles, %3 of %4 bytes "
+                          "in %5 ms")
+               .arg(conn_description(pconn))
+               .arg(count)
+               .arg(data.size())
+               .arg(raw.size())
+               .arg(timer.elapsed()));
+}
+
+/**
+   Send all the tiles known by the connections of dest on joining a game.
+   Clients with the "tile-snapshot" capability get them in bulk through
+   send_tile_snapshot(), the others tile by tile.
+
+   The tile info delta cache of the connections must be empty, as it is
+   after conn_reset_delta_state(): the snapshot bypasses it.
+ */
+void send_all_known_tiles_snapshot(struct conn_list *dest)
+{
+  struct conn_list *legacy = conn_list_new();
+
+  if (send_tile_suppressed) {
+    conn_list_destroy(legacy);
+    return;
+  }
+
+  conn_list_iterate(dest, pconn)
+  {
+    if (nullptr == pconn->playing && !pconn->observer) {
+      continue;
+    }
+    if (has_capability("tile-snapshot", pconn->capability)) {
+      send_tile_snapshot(pconn);
+    } else {
+      conn_list_append(legacy, pconn);
+    }
+  }
+  conn_list_iterate_end;
+
+  if (conn_list_size(legacy) > 0) {
+    send_all_known_tiles(legacy);
+  }
+  conn_list_destroy(legacy);
+}
+
 /**
    Suppress send_tile_info() during game_load()
  */
@@ -480,6 +665,118 @@ bool send_tile_suppression(bool now)
   return formerly;
 }
 
+/**
+   Fill the tile info packet of ptile as pplayer knows it, or as it is for
+   global observers if pplayer is nullptr. Returns FALSE if the player
+   doesn't know the tile, unless send_unknown is set.
+ */
+static bool package_tile_info(struct packet_tile_info *info,
+                              const struct tile *ptile,
+                              const struct player *pplayer,
+                              bool send_unknown)
+{
+  const struct player *owner;
+  const struct player *eowner;
+
+  info->tile = tile_index(ptile);
+
+  if (ptile->spec_sprite) {
+    sz_strlcpy(info->spec_sprite, ptile->spec_sprite);
+  } else {
+    info->spec_sprite[0] = '\0';
+  }
+
+  if (!pplayer || map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
+    info->known = TILE_KNOWN_SEEN;
+    info->continent = tile_continent(ptile);
+    owner = tile_owner(ptile);
+    eowner = extra_owner(ptile);
+    info->owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+    info->extras_owner =
+        (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
+    info->worked = (nullptr != tile_worked(ptile)) ? tile_worked(ptile)->id
+                                                   : IDENTITY_NUMBER_ZERO;
+
+    info->terrain = (nullptr != tile_terrain(ptile))
+                        ? terrain_number(tile_terrain(ptile))
+                        : terrain_count();
+    info->resource = (nullptr != tile_resource(ptile))
+                         ? extra_number(tile_resource(ptile))
+                         : MAX_EXTRA_TYPES;
+    info->placing =
+        (nullptr != ptile->placing) ? extra_number(ptile->placing) : -1;
+    info->place_turn = (nullptr != ptile->placing)
+                           ? game.info.turn + ptile->infra_turns
+                           : 0;
+
+    if (pplayer != nullptr) {
+      info->extras = map_get_player_tile(ptile, pplayer)->state->extras;
+    } else {
+      info->extras = ptile->extras;
+    }
+
+    if (ptile->label != nullptr) {
+      // Always leave final '/* Always leave final '\0' in place */' in
+      // place
+      qstrncpy(info->label, ptile->label, sizeof(info->label) - 1);
+    } else {
+      info->label[0] = '\0';
+    }
+  } else if (pplayer && map_is_known(ptile, pplayer)) {
+    const struct player_tile_state *plrstate =
+        map_get_player_tile(ptile, pplayer)->state.get();
+    const vision_site *psite = map_get_player_site(ptile, pplayer);
+
+    info->known = TILE_KNOWN_UNSEEN;
+    info->continent = tile_continent(ptile);
+    owner =
+        (game.server.foggedborders ? plrstate->owner : tile_owner(ptile));
+    eowner = plrstate->extras_owner;
+    info->owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+    info->extras_owner =
+        (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
+    info->worked =
+        (nullptr != psite) ? psite->identity : IDENTITY_NUMBER_ZERO;
+
+    info->terrain = (nullptr != plrstate->terrain)
+                        ? terrain_number(plrstate->terrain)
+                        : terrain_count();
+    info->resource = (nullptr != plrstate->resource)
+                         ? extra_number(plrstate->resource)
+                         : MAX_EXTRA_TYPES;
+    info->placing = -1;
+    info->place_turn = 0;
+
+    info->extras = plrstate->extras;
+
+    // Labels never change, so they are not subject to fog of war
+    if (ptile->label != nullptr) {
+      sz_strlcpy(info->label, ptile->label);
+    } else {
+      info->label[0] = '\0';
+    }
+  } else if (send_unknown) {
+    info->known = TILE_UNKNOWN;
+    info->continent = 0;
+    info->owner = MAP_TILE_OWNER_NULL;
+    info->extras_owner = MAP_TILE_OWNER_NULL;
+    info->worked = IDENTITY_NUMBER_ZERO;
+
+    info->terrain = terrain_count();
+    info->resource = MAX_EXTRA_TYPES;
+    info->placing = -1;
+    info->place_turn = 0;
+
+    BV_CLR_ALL(info->extras);
+
+    info->label[0] = '\0';
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
 /**
    Send tile information to all the clients in dest which know and see
    the tile. If dest is nullptr, sends to all clients (game.est_connections)
@@ -492,8 +789,6 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
                     bool send_unknown)
 {
   struct packet_tile_info info;
-  const struct player *owner;
-  const struct player *eowner;
 
   if (dest == nullptr) {
     CALL_FUNC_EACH_AI(tile_info, ptile);
@@ -507,14 +802,6 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
     dest = game.est_connections;
   }
 
-  info.tile = tile_index(ptile);
-
-  if (ptile->spec_sprite) {
-    sz_strlcpy(info.spec_sprite, ptile->spec_sprite);
-  } else {
-    info.spec_sprite[0] = '\0';
-  }
-
   conn_list_iterate(dest, pconn)
   {
     struct player *pplayer = pconn->playing;
@@ -523,94 +810,7 @@ void send_tile_info(struct conn_list *dest, struct tile *ptile,
       continue;
     }
 
-    if (!pplayer || map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
-      info.known = TILE_KNOWN_SEEN;
-      info.continent = tile_continent(ptile);
-      owner = tile_owner(ptile);
-      eowner = extra_owner(ptile);
-      info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
-      info.extras_owner =
-          (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
-      info.worked = (nullptr != tile_worked(ptile)) ? tile_worked(ptile)->id
-                                                    : IDENTITY_NUMBER_ZERO;
-
-      info.terrain = (nullptr != tile_terrain(ptile))
-                         ? terrain_number(tile_terrain(ptile))
-                         : terrain_count();
-      info.resource = (nullptr != tile_resource(ptile))
-                          ? extra_number(tile_resource(ptile))
-                          : MAX_EXTRA_TYPES;
-      info.placing =
-          (nullptr != ptile->placing) ? extra_number(ptile->placing) : -1;
-      info.place_turn = (nullptr != ptile->placing)
-                            ? game.info.turn + ptile->infra_turns
-                            : 0;
-
-      if (pplayer != nullptr) {
-        info.extras = map_get_player_tile(ptile, pplayer)->extras;
-      } else {
-        info.extras = ptile->extras;
-      }
-
-      if (ptile->label != nullptr) {
-        // Always leave final '/* Always leave final '\0' in place */' in
-        // place
-        qstrncpy(info.label, ptile->label, sizeof(info.label) - 1);
-      } else {
-        info.label[0] = '\0';
-      }
-
-      send_packet_tile_info(pconn, &info);
-    } else if (pplayer && map_is_known(ptile, pplayer)) {
-      struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-      const vision_site *psite = map_get_player_site(ptile, pplayer);
-
-      info.known = TILE_KNOWN_UNSEEN;
-      info.continent = tile_continent(ptile);
-      owner =
-          (game.server.foggedborders ? plrtile->owner : tile_owner(ptile));
-      eowner = plrtile->extras_owner;
-      info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
-      info.extras_owner =
-          (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
-      info.worked =
-          (nullptr != psite) ? psite->identity : IDENTITY_NUMBER_ZERO;
-
-      info.terrain = (nullptr != plrtile->terrain)
-                         ? terrain_number(plrtile->terrain)
-                         : terrain_count();
-      info.resource = (nullptr != plrtile->resource)
-                          ? extra_number(plrtile->resource)
-                          : MAX_EXTRA_TYPES;
-      info.placing = -1;
-      info.place_turn = 0;
-
-      info.extras = plrtile->extras;
-
-      // Labels never change, so they are not subject to fog of war
-      if (ptile->label != nullptr) {
-        sz_strlcpy(info.label, ptile->label);
-      } else {
-        info.label[0] = '\0';
-      }
-
-      send_packet_tile_info(pconn, &info);
-    } else if (send_unknown) {
-      info.known = TILE_UNKNOWN;
-      info.continent = 0;
-      info.owner = MAP_TILE_OWNER_NULL;
-      info.extras_owner = MAP_TILE_OWNER_NULL;
-      info.worked = IDENTITY_NUMBER_ZERO;
-
-      info.terrain = terrain_count();
-      info.resource = MAX_EXTRA_TYPES;
-      info.placing = -1;
-      info.place_turn = 0;
-
-      BV_CLR_ALL(info.extras);
-
-      info.label[0] = '\0';
-
+    if (package_tile_info(&info, ptile, pplayer, send_unknown)) {
       send_packet_tile_info(pconn, &info);
     }
   }
@@ -893,6 +1093,28 @@ bool map_is_known(const struct tile *ptile, const struct player *pplayer)
          && pplayer->tile_known->at(tile_index(ptile));
 }
 
+/**
+   Returns the bits base to base + 63 of a tile bit plane such as
+   tile_known as one word, bit 0 being tile base. Bits past the end of the
+   plane are zero.
+ */
+quint64 bitplane_word(const QBitArray &plane, int base)
+{
+  const uchar *bits =
+      reinterpret_cast<const uchar *>(plane.bits()) + base / 8;
+  int left = plane.size() - base;
+  quint64 word = 0;
+
+  if (left >= 64) {
+    return qFromLittleEndian<quint64>(bits);
+  }
+  for (int i = 0; i < (left + 7) / 8; i++) {
+    word |= quint64(bits[i]) << (8 * i);
+  }
+
+  return word & ((quint64(1) << left) - 1);
+}
+
 /**
    Returns whether the layer 'vlayer' of the tile 'ptile' is known and seen
    by the player 'pplayer'.
@@ -995,6 +1217,8 @@ void map_change_seen(struct player *pplayer, struct tile *ptile,
     plrtile->seen_count[v] += change[v];
   }
   vision_layer_iterate_end;
+  pplayer->server.tile_seen->setBit(tile_index(ptile),
+                                    0 < plrtile->seen_count[V_MAIN]);
 
   /* V_MAIN vision ranges must always be more than invisible ranges
    * (see comment in common/vision.h), so we assume that the V_MAIN
@@ -1021,14 +1245,17 @@ void map_change_seen(struct player *pplayer, struct tile *ptile,
 
   // Fog the tile.
   if (0 > change[V_MAIN] && 0 == plrtile->seen_count[V_MAIN]) {
+    struct player_tile_state fogged = *plrtile->state;
+
     log_debug("(%d, %d): fogging tile for player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
     update_player_tile_last_seen(pplayer, ptile);
     if (game.server.foggedborders) {
-      plrtile->owner = tile_owner(ptile);
+      fogged.owner = tile_owner(ptile);
     }
-    plrtile->extras_owner = extra_owner(ptile);
+    fogged.extras_owner = extra_owner(ptile);
+    player_tile_share(ptile, plrtile, fogged);
     send_tile_info(pplayer->connections, ptile, false);
   }
 
@@ -1138,7 +1365,10 @@ void change_playertile_site(struct player_tile *ptile,
  */
 void map_set_known(struct tile *ptile, struct player *pplayer)
 {
-  pplayer->tile_known->setBit(tile_index(ptile));
+  if (!pplayer->tile_known->testBit(tile_index(ptile))) {
+    pplayer->tile_known->setBit(tile_index(ptile));
+    border_tile_changed(ptile);
+  }
 }
 
 /**
@@ -1146,7 +1376,10 @@ void map_set_known(struct tile *ptile, struct player *pplayer)
  */
 void map_clear_known(struct tile *ptile, struct player *pplayer)
 {
-  pplayer->tile_known->setBit(tile_index(ptile), false);
+  if (pplayer->tile_known->testBit(tile_index(ptile))) {
+    pplayer->tile_known->setBit(tile_index(ptile), false);
+    border_tile_changed(ptile);
+  }
 }
 
 /**
@@ -1189,6 +1422,10 @@ void player_map_init(struct player *pplayer)
   whole_map_iterate_end;
 
   pplayer->tile_known->resize(MAP_INDEX_SIZE);
+  // Matches the seen counts set up by player_tile_init().
+  delete pplayer->server.tile_seen;
+  pplayer->server.tile_seen =
+      new QBitArray(MAP_INDEX_SIZE, !game.server.fogofwar_old);
 }
 
 /**
@@ -1205,7 +1442,21 @@ void player_map_free(struct player *pplayer)
 
   delete[] pplayer->server.private_map;
   pplayer->server.private_map = nullptr;
+  delete pplayer->server.tile_seen;
+  pplayer->server.tile_seen = nullptr;
   pplayer->tile_known->clear();
+
+  /* The shared states refer to terrains and players of this game; drop
+   * them with the last private map. */
+  players_iterate(aplayer)
+  {
+    if (aplayer->server.private_map) {
+      return;
+    }
+  }
+  players_iterate_end;
+  shared_states.clear();
+  shared_states.shrink_to_fit();
 }
 
 /**
@@ -1241,12 +1492,12 @@ void remove_player_from_maps(struct player *pplayer)
       }
 
       // Remove references to player from others' maps
-      if (aplrtile->owner == pplayer) {
-        aplrtile->owner = nullptr;
+      if (aplrtile->state->owner == pplayer) {
+        player_tile_edit(aplrtile)->owner = nullptr;
         changed = true;
       }
-      if (aplrtile->extras_owner == pplayer) {
-        aplrtile->extras_owner = nullptr;
+      if (aplrtile->state->extras_owner == pplayer) {
+        player_tile_edit(aplrtile)->extras_owner = nullptr;
         changed = true;
       }
 
@@ -1267,6 +1518,7 @@ void remove_player_from_maps(struct player *pplayer)
     // Free all claimed tiles.
     if (tile_owner(ptile) == pplayer) {
       tile_set_owner(ptile, nullptr, nullptr);
+      border_tile_changed(ptile);
       reality_changed = true;
     }
     if (extra_owner(ptile) == pplayer) {
@@ -1289,14 +1541,13 @@ void remove_player_from_maps(struct player *pplayer)
  */
 static void player_tile_init(struct tile *ptile, struct player *pplayer)
 {
+  // Shared by all tiles nobody knows anything about.
+  static const auto unknown = std::make_shared<player_tile_state>(
+      player_tile_state{nullptr, T_UNKNOWN, nullptr, nullptr, {}});
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
 
-  plrtile->terrain = T_UNKNOWN;
-  plrtile->resource = nullptr;
-  plrtile->owner = nullptr;
-  plrtile->extras_owner = nullptr;
+  plrtile->state = unknown;
   plrtile->site = nullptr;
-  BV_CLR_ALL(plrtile->extras);
   if (!game.server.last_updated_year) {
     plrtile->last_updated = game.info.turn;
   } else {
@@ -1352,6 +1603,145 @@ struct player_tile *map_get_player_tile(const struct tile *ptile,
   return pplayer->server.private_map + tile_index(ptile);
 }
 
+/**
+   Returns whether two remembered tile states are the same.
+ */
+static bool player_tile_state_equal(const struct player_tile_state &a,
+                                    const struct player_tile_state &b)
+{
+  return a.terrain == b.terrain && a.resource == b.resource
+         && a.owner == b.owner && a.extras_owner == b.extras_owner
+         && BV_ARE_EQUAL(a.extras, b.extras);
+}
+
+/**
+   Makes the player tile remember 'state'. The state most recently shared
+   for each tile is kept, so players who see the same tile end up pointing
+   at one copy instead of each holding their own.
+ */
+static void player_tile_share(const struct tile *ptile,
+                              struct player_tile *plrtile,
+                              const struct player_tile_state &state)
+{
+  if (shared_states.size() != size_t(MAP_INDEX_SIZE)) {
+    shared_states.assign(MAP_INDEX_SIZE, nullptr);
+  }
+
+  auto &shared = shared_states[tile_index(ptile)];
+  if (shared && player_tile_state_equal(*shared, state)) {
+    plrtile->state = shared;
+  } else if (player_tile_state_equal(*plrtile->state, state)) {
+    shared = plrtile->state;
+  } else {
+    shared = std::make_shared<player_tile_state>(state);
+    plrtile->state = shared;
+  }
+}
+
+/**
+   Returns the state of the player tile for modification, copying it first
+   if it is shared. Different tiles may be edited from different threads.
+ */
+struct player_tile_state *player_tile_edit(struct player_tile *plrtile)
+{
+  if (plrtile->state.use_count() > 1) {
+    plrtile->state = std::make_shared<player_tile_state>(*plrtile->state);
+  }
+
+  return plrtile->state.get();
+}
+
+/**
+   Shares equal tile states between all private maps after they were
+   loaded from a savegame tile by tile. During the game, states are shared
+   as they change.
+ */
+void player_maps_compact()
+{
+  QElapsedTimer timer;
+
+  timer.start();
+  if (shared_states.size() != size_t(MAP_INDEX_SIZE)) {
+    shared_states.assign(MAP_INDEX_SIZE, nullptr);
+  }
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    players_iterate(pplayer)
+    {
+      struct player_tile *plrtile;
+
+      if (!pplayer->server.private_map) {
+        continue;
+      }
+      plrtile = map_get_player_tile(ptile, pplayer);
+      player_tile_share(ptile, plrtile, player_tile_state(*plrtile->state));
+    }
+    players_iterate_end;
+
+    // Don't keep a state alive that no player remembers any more.
+    auto &shared = shared_states[tile_index(ptile)];
+    if (shared && shared.use_count() == 1) {
+      shared.reset();
+    }
+  }
+  whole_map_iterate_end;
+
+  qCDebug(timers_category, "Player maps compacted in %lld ms.",
+          static_cast<long long>(timer.elapsed()));
+  player_maps_log_memory();
+}
+
+/**
+   Logs how much memory sharing the tile states of the private maps saves
+   compared to every player tile holding its own state. This walks all
+   private maps, so it is only done when timer messages are enabled.
+ */
+void player_maps_log_memory()
+{
+  const long long state_size = sizeof(struct player_tile_state);
+  const long long pointer_size = sizeof(std::shared_ptr<player_tile_state>);
+  /* make_shared() puts the state next to a use count, a weak count and a
+   * vtable pointer. Allocator overhead is not included. */
+  const long long block_size =
+      state_size + 2 * sizeof(long) + sizeof(void *);
+  QSet<const struct player_tile_state *> states;
+  long long views = 0, saved;
+
+  if (!timers_category().isDebugEnabled()) {
+    return;
+  }
+
+  players_iterate(pplayer)
+  {
+    if (!pplayer->server.private_map) {
+      continue;
+    }
+    whole_map_iterate(&(wld.map), ptile)
+    {
+      states.insert(map_get_player_tile(ptile, pplayer)->state.get());
+      views++;
+    }
+    whole_map_iterate_end;
+  }
+  players_iterate_end;
+  // States only remembered as the last shared one of a tile.
+  for (const auto &shared : shared_states) {
+    if (shared) {
+      states.insert(shared.get());
+    }
+  }
+
+  /* Each player tile holds a pointer instead of a state. Each state is
+   * allocated once, together with its reference counts, and the last
+   * shared state of every tile is remembered. */
+  saved = views * (state_size - pointer_size) - states.size() * block_size
+          - static_cast<long long>(shared_states.size()) * pointer_size;
+
+  qCDebug(timers_category,
+          "Player maps: %lld tile views use %d states, saving %lld bytes.",
+          views, states.size(), saved);
+}
+
 /**
    Give pplayer the correct knowledge about tile; return TRUE iff
    knowledge changed.
@@ -1363,25 +1753,29 @@ struct player_tile *map_get_player_tile(const struct tile *ptile,
 bool update_player_tile_knowledge(struct player *pplayer, struct tile *ptile)
 {
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  const struct player_tile_state *plrstate = plrtile->state.get();
+
+  if (plrstate->terrain != ptile->terrain
+      || !BV_ARE_EQUAL(plrstate->extras, ptile->extras)
+      || plrstate->resource != ptile->resource
+      || plrstate->owner != tile_owner(ptile)
+      || plrstate->extras_owner != extra_owner(ptile)) {
+    struct player_tile_state seen = *plrstate;
 
-  if (plrtile->terrain != ptile->terrain
-      || !BV_ARE_EQUAL(plrtile->extras, ptile->extras)
-      || plrtile->resource != ptile->resource
-      || plrtile->owner != tile_owner(ptile)
-      || plrtile->extras_owner != extra_owner(ptile)) {
-    plrtile->terrain = ptile->terrain;
+    seen.terrain = ptile->terrain;
     extra_type_iterate(pextra)
     {
       if (player_knows_extra_exist(pplayer, pextra, ptile)) {
-        BV_SET(plrtile->extras, extra_number(pextra));
+        BV_SET(seen.extras, extra_number(pextra));
       } else {
-        BV_CLR(plrtile->extras, extra_number(pextra));
+        BV_CLR(seen.extras, extra_number(pextra));
       }
     }
     extra_type_iterate_end;
-    plrtile->resource = ptile->resource;
-    plrtile->owner = tile_owner(ptile);
-    plrtile->extras_owner = extra_owner(ptile);
+    seen.resource = ptile->resource;
+    seen.owner = tile_owner(ptile);
+    seen.extras_owner = extra_owner(ptile);
+    player_tile_share(ptile, plrtile, seen);
 
     return true;
   }
@@ -1470,11 +1864,7 @@ static void really_give_tile_info_from_player_to_player(struct player *pfrom,
 
   // Update and send tile knowledge
   map_set_known(ptile, pdest);
-  dest_tile->terrain = from_tile->terrain;
-  dest_tile->extras = from_tile->extras;
-  dest_tile->resource = from_tile->resource;
-  dest_tile->owner = from_tile->owner;
-  dest_tile->extras_owner = from_tile->extras_owner;
+  dest_tile->state = from_tile->state;
   dest_tile->last_updated = from_tile->last_updated;
   send_tile_info(pdest->connections, ptile, false);
 
@@ -1495,11 +1885,15 @@ static void really_give_tile_info_from_player_to_player(struct player *pfrom,
 static void really_give_map_from_player_to_player(struct player *pfrom,
                                                   struct player *pdest)
 {
-  whole_map_iterate(&(wld.map), ptile)
+  // Tiles pdest knows and sees are skipped right away.
+  const QBitArray skip = *pdest->tile_known & *pdest->server.tile_seen;
+
+  bitplane_iterate(*pfrom->tile_known, &skip, index)
   {
-    really_give_tile_info_from_player_to_player(pfrom, pdest, ptile);
+    really_give_tile_info_from_player_to_player(
+        pfrom, pdest, index_to_tile(&(wld.map), index));
   }
-  whole_map_iterate_end;
+  bitplane_iterate_end;
 
   city_thaw_workers_queue();
   sync_cities();
@@ -1883,6 +2277,8 @@ void check_terrain_change(struct tile *ptile, struct terrain *oldter)
   struct terrain *newter = tile_terrain(ptile);
   struct tile *claimer;
 
+  border_tile_changed(ptile);
+
   /* Check if new terrain is a freshwater terrain next to non-freshwater.
    * In that case, the new terrain is *changed*. */
   if (is_ocean(newter) && terrain_has_flag(newter, TER_FRESHWATER)) {
@@ -2052,6 +2448,7 @@ static void map_claim_border_ownership(struct tile *ptile,
   }
 
   tile_set_owner(ptile, powner, psource);
+  border_tile_changed(ptile);
 
   /* Needed only when foggedborders enabled, but we do it unconditionally
    * in case foggedborders ever gets enabled later. Better to have correct
@@ -2244,11 +2641,112 @@ void map_claim_border(struct tile *ptile, struct player *owner,
   circle_dxyr_iterate_end;
 }
 
+/**
+   Record that something border claiming depends on changed at the tile.
+ */
+static void border_tile_changed(const struct tile *ptile)
+{
+  // The size check catches a new map before the cache is invalidated.
+  if (border_cache.valid
+      && size_t(tile_index(ptile)) < border_cache.tile_gen.size()) {
+    border_cache.tile_gen[tile_index(ptile)] = ++border_cache.gen;
+  }
+}
+
+/**
+   Record a change at every tile within the radius of a border source.
+ */
+static void border_area_changed(struct tile *center, int radius_sq)
+{
+  circle_iterate(&(wld.map), center, radius_sq, ptile)
+  {
+    border_tile_changed(ptile);
+  }
+  circle_iterate_end;
+}
+
+/**
+   Get the current state of the border source at the tile. The generation
+   is left at 0.
+ */
+static struct border_source_state
+border_source_state_get(struct tile *ptile)
+{
+  struct border_source_state state;
+  const struct city *pcity = tile_city(ptile);
+
+  state.owner = tile_owner(ptile);
+  state.radius_sq = tile_border_source_radius_sq(ptile);
+  state.strength = tile_border_source_strength(ptile);
+  state.city_radius_sq =
+      (pcity != nullptr ? city_map_radius_sq_get(pcity) : -1);
+  state.claim_ocean =
+      (state.owner != nullptr
+       && num_known_tech_with_flag(state.owner, TF_CLAIM_OCEAN) > 0);
+  state.claim_ocean_limited =
+      (state.owner != nullptr
+       && num_known_tech_with_flag(state.owner, TF_CLAIM_OCEAN_LIMITED)
+              > 0);
+  state.gen = 0;
+
+  return state;
+}
+
+/**
+   Whether two states of a border source claim the same tiles.
+ */
+static bool border_source_state_equal(const struct border_source_state &a,
+                                      const struct border_source_state &b)
+{
+  return a.owner == b.owner && a.radius_sq == b.radius_sq
+         && a.strength == b.strength && a.city_radius_sq == b.city_radius_sq
+         && a.claim_ocean == b.claim_ocean
+         && a.claim_ocean_limited == b.claim_ocean_limited;
+}
+
+/**
+   Whether running map_claim_border() for the source could change anything
+   since its last run.
+ */
+static bool
+border_source_needs_update(struct tile *ptile,
+                           const struct border_source_state &state)
+{
+  if (state.gen == 0) {
+    return true;
+  }
+
+  circle_iterate(&(wld.map), ptile, state.radius_sq, dtile)
+  {
+    if (border_cache.tile_gen[tile_index(dtile)] > state.gen) {
+      return true;
+    }
+  }
+  circle_iterate_end;
+
+  return false;
+}
+
+/**
+   Make the next map_calculate_borders() recompute all border sources. Call
+   this after changes that are not tracked per tile, such as continent
+   renumbering or loading a game.
+ */
+void map_borders_invalidate() { border_cache.valid = false; }
+
 /**
    Update borders for all sources. Call this on turn end.
+
+   Only the sources that are affected by changes since the last call are
+   recomputed. The sources are processed in the same order as a full pass,
+   so the result is the same.
  */
 void map_calculate_borders()
 {
+  QHash<int, struct border_source_state> current;
+  QElapsedTimer timer;
+  int nsources = 0, nupdated = 0;
+
   if (BORDERS_DISABLED == game.info.borders) {
     return;
   }
@@ -2259,15 +2757,79 @@ void map_calculate_borders()
   }
 
   qDebug("map_calculate_borders()");
+  timer.start();
+
+  if (!border_cache.valid
+      || border_cache.tile_gen.size() != size_t(MAP_INDEX_SIZE)) {
+    border_cache.tile_gen.assign(MAP_INDEX_SIZE, 0);
+    border_cache.sources.clear();
+    border_cache.gen = 0;
+    border_cache.valid = true;
+  }
 
+  /* Sources that appeared, disappeared or changed make all tiles they may
+   * have claimed dirty, including for the other sources around them. */
   whole_map_iterate(&(wld.map), ptile)
   {
     if (is_border_source(ptile)) {
+      struct border_source_state state = border_source_state_get(ptile);
+      auto old = border_cache.sources.constFind(tile_index(ptile));
+
+      if (old == border_cache.sources.constEnd()) {
+        border_area_changed(ptile, state.radius_sq);
+      } else if (!border_source_state_equal(*old, state)) {
+        border_area_changed(ptile, MAX(old->radius_sq, state.radius_sq));
+        state.gen = old->gen;
+      } else {
+        state.gen = old->gen;
+      }
+      current.insert(tile_index(ptile), state);
+    }
+  }
+  whole_map_iterate_end;
+
+  for (auto it = border_cache.sources.constBegin();
+       it != border_cache.sources.constEnd(); ++it) {
+    if (!current.contains(it.key())) {
+      border_area_changed(index_to_tile(&(wld.map), it.key()),
+                          it->radius_sq);
+    }
+  }
+  border_cache.sources = current;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    if (is_border_source(ptile)) {
+      auto it = border_cache.sources.find(tile_index(ptile));
+      struct border_source_state state;
+
+      // Claiming bases can create new sources during the pass.
+      if (it == border_cache.sources.end()) {
+        it = border_cache.sources.insert(tile_index(ptile),
+                                         border_source_state_get(ptile));
+      }
+
+      nsources++;
+      if (!border_source_needs_update(ptile, *it)) {
+        continue;
+      }
+
       map_claim_border(ptile, ptile->owner, -1);
+      nupdated++;
+
+      state = border_source_state_get(ptile);
+      state.gen = border_cache.gen;
+      *it = state;
     }
   }
   whole_map_iterate_end;
 
+  log_time(QStringLiteral("Borders: %1 of %2 sources updated in %3 "
+                          "milliseconds")
+               .arg(nupdated)
+               .arg(nsources)
+               .arg(timer.elapsed()));
+
   qDebug("map_calculate_borders() workers");
   city_thaw_workers_queue();
   city_refresh_queue_processing();
@@ -2405,6 +2967,177 @@ void vision_clear_sight(struct vision *vision)
   vision_change_sight(vision, vision_radius_sq);
 }
 
+/* Units of one player moving with the same vision radii between the same
+ * tiles. Their vision is changed only once, by 'count'. */
+struct vision_move_group {
+  struct player *pplayer;
+  struct tile *psrctile;
+  struct tile *pdesttile;
+  v_radius_t old_radius_sq;
+  v_radius_t new_radius_sq;
+  bool can_reveal_tiles;
+  int count;
+};
+
+struct vision_move_change {
+  v_radius_t change;
+};
+
+struct vision_move {
+  std::vector<struct vision_move_group> groups;
+  // Indexed by the can_reveal_tiles flag of the visions.
+  QHash<struct player *, QHash<struct tile *, struct vision_move_change>>
+      changes[2];
+};
+
+/**
+   Create a batched vision change for units moving together. The visions
+   are moved with vision_move_add(), then the newly seen tiles are
+   revealed by vision_move_reveal() and the tiles no longer seen are
+   fogged by vision_move_finish(). Tiles seen both before and after the
+   move are not touched at all.
+ */
+struct vision_move *vision_move_new() { return new vision_move; }
+
+/**
+   Add a unit vision moving from 'old_vision' to 'new_vision' with the
+   radius 'new_radius_sq'. The radius of both visions is updated at once,
+   but the map is only updated by vision_move_reveal() and
+   vision_move_finish(). 'new_vision' must not have any radius yet.
+ */
+void vision_move_add(struct vision_move *pmove, struct vision *old_vision,
+                     struct vision *new_vision,
+                     const v_radius_t new_radius_sq)
+{
+  const v_radius_t cleared_sq = V_RADIUS(-1, -1, -1);
+
+  fc_assert_ret(old_vision->player == new_vision->player);
+  fc_assert(new_vision->radius_sq[V_MAIN] == -1);
+
+  for (auto &group : pmove->groups) {
+    if (group.pplayer == new_vision->player
+        && group.psrctile == old_vision->tile
+        && group.pdesttile == new_vision->tile
+        && group.can_reveal_tiles == new_vision->can_reveal_tiles
+        && 0 == memcmp(group.old_radius_sq, old_vision->radius_sq,
+                       sizeof(v_radius_t))
+        && 0 == memcmp(group.new_radius_sq, new_radius_sq,
+                       sizeof(v_radius_t))) {
+      group.count++;
+      memcpy(new_vision->radius_sq, new_radius_sq, sizeof(v_radius_t));
+      memcpy(old_vision->radius_sq, cleared_sq, sizeof(v_radius_t));
+      return;
+    }
+  }
+
+  pmove->groups.push_back({new_vision->player, old_vision->tile,
+                           new_vision->tile, {}, {},
+                           new_vision->can_reveal_tiles, 1});
+  memcpy(pmove->groups.back().old_radius_sq, old_vision->radius_sq,
+         sizeof(v_radius_t));
+  memcpy(pmove->groups.back().new_radius_sq, new_radius_sq,
+         sizeof(v_radius_t));
+  memcpy(new_vision->radius_sq, new_radius_sq, sizeof(v_radius_t));
+  memcpy(old_vision->radius_sq, cleared_sq, sizeof(v_radius_t));
+}
+
+/**
+   Add 'count' times the vision of radius 'radius_sq' at 'ptile' to the
+   vision changes of the player.
+ */
+static void vision_move_changes(
+    QHash<struct tile *, struct vision_move_change> &changes,
+    struct tile *ptile, const v_radius_t radius_sq, int count)
+{
+  int max_radius = MAX(radius_sq[V_MAIN],
+                       MAX(radius_sq[V_INVIS], radius_sq[V_SUBSURFACE]));
+
+  if (max_radius < 0) {
+    return;
+  }
+
+  circle_dxyr_iterate(&(wld.map), ptile, max_radius, tile1, dx, dy, dr)
+  {
+    auto it = changes.find(tile1);
+
+    if (it == changes.end()) {
+      it = changes.insert(tile1, {{0, 0, 0}});
+    }
+    vision_layer_iterate(v)
+    {
+      if (dr <= radius_sq[v]) {
+        it->change[v] += count;
+      }
+    }
+    vision_layer_iterate_end;
+  }
+  circle_dxyr_iterate_end;
+}
+
+/**
+   Apply the part of the vision changes going in one direction: the
+   increases if 'increase' is set, else the decreases. As in
+   vision_change_sight(), each change is made with the can_reveal_tiles
+   flag of the visions it comes from.
+ */
+static void vision_move_apply(struct vision_move *pmove, bool increase)
+{
+  for (int can_reveal = 0; can_reveal < 2; can_reveal++) {
+    auto &changes = pmove->changes[can_reveal];
+
+    for (auto it = changes.begin(); it != changes.end(); ++it) {
+      struct player *pplayer = it.key();
+
+      buffer_shared_vision(pplayer);
+      for (auto tit = it->begin(); tit != it->end(); ++tit) {
+        v_radius_t change;
+        bool any = false;
+
+        vision_layer_iterate(v)
+        {
+          change[v] = (increase ? MAX(0, tit->change[v])
+                                : MIN(0, tit->change[v]));
+          any = any || change[v] != 0;
+        }
+        vision_layer_iterate_end;
+
+        if (any) {
+          shared_vision_change_seen(pplayer, tit.key(), change,
+                                    can_reveal != 0);
+        }
+      }
+      unbuffer_shared_vision(pplayer);
+    }
+  }
+}
+
+/**
+   Reveal the tiles seen by the moved visions that were not seen before.
+ */
+void vision_move_reveal(struct vision_move *pmove)
+{
+  for (const auto &group : pmove->groups) {
+    auto &changes =
+        pmove->changes[group.can_reveal_tiles ? 1 : 0][group.pplayer];
+
+    vision_move_changes(changes, group.pdesttile, group.new_radius_sq,
+                        group.count);
+    vision_move_changes(changes, group.psrctile, group.old_radius_sq,
+                        -group.count);
+  }
+
+  vision_move_apply(pmove, true);
+}
+
+/**
+   Fog the tiles no longer seen by the moved visions and free the batch.
+ */
+void vision_move_finish(struct vision_move *pmove)
+{
+  vision_move_apply(pmove, false);
+  delete pmove;
+}
+
 /**
    Create extra to tile.
  */
@@ -12,6 +12,12 @@
       \____/        ********************************************************/
 #pragma once
 
+// Qt
+#include <QBitArray>
+#include <QtAlgorithms>
+
+#include <memory>
+
 #include "fc_types.h"
 
 #include "map.h"
@@ -24,13 +30,21 @@
 struct section_file;
 struct conn_list;
 
-struct player_tile {
-  std::unique_ptr<vision_site> site; // nullptr for no vision site
-  struct extra_type *resource;       // nullptr for no resource
-  struct terrain *terrain;           // nullptr for unknown tiles
-  struct player *owner;              // nullptr for unowned
+/* What a player remembers of a tile. Most of the time it is the same
+ * for many players (everybody who saw the tile since it last changed, or
+ * nobody knows it), so these are shared between player tiles and must not
+ * be modified in place: use player_tile_edit(). */
+struct player_tile_state {
+  struct extra_type *resource; // nullptr for no resource
+  struct terrain *terrain;     // nullptr for unknown tiles
+  struct player *owner;        // nullptr for unowned
   struct player *extras_owner;
   bv_extras extras;
+};
+
+struct player_tile {
+  std::unique_ptr<vision_site> site; // nullptr for no vision site
+  std::shared_ptr<player_tile_state> state; // Never nullptr
 
   /* If you build a city with an unknown square within city radius
      the square stays unknown. However, we still have to keep count
@@ -41,6 +55,30 @@ struct player_tile {
   short last_updated;
 };
 
+/*
+ * Iterates over the index of every bit set in the bit plane 'plane' but
+ * not in '*exclude' (exclude may be nullptr). The planes are read one
+ * 64-bit word at a time, so long runs of unset bits are skipped cheaply.
+ * The plane is copied (shallowly) first and may be changed in the body.
+ */
+#define bitplane_iterate(plane, exclude, _index)                            \
+  {                                                                         \
+    const QBitArray _bp_plane = (plane);                                    \
+    const QBitArray *_bp_exclude = (exclude);                               \
+    for (int _bp_base = 0; _bp_base < _bp_plane.size(); _bp_base += 64) {   \
+      quint64 _bp_word = bitplane_word(_bp_plane, _bp_base);                \
+      if (nullptr != _bp_exclude) {                                         \
+        _bp_word &= ~bitplane_word(*_bp_exclude, _bp_base);                 \
+      }                                                                     \
+      while (0 != _bp_word) {                                               \
+        const int _index = _bp_base + qCountTrailingZeroBits(_bp_word);     \
+        _bp_word &= _bp_word - 1;
+
+#define bitplane_iterate_end                                                \
+  }                                                                         \
+  }                                                                         \
+  }
+
 void global_warming(int effect);
 void nuclear_winter(int effect);
 void climate_change(bool warming, int effect);
@@ -55,6 +93,7 @@ void give_citymap_from_player_to_player(struct city *pcity,
                                         struct player *pfrom,
                                         struct player *pdest);
 void send_all_known_tiles(struct conn_list *dest);
+void send_all_known_tiles_snapshot(struct conn_list *dest);
 
 bool send_tile_suppression(bool now);
 void send_tile_info(struct conn_list *dest, struct tile *ptile,
@@ -77,6 +116,7 @@ bool map_is_known_and_seen(const struct tile *ptile,
                            const struct player *pplayer,
                            enum vision_layer vlayer);
 bool map_is_known(const struct tile *ptile, const struct player *pplayer);
+quint64 bitplane_word(const QBitArray &plane, int base);
 void map_set_known(struct tile *ptile, struct player *pplayer);
 void map_clear_known(struct tile *ptile, struct player *pplayer);
 void map_know_and_see_all(struct player *pplayer);
@@ -92,6 +132,9 @@ struct vision_site *map_get_player_site(const struct tile *ptile,
                                         const struct player *pplayer);
 struct player_tile *map_get_player_tile(const struct tile *ptile,
                                         const struct player *pplayer);
+struct player_tile_state *player_tile_edit(struct player_tile *plrtile);
+void player_maps_compact();
+void player_maps_log_memory();
 bool update_player_tile_knowledge(struct player *pplayer,
                                   struct tile *ptile);
 void update_tile_knowledge(struct tile *ptile);
@@ -108,6 +151,7 @@ void enable_fog_of_war_player(struct player *pplayer);
 void disable_fog_of_war_player(struct player *pplayer);
 
 void map_calculate_borders();
+void map_borders_invalidate();
 void map_claim_border(struct tile *ptile, struct player *powner,
                       int radius_sq);
 void map_claim_ownership(struct tile *ptile, struct player *powner,
@@ -131,6 +175,14 @@ void bounce_units_on_terrain_change(struct tile *ptile);
 void vision_change_sight(struct vision *vision, const v_radius_t radius_sq);
 void vision_clear_sight(struct vision *vision);
 
+struct vision_move;
+struct vision_move *vision_move_new();
+void vision_move_add(struct vision_move *pmove, struct vision *old_vision,
+                     struct vision *new_vision,
+                     const v_radius_t new_radius_sq);
+void vision_move_reveal(struct vision_move *pmove);
+void vision_move_finish(struct vision_move *pmove);
+
 void change_playertile_site(struct player_tile *ptile,
                             struct vision_site *new_site);
 
@@ -161,7 +161,7 @@ void kill_player(struct player *pplayer)
          a radius of 3, give verbose messages of every unit transferred,
          and raze buildings according to raze chance (also removes palace) */
       if (transfer_city(pcity->original, pcity, 3, true, true, true, true)) {
-        script_server_signal_emit("city_transferred", pcity, pplayer,
+        script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, pplayer,
                                   pcity->original, "death-back_to_original");
       }
     }
@@ -204,7 +204,7 @@ void kill_player(struct player *pplayer)
     city_list_iterate_safe(pplayer->cities, pcity)
     {
       if (transfer_city(barbarians, pcity, -1, false, false, false, false)) {
-        script_server_signal_emit("city_transferred", pcity, pplayer,
+        script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, pplayer,
                                   barbarians, "death-barbarians_get");
       }
     }
@@ -1040,6 +1040,8 @@ static void send_player_info_c_real(struct player *src,
  */
 void send_player_diplstate_c(struct player *src, struct conn_list *dest)
 {
+  // Sent after every change; effects may depend on diplomatic states.
+  city_refresh_invalidate_effects();
   if (src != nullptr) {
     send_player_diplstate_c_real(src, dest);
     return;
@@ -1439,6 +1441,7 @@ void server_player_init(struct player *pplayer, bool initmap,
 
   player_map_free(pplayer);
   pplayer->server.private_map = nullptr;
+  pplayer->server.tile_seen = nullptr;
 
   if (initmap) {
     player_map_init(pplayer);
@@ -1861,6 +1864,7 @@ void server_remove_player(struct player *pplayer)
   send_player_remove_info_c(pslot, nullptr);
 
   // Recalculate borders.
+  map_borders_invalidate();
   map_calculate_borders();
 }
 
@@ -2731,6 +2735,7 @@ static struct player *split_player(struct player *pplayer)
     pplayer->target_government = pplayer->government;
     pplayer->government = game.government_during_revolution;
     pplayer->revolution_finishes = game.info.turn + 1;
+    city_refresh_invalidate_effects();
   }
   old_research->bulbs_researched = 0;
   old_research->researching_saved = A_UNKNOWN;
@@ -2994,7 +2999,7 @@ struct player *civil_war(struct player *pplayer)
                       // TRANS: <city> ... the Poles.
                       _("%s declares allegiance to the %s."),
                       city_link(pcity), nation_plural_for_player(cplayer));
-        script_server_signal_emit("city_transferred", pcity, pplayer,
+        script_server_signal_emit(SSIG_CITY_TRANSFERRED, pcity, pplayer,
                                   cplayer, "civil_war");
       }
       i--;
@@ -1060,8 +1060,18 @@ static void dem_line_item(char *outptr, size_t out_size,
                           struct player *pplayer, struct dem_row *prow,
                           bv_cols selcols)
 {
+  /* Some of the values walk all the cities or units of a player. Get
+   * them once for everybody instead of once per comparison. */
+  int values[MAX_NUM_PLAYER_SLOTS];
+
+  players_iterate(other)
+  {
+    values[player_index(other)] = prow->get_value(other);
+  }
+  players_iterate_end;
+
   if (nullptr != pplayer && BV_ISSET(selcols, DEM_COL_QUANTITY)) {
-    const char *text = prow->to_text(prow->get_value(pplayer));
+    const char *text = prow->to_text(values[player_index(pplayer)]);
 
     cat_snprintf(outptr, out_size, " %s", text);
     cat_snprintf(outptr, out_size, "%*s",
@@ -1070,16 +1080,16 @@ static void dem_line_item(char *outptr, size_t out_size,
   }
 
   if (nullptr != pplayer && BV_ISSET(selcols, DEM_COL_RANK)) {
-    int basis = prow->get_value(pplayer);
+    int basis = values[player_index(pplayer)];
     int place = 1;
 
     players_iterate(other)
     {
+      int value = values[player_index(other)];
+
       if (GOOD_PLAYER(other)
-          && ((prow->greater_values_are_better
-               && prow->get_value(other) > basis)
-              || (!prow->greater_values_are_better
-                  && prow->get_value(other) < basis))) {
+          && ((prow->greater_values_are_better && value > basis)
+              || (!prow->greater_values_are_better && value < basis))) {
         place++;
       }
     }
@@ -1090,12 +1100,13 @@ static void dem_line_item(char *outptr, size_t out_size,
 
   if (nullptr == pplayer || BV_ISSET(selcols, DEM_COL_BEST)) {
     struct player *best_player = pplayer;
-    int best_value = nullptr != pplayer ? prow->get_value(pplayer) : 0;
+    int best_value =
+        nullptr != pplayer ? values[player_index(pplayer)] : 0;
 
     players_iterate(other)
     {
       if (GOOD_PLAYER(other)) {
-        int value = prow->get_value(other);
+        int value = values[player_index(other)];
 
         if (!best_player
             || (prow->greater_values_are_better && value > best_value)
@@ -1112,7 +1123,7 @@ static void dem_line_item(char *outptr, size_t out_size,
             && (pplayer != best_player))) {
       cat_snprintf(outptr, out_size, "   %s: %s",
                    nation_plural_for_player(best_player),
-                   prow->to_text(prow->get_value(best_player)));
+                   prow->to_text(values[player_index(best_player)]));
     }
   }
 }
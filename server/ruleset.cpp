@@ -14,10 +14,19 @@
 #include <cstdarg>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 
+// Qt
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QHash>
+
+// utility
 #include "bitvector.h"
+#include "capability.h"
 #include "deprecations.h"
 #include "fcintl.h"
+#include "log.h"
 #include "registry.h"
 #include "registry_ini.h"
 #include "shared.h"
@@ -68,6 +77,18 @@
 
 // RULESET_SUFFIX already used, no leading dot here
 #define RULES_SUFFIX "ruleset"
+
+/* The ruleset packets recorded for the clients with "ruleset-bundle",
+ * one bundle per set of packet handlers. See send_rulesets(). */
+struct ruleset_bundle {
+  QByteArray hash;
+  QByteArray chunks;
+  int length;
+  bool valid; // the recorded packets read back correctly
+};
+typedef QHash<const struct packet_handlers *, struct ruleset_bundle>
+    ruleset_bundle_hash;
+Q_GLOBAL_STATIC(ruleset_bundle_hash, ruleset_bundles)
 #define SCRIPT_SUFFIX "lua"
 
 #define ADVANCE_SECTION_PREFIX "advance_"
@@ -8573,6 +8594,10 @@ bool load_rulesets(const char *restore, const char *alt, bool compat_mode,
                    rs_conversion_logger logger, bool act, bool buffer_script,
                    bool load_luadata)
 {
+  // Whatever is loaded, the recorded packets are outdated.
+  ruleset_bundles->clear();
+  city_refresh_invalidate_effects();
+
   if (load_rulesetdir(game.server.rulesetdir, compat_mode, logger, act,
                       buffer_script, load_luadata)) {
     return true;
@@ -8829,6 +8854,7 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
   if (ok && act) {
     // Populate remaining caches.
     techs_precalc_data();
+    techs_precalc_closures();
     improvement_feature_cache_init();
     unit_class_iterate(pclass) { set_unit_class_caches(pclass); }
     unit_class_iterate_end;
@@ -8875,12 +8901,10 @@ bool reload_rulesets_settings()
 }
 
 /**
-   Send all ruleset information to the specified connections.
+   Send all ruleset packets to the specified connections.
  */
-void send_rulesets(struct conn_list *dest)
+static void send_ruleset_packets(struct conn_list *dest)
 {
-  conn_list_compression_freeze(dest);
-
   // ruleset_control also indicates to client that ruleset sending starts.
   send_ruleset_control(dest);
 
@@ -8915,6 +8939,171 @@ void send_rulesets(struct conn_list *dest)
 
   // Indicate client that all rulesets have now been sent.
   lsend_packet_rulesets_ready(dest);
+}
+
+/**
+   Run send, which sends packets to the given list, against a connection
+   without socket that has the packet handlers of pconn and empty delta
+   caches. Returns the data as it would have been written to the network.
+ */
+static QByteArray
+record_ruleset_packets(const struct connection *pconn, bool compress,
+                       const std::function<void(struct conn_list *)> &send)
+{
+  struct connection recorder;
+  QByteArray data;
+
+  connection_common_init(&recorder);
+  // Record with the header used after the join, not the login one.
+  recorder.packet_header = pconn->packet_header;
+  recorder.record = &data;
+  recorder.id = 0;
+  recorder.observer = false;
+  recorder.playing = nullptr;
+  recorder.self = conn_list_new();
+  recorder.username[0] = '\0';
+  sz_strlcpy(recorder.capability, pconn->capability);
+  recorder.phs.handlers = pconn->phs.handlers;
+  recorder.access_level = ALLOW_NONE;
+  recorder.notify_of_writable_data = nullptr;
+  recorder.incoming_packet_notify = nullptr;
+  recorder.outgoing_packet_notify = nullptr;
+  recorder.server.is_closing = false;
+  conn_list_append(recorder.self, &recorder);
+
+  if (compress) {
+    conn_compression_freeze(&recorder);
+  }
+  send(recorder.self);
+  if (compress) {
+    conn_compression_thaw(&recorder);
+  }
+
+  conn_list_destroy(recorder.self);
+  connection_common_close(&recorder);
+
+  return data;
+}
+
+/**
+   Returns the ruleset bundle for the packet handlers of pconn, recording
+   it first if needed.
+ */
+static const struct ruleset_bundle &
+ruleset_bundle_get(const struct connection *pconn)
+{
+  struct ruleset_bundle &bundle = (*ruleset_bundles)[pconn->phs.handlers];
+  struct packet_ruleset_bundle packet;
+  QByteArray stream;
+  QElapsedTimer timer;
+
+  if (!bundle.hash.isEmpty()) {
+    return bundle;
+  }
+
+  timer.start();
+  stream = record_ruleset_packets(pconn, true, send_ruleset_packets);
+  bundle.hash =
+      QCryptographicHash::hash(stream, QCryptographicHash::Sha1).toHex();
+  bundle.length = stream.size();
+
+  // The chunk packets themselves are recorded too.
+  sz_strlcpy(packet.hash, bundle.hash.constData());
+  packet.cached = false;
+  packet.total_length = stream.size();
+  bundle.chunks = record_ruleset_packets(
+      pconn, false, [&](struct conn_list *dest) {
+        conn_list_iterate(dest, aconn)
+        {
+          for (packet.offset = 0; packet.offset < stream.size();
+               packet.offset += packet.chunk_length) {
+            packet.chunk_length = MIN(RULESET_BUNDLE_CHUNK_SIZE,
+                                      stream.size() - packet.offset);
+            memcpy(packet.data, stream.constData() + packet.offset,
+                   packet.chunk_length);
+            send_packet_ruleset_bundle(aconn, &packet);
+          }
+        }
+        conn_list_iterate_end;
+      });
+
+  bundle.valid = (recorded_packets_check(pconn, stream)
+                  && recorded_packets_check(pconn, bundle.chunks));
+  if (!bundle.valid) {
+    qCritical("Ruleset bundle %s does not read back correctly, sending "
+              "the rulesets packet by packet instead.",
+              bundle.hash.constData());
+  }
+
+  log_time(QStringLiteral("Ruleset bundle %1: %2 bytes in %3 ms")
+               .arg(QString::fromLatin1(bundle.hash))
+               .arg(bundle.length)
+               .arg(timer.elapsed()));
+
+  return bundle;
+}
+
+/**
+   Send the ruleset bundle to pconn, or only tell it to use its cached
+   copy if it announced the same hash. Returns FALSE without sending
+   anything if the bundle could not be recorded correctly.
+
+   The bundle was recorded with empty delta caches, and the client clears
+   its own when it injects the bundle. Both ends drop the delta caches
+   again after it, so they stay in sync.
+ */
+static bool send_ruleset_bundle(struct connection *pconn)
+{
+  const struct ruleset_bundle &bundle = ruleset_bundle_get(pconn);
+  QByteArray token = QByteArrayLiteral("ruleset-cache-") + bundle.hash;
+
+  if (!bundle.valid) {
+    return false;
+  }
+
+  if (has_capability(token.constData(), pconn->capability)) {
+    struct packet_ruleset_bundle packet;
+
+    sz_strlcpy(packet.hash, bundle.hash.constData());
+    packet.cached = true;
+    packet.offset = 0;
+    packet.total_length = bundle.length;
+    packet.chunk_length = 0;
+    send_packet_ruleset_bundle(pconn, &packet);
+    qDebug("%s uses its cached rulesets.", conn_description(pconn));
+  } else {
+    send_recorded_packets(pconn, bundle.chunks);
+  }
+
+  conn_clear_delta_cache(pconn, true);
+
+  return true;
+}
+
+/**
+   Send all ruleset information to the specified connections. Clients
+   with the "ruleset-bundle" capability get the packets recorded once
+   per ruleset, the others get them packet by packet.
+ */
+void send_rulesets(struct conn_list *dest)
+{
+  struct conn_list *legacy = conn_list_new();
+
+  conn_list_compression_freeze(dest);
+
+  conn_list_iterate(dest, pconn)
+  {
+    if (!has_capability("ruleset-bundle", pconn->capability)
+        || !send_ruleset_bundle(pconn)) {
+      conn_list_append(legacy, pconn);
+    }
+  }
+  conn_list_iterate_end;
+
+  if (conn_list_size(legacy) > 0) {
+    send_ruleset_packets(legacy);
+  }
+  conn_list_destroy(legacy);
 
   /* changed game settings will be send in
    * connecthand.c:establish_new_connection() */
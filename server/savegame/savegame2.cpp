@@ -187,7 +187,7 @@ extern bool sg_success;
  *                  will be the y coordinate
  * Example:
  *   LOAD_MAP_CHAR(ch, ptile,
- *                 map_get_player_tile(ptile, plr)->terrain
+ *                 player_tile_edit(map_get_player_tile(ptile, plr))->terrain
  *                   = char2terrain(ch), file, "player%d.map_t%04d", plrno);
  *
  * Note: some (but not all) of the code this is replacing used to skip over
@@ -2718,6 +2718,7 @@ static void sg_load_players(struct loaddata *loading)
   initialize_globals();
   unit_ordering_apply();
 
+  map_borders_invalidate();
   // All vision is ready; this calls city_thaw_workers_queue().
   map_calculate_borders();
 
@@ -4491,15 +4492,18 @@ static void sg_load_player_vision(struct loaddata *loading,
   }
 
   // Load player map (terrain).
-  LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->terrain = char2terrain(ch),
-                loading->file, "player%d.map_t%04d", plrno);
+  LOAD_MAP_CHAR(
+      ch, ptile,
+      player_tile_edit(map_get_player_tile(ptile, plr))->terrain =
+          char2terrain(ch),
+      loading->file, "player%d.map_t%04d", plrno);
 
   // Load player map (resources).
-  LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->resource =
-                    char2resource(ch),
-                loading->file, "player%d.map_res%04d", plrno);
+  LOAD_MAP_CHAR(
+      ch, ptile,
+      player_tile_edit(map_get_player_tile(ptile, plr))->resource =
+          char2resource(ch),
+      loading->file, "player%d.map_res%04d", plrno);
 
   if (loading->version >= 30) {
     // 2.6.0 or newer
@@ -4507,10 +4511,12 @@ static void sg_load_player_vision(struct loaddata *loading,
     // Load player map (extras).
     halfbyte_iterate_extras(j, loading->extra.size)
     {
-      LOAD_MAP_CHAR(ch, ptile,
-                    sg_extras_set(&map_get_player_tile(ptile, plr)->extras,
-                                  ch, loading->extra.order + 4 * j),
-                    loading->file, "player%d.map_e%02d_%04d", plrno, j);
+      LOAD_MAP_CHAR(
+          ch, ptile,
+          sg_extras_set(
+              &player_tile_edit(map_get_player_tile(ptile, plr))->extras,
+              ch, loading->extra.order + 4 * j),
+          loading->file, "player%d.map_e%02d_%04d", plrno, j);
     }
     halfbyte_iterate_extras_end;
   } else {
@@ -4519,9 +4525,10 @@ static void sg_load_player_vision(struct loaddata *loading,
     {
       LOAD_MAP_CHAR(
           ch, ptile,
-          sg_special_set(ptile, &map_get_player_tile(ptile, plr)->extras, ch,
-                         loading->special.order + 4 * static_cast<int>(x),
-                         false),
+          sg_special_set(
+              ptile,
+              &player_tile_edit(map_get_player_tile(ptile, plr))->extras, ch,
+              loading->special.order + 4 * static_cast<int>(x), false),
           loading->file, "player%d.map_spe%02d_%04d", plrno, x);
     }
     halfbyte_iterate_special_end;
@@ -4529,10 +4536,12 @@ static void sg_load_player_vision(struct loaddata *loading,
     // Load player map (bases).
     halfbyte_iterate_bases(j, loading->base.size)
     {
-      LOAD_MAP_CHAR(ch, ptile,
-                    sg_bases_set(&map_get_player_tile(ptile, plr)->extras,
-                                 ch, loading->base.order + 4 * j),
-                    loading->file, "player%d.map_b%02d_%04d", plrno, j);
+      LOAD_MAP_CHAR(
+          ch, ptile,
+          sg_bases_set(
+              &player_tile_edit(map_get_player_tile(ptile, plr))->extras,
+              ch, loading->base.order + 4 * j),
+          loading->file, "player%d.map_b%02d_%04d", plrno, j);
     }
     halfbyte_iterate_bases_end;
 
@@ -4541,10 +4550,12 @@ static void sg_load_player_vision(struct loaddata *loading,
       // 2.5.0 or newer
       halfbyte_iterate_roads(j, loading->road.size)
       {
-        LOAD_MAP_CHAR(ch, ptile,
-                      sg_roads_set(&map_get_player_tile(ptile, plr)->extras,
-                                   ch, loading->road.order + 4 * j),
-                      loading->file, "player%d.map_r%02d_%04d", plrno, j);
+        LOAD_MAP_CHAR(
+            ch, ptile,
+            sg_roads_set(
+                &player_tile_edit(map_get_player_tile(ptile, plr))->extras,
+                ch, loading->road.order + 4 * j),
+            loading->file, "player%d.map_r%02d_%04d", plrno, j);
       }
       halfbyte_iterate_roads_end;
     }
@@ -4569,17 +4580,19 @@ static void sg_load_player_vision(struct loaddata *loading,
         char token2[TOKEN_SIZE];
         int number;
         struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
+        struct player_tile_state *plrstate =
+            player_tile_edit(map_get_player_tile(ptile, plr));
         char n[] = ",";
         scanin(const_cast<char **>(&ptr), n, token, sizeof(token));
         sg_failure_ret('\0' != token[0],
                        "Savegame corrupt - map size not correct.");
         if (strcmp(token, "-") == 0) {
-          map_get_player_tile(ptile, plr)->owner = nullptr;
+          plrstate->owner = nullptr;
         } else {
           sg_failure_ret(str_to_int(token, &number),
                          "Savegame corrupt - got tile owner=%s in (%d, %d).",
                          token, x, y);
-          map_get_player_tile(ptile, plr)->owner = player_by_number(number);
+          plrstate->owner = player_by_number(number);
         }
 
         if (loading->version >= 30) {
@@ -4588,18 +4601,16 @@ static void sg_load_player_vision(struct loaddata *loading,
           sg_failure_ret('\0' != token2[0],
                          "Savegame corrupt - map size not correct.");
           if (strcmp(token2, "-") == 0) {
-            map_get_player_tile(ptile, plr)->extras_owner = nullptr;
+            plrstate->extras_owner = nullptr;
           } else {
             sg_failure_ret(
                 str_to_int(token2, &number),
                 "Savegame corrupt - got extras owner=%s in (%d, %d).", token,
                 x, y);
-            map_get_player_tile(ptile, plr)->extras_owner =
-                player_by_number(number);
+            plrstate->extras_owner = player_by_number(number);
           }
         } else {
-          map_get_player_tile(ptile, plr)->extras_owner =
-              map_get_player_tile(ptile, plr)->owner;
+          plrstate->extras_owner = plrstate->owner;
         }
       }
     }
@@ -4655,7 +4666,7 @@ static void sg_load_player_vision(struct loaddata *loading,
       // Non fogged borders aren't loaded. See hrm Bug #879084
       struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-      plrtile->owner = tile_owner(ptile);
+      player_tile_edit(plrtile)->owner = tile_owner(ptile);
     }
   }
   whole_map_iterate_end;
@@ -5201,8 +5212,7 @@ static void sg_load_sanitycheck(struct loaddata *loading)
     if (loading->version < 30) {
       /* For older savegames we have to recalculate the score with current
        * data, instead of using beginning-of-turn saved scores. */
-      players_iterate(pplayer) { calc_civ_score(pplayer); }
-      players_iterate_end;
+      calc_civ_scores();
     }
   }
 
@@ -66,11 +66,14 @@
 
 #include <QBitArray>
 #include <QSet>
+#include <QThreadPool>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <sstream>
+#include <vector>
 
 // utility
 #include "bitvector.h"
@@ -201,7 +204,7 @@ extern bool sg_success;
  *                  will be the y coordinate
  * Example:
  *   LOAD_MAP_CHAR(ch, ptile,
- *                 map_get_player_tile(ptile, plr)->terrain
+ *                 player_tile_edit(map_get_player_tile(ptile, plr))->terrain
  *                   = char2terrain(ch), file, "player%d.map_t%04d", plrno);
  *
  * Note: some (but not all) of the code this is replacing used to skip over
@@ -210,10 +213,16 @@ extern bool sg_success;
  *       skip the data, but there's not really much advantage to exiting
  *       early in this case. Instead, we let any map data type to be empty,
  *       and just print an informative warning message about it.
+ *
+ * All lines are looked up first. SET_XY_CHAR is then run for the rows in
+ * parallel, so it may only write data belonging to ptile. It must not log
+ * nor touch sg_success either; a character it can't read is recorded with
+ * sg_map_char_failed() and reported once all rows are done.
  */
 #define LOAD_MAP_CHAR(ch, ptile, SET_XY_CHAR, secfile, secpath, ...)        \
   {                                                                         \
-    int _nat_x, _nat_y;                                                     \
+    std::vector<struct sg_map_row> _rows(wld.map.ysize);                    \
+    int _nat_y;                                                             \
     bool _printed_warning = false;                                          \
     for (_nat_y = 0; _nat_y < wld.map.ysize; _nat_y++) {                    \
       const char *_line =                                                   \
@@ -232,12 +241,25 @@ extern bool sg_success;
         _printed_warning = true;                                            \
         continue;                                                           \
       }                                                                     \
-      for (_nat_x = 0; _nat_x < wld.map.xsize; _nat_x++) {                  \
-        const char ch = _line[_nat_x];                                      \
+      _rows[_nat_y].line = _line;                                           \
+    }                                                                       \
+    sg_load_map_rows([&](int _row) {                                        \
+      struct sg_map_row *_prow = &_rows[_row];                              \
+      if (nullptr == _prow->line) {                                         \
+        return;                                                             \
+      }                                                                     \
+      sg_map_row_current = _prow;                                           \
+      for (_prow->nat_x = 0; _prow->nat_x < wld.map.xsize;                  \
+           _prow->nat_x++) {                                                \
+        const char ch = _prow->line[_prow->nat_x];                          \
         struct tile *ptile =                                                \
-            native_pos_to_tile(&(wld.map), _nat_x, _nat_y);                 \
+            native_pos_to_tile(&(wld.map), _prow->nat_x, _row);             \
         (SET_XY_CHAR);                                                      \
       }                                                                     \
+      sg_map_row_current = nullptr;                                         \
+    });                                                                     \
+    for (_nat_y = 0; _nat_y < wld.map.ysize; _nat_y++) {                    \
+      sg_map_row_report(&_rows[_nat_y], _nat_y);                            \
     }                                                                       \
     if (_printed_warning) {                                                 \
       /* TRANS: Minor error message. */                                     \
@@ -247,6 +269,93 @@ extern bool sg_success;
     }                                                                       \
   }
 
+Q_GLOBAL_STATIC(QThreadPool, load_pool)
+
+/**
+   Calls decode for every native map row, spreading the rows over the
+   loading thread pool in one contiguous block per thread. Returns when
+   all rows are done.
+ */
+static void sg_load_map_rows(const std::function<void(int)> &decode)
+{
+  int threads = qMax(1, load_pool->maxThreadCount());
+  int block = (wld.map.ysize + threads - 1) / threads;
+
+  for (int first = 0; first < wld.map.ysize; first += block) {
+    int last = qMin(first + block, wld.map.ysize);
+
+    load_pool->start([&decode, first, last]() {
+      for (int nat_y = first; nat_y < last; nat_y++) {
+        decode(nat_y);
+      }
+    });
+  }
+  load_pool->waitForDone();
+}
+
+// Why a map character could not be read, see sg_map_char_failed().
+enum sg_map_char_error {
+  SG_MAP_CHAR_OK = 0,
+  SG_MAP_CHAR_TERRAIN, // Unknown terrain identifier; fatal
+  SG_MAP_CHAR_EXTRAS,  // Unknown extras half-byte; read as no extras
+  SG_MAP_CHAR_HEX      // Unknown hex digit; the load fails
+};
+
+// A map row decoded by LOAD_MAP_CHAR.
+struct sg_map_row {
+  const char *line;
+  int nat_x; // Position of the character being decoded
+
+  // The first character of the row that could not be read, if any.
+  enum sg_map_char_error error;
+  int bad_x;
+  char bad_ch;
+};
+
+// The row the current thread is decoding.
+static thread_local struct sg_map_row *sg_map_row_current = nullptr;
+
+/**
+   Records that the character being decoded by the current thread can't be
+   read. Only the first one of each row is kept. For the SET_XY_CHAR
+   decoders of LOAD_MAP_CHAR, which run on the loading thread pool.
+ */
+static void sg_map_char_failed(char ch, enum sg_map_char_error error)
+{
+  struct sg_map_row *prow = sg_map_row_current;
+
+  if (nullptr != prow && SG_MAP_CHAR_OK == prow->error) {
+    prow->error = error;
+    prow->bad_x = prow->nat_x;
+    prow->bad_ch = ch;
+  }
+}
+
+/**
+   Reports the character of a decoded row that could not be read, if any.
+   Called from the main thread once all rows are done.
+ */
+static void sg_map_row_report(const struct sg_map_row *prow, int nat_y)
+{
+  switch (prow->error) {
+  case SG_MAP_CHAR_OK:
+    break;
+  case SG_MAP_CHAR_TERRAIN:
+    qFatal("Unknown terrain identifier '%c' in savegame at (%d, %d).",
+           prow->bad_ch, prow->bad_x, nat_y);
+    exit(EXIT_FAILURE);
+  case SG_MAP_CHAR_EXTRAS:
+    log_sg("Unknown hex value: '%c' (%d) at (%d, %d)", prow->bad_ch,
+           prow->bad_ch, prow->bad_x, nat_y);
+    break;
+  case SG_MAP_CHAR_HEX:
+    sg_success = false;
+    log_sg("Unknown hex value: '%c' %d at (%d, %d)", prow->bad_ch,
+           prow->bad_ch, prow->bad_x, nat_y);
+    break;
+  }
+}
+
 // Iterate on the extras half-bytes
 #define halfbyte_iterate_extras(e, num_extras_types)                        \
   {                                                                         \
@@ -306,6 +415,7 @@ static void sg_extras_set(bv_extras *extras, char ch,
 static char sg_extras_get(bv_extras extras, struct extra_type *presource,
                           const int *idx);
 static struct terrain *char2terrain(char ch);
+static int sg_hex2bin(char ch, int halfbyte);
 static char terrain2char(const struct terrain *pterrain);
 static Tech_type_id technology_load(struct section_file *file,
                                     const char *path, int plrno);
@@ -437,6 +547,7 @@ void savegame3_load(struct section_file *file)
 {
   struct loaddata *loading;
   bool was_send_city_suppressed, was_send_tile_suppressed;
+  civtimer *loadtimer;
 
   // initialise loading
   was_send_city_suppressed = send_city_suppression(true);
@@ -462,11 +573,27 @@ void savegame3_load(struct section_file *file)
   // [players] (basic data)
   sg_load_players_basic(loading);
   // [map]; needs width and height loaded by [settings]
+  loadtimer = timer_new(TIMER_USER, TIMER_DEBUG);
+  timer_start(loadtimer);
   sg_load_map(loading);
+  timer_stop(loadtimer);
+  qCDebug(timers_category, "Loading map in %.3f seconds.",
+          timer_read_seconds(loadtimer));
   // [research]
+  timer_clear(loadtimer);
+  timer_start(loadtimer);
   sg_load_researches(loading);
+  timer_stop(loadtimer);
+  qCDebug(timers_category, "Loading research in %.3f seconds.",
+          timer_read_seconds(loadtimer));
   // [player<i>]
+  timer_clear(loadtimer);
+  timer_start(loadtimer);
   sg_load_players(loading);
+  timer_stop(loadtimer);
+  qCDebug(timers_category, "Loading players in %.3f seconds.",
+          timer_read_seconds(loadtimer));
+  timer_destroy(loadtimer);
   // [event_cache]
   sg_load_event_cache(loading);
   // [treaties]
@@ -1018,7 +1145,8 @@ static void unit_ordering_apply()
 
    'ch' gives the character loaded from the savegame. Extras are packed
    in four to a character in hex notation. 'index' is a mapping of
-   savegame bit -> base bit.
+   savegame bit -> base bit. An unknown character is recorded with
+   sg_map_char_failed().
  */
 static void sg_extras_set(bv_extras *extras, char ch,
                           struct extra_type **idx)
@@ -1027,7 +1155,7 @@ static void sg_extras_set(bv_extras *extras, char ch,
   const char *pch = strchr(hex_chars, ch);
 
   if (!pch || ch == '\0') {
-    log_sg("Unknown hex value: '%c' (%d)", ch, ch);
+    sg_map_char_failed(ch, SG_MAP_CHAR_EXTRAS);
     bin = 0;
   } else {
     bin = pch - hex_chars;
@@ -1084,7 +1212,7 @@ static char sg_extras_get(bv_extras extras, struct extra_type *presource,
  */
 static struct terrain *char2terrain(char ch)
 {
-  // terrain_by_identifier plus fatal error
+  // terrain_by_identifier plus error
   if (ch == TERRAIN_UNKNOWN_IDENTIFIER) {
     return T_UNKNOWN;
   }
@@ -1096,8 +1224,23 @@ static struct terrain *char2terrain(char ch)
   }
   terrain_type_iterate_end;
 
-  qFatal("Unknown terrain identifier '%c' in savegame.", ch);
-  exit(EXIT_FAILURE);
+  // Fatal once the row gets reported.
+  sg_map_char_failed(ch, SG_MAP_CHAR_TERRAIN);
+  return T_UNKNOWN;
+}
+
+/**
+   ascii_hex2bin() for the decoders of LOAD_MAP_CHAR: an unknown character
+   is recorded with sg_map_char_failed() instead of failing the load from
+   a worker thread.
+ */
+static int sg_hex2bin(char ch, int halfbyte)
+{
+  if (ch != ' ' && (ch == '\0' || nullptr == strchr(hex_chars, ch))) {
+    sg_map_char_failed(ch, SG_MAP_CHAR_HEX);
+    return 0;
+  }
+  return ascii_hex2bin(ch, halfbyte);
 }
 
 /**
@@ -3212,7 +3355,7 @@ static void sg_load_map_known(struct loaddata *loading)
                   player_slot_by_number(l * 32 + j * 4 + i))) {
             LOAD_MAP_CHAR(ch, ptile,
                           known[l * MAP_INDEX_SIZE + tile_index(ptile)] |=
-                          ascii_hex2bin(ch, j),
+                          sg_hex2bin(ch, j),
                           loading->file, "map.k%02d_%04d", l * 8 + j);
             break;
           }
@@ -3269,20 +3412,18 @@ static void sg_save_map_known(struct savedata *saving)
       /* HACK: we convert the data into a 32-bit integer, and then save it as
        * hex. */
 
-      whole_map_iterate(&(wld.map), ptile)
+      players_iterate(pplayer)
       {
-        players_iterate(pplayer)
+        p = player_index(pplayer);
+        l = p / 32;
+        bitplane_iterate(*pplayer->tile_known, nullptr, index)
         {
-          if (map_is_known(ptile, pplayer)) {
-            p = player_index(pplayer);
-            l = p / 32;
-            known[l * MAP_INDEX_SIZE + tile_index(ptile)] |=
-                (1u << (p % 32)); // "p % 32" = "p - l * 32"
-          }
+          known[l * MAP_INDEX_SIZE + index] |=
+              (1u << (p % 32)); // "p % 32" = "p - l * 32"
         }
-        players_iterate_end;
+        bitplane_iterate_end;
       }
-      whole_map_iterate_end;
+      players_iterate_end;
 
       for (l = 0; l < lines; l++) {
         for (j = 0; j < 8; j++) {
@@ -3728,6 +3869,7 @@ static void sg_load_players(struct loaddata *loading)
   initialize_globals();
   unit_ordering_apply();
 
+  map_borders_invalidate();
   // All vision is ready; this calls city_thaw_workers_queue().
   map_calculate_borders();
 
@@ -6621,17 +6763,21 @@ static void sg_load_player_vision(struct loaddata *loading,
   }
 
   // Load player map (terrain).
-  LOAD_MAP_CHAR(ch, ptile,
-                map_get_player_tile(ptile, plr)->terrain = char2terrain(ch),
-                loading->file, "player%d.map_t%04d", plrno);
+  LOAD_MAP_CHAR(
+      ch, ptile,
+      player_tile_edit(map_get_player_tile(ptile, plr))->terrain =
+          char2terrain(ch),
+      loading->file, "player%d.map_t%04d", plrno);
 
   // Load player map (extras).
   halfbyte_iterate_extras(j, loading->extra.size)
   {
-    LOAD_MAP_CHAR(ch, ptile,
-                  sg_extras_set(&map_get_player_tile(ptile, plr)->extras, ch,
-                                loading->extra.order + 4 * j),
-                  loading->file, "player%d.map_e%02d_%04d", plrno, j);
+    LOAD_MAP_CHAR(
+        ch, ptile,
+        sg_extras_set(
+            &player_tile_edit(map_get_player_tile(ptile, plr))->extras, ch,
+            loading->extra.order + 4 * j),
+        loading->file, "player%d.map_e%02d_%04d", plrno, j);
   }
   halfbyte_iterate_extras_end;
 
@@ -6641,9 +6787,9 @@ static void sg_load_player_vision(struct loaddata *loading,
 
     extra_type_by_cause_iterate(EC_RESOURCE, pres)
     {
-      if (BV_ISSET(plrtile->extras, extra_number(pres))
-          && terrain_has_resource(plrtile->terrain, pres)) {
-        plrtile->resource = pres;
+      if (BV_ISSET(plrtile->state->extras, extra_number(pres))
+          && terrain_has_resource(plrtile->state->terrain, pres)) {
+        player_tile_edit(plrtile)->resource = pres;
       }
     }
     extra_type_by_cause_iterate_end;
@@ -6669,30 +6815,31 @@ static void sg_load_player_vision(struct loaddata *loading,
         char token2[TOKEN_SIZE];
         int number;
         struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
+        struct player_tile_state *plrstate =
+            player_tile_edit(map_get_player_tile(ptile, plr));
         char n[] = ",";
         scanin(const_cast<char **>(&ptr), n, token, sizeof(token));
         sg_failure_ret('\0' != token[0],
                        "Savegame corrupt - map size not correct.");
         if (strcmp(token, "-") == 0) {
-          map_get_player_tile(ptile, plr)->owner = nullptr;
+          plrstate->owner = nullptr;
         } else {
           sg_failure_ret(str_to_int(token, &number),
                          "Savegame corrupt - got tile owner=%s in (%d, %d).",
                          token, x, y);
-          map_get_player_tile(ptile, plr)->owner = player_by_number(number);
+          plrstate->owner = player_by_number(number);
         }
         scanin(const_cast<char **>(&ptr2), n, token2, sizeof(token2));
         sg_failure_ret('\0' != token2[0],
                        "Savegame corrupt - map size not correct.");
         if (strcmp(token2, "-") == 0) {
-          map_get_player_tile(ptile, plr)->extras_owner = nullptr;
+          plrstate->extras_owner = nullptr;
         } else {
           sg_failure_ret(
               str_to_int(token2, &number),
               "Savegame corrupt - got extras owner=%s in (%d, %d).", token,
               x, y);
-          map_get_player_tile(ptile, plr)->extras_owner =
-              player_by_number(number);
+          plrstate->extras_owner = player_by_number(number);
         }
       }
     }
@@ -6704,12 +6851,12 @@ static void sg_load_player_vision(struct loaddata *loading,
     if (i == 0) {
       LOAD_MAP_CHAR(ch, ptile,
                     map_get_player_tile(ptile, plr)->last_updated =
-                        ascii_hex2bin(ch, i),
+                        sg_hex2bin(ch, i),
                     loading->file, "player%d.map_u%02d_%04d", plrno, i);
     } else {
       LOAD_MAP_CHAR(ch, ptile,
                     map_get_player_tile(ptile, plr)->last_updated |=
-                    ascii_hex2bin(ch, i),
+                    sg_hex2bin(ch, i),
                     loading->file, "player%d.map_u%02d_%04d", plrno, i);
     }
   }
@@ -6748,7 +6895,7 @@ static void sg_load_player_vision(struct loaddata *loading,
       // Non fogged borders aren't loaded. See hrm Bug #879084
       struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-      plrtile->owner = tile_owner(ptile);
+      player_tile_edit(plrtile)->owner = tile_owner(ptile);
     }
   }
   whole_map_iterate_end;
@@ -6878,9 +7025,9 @@ static void sg_save_player_vision(struct savedata *saving,
   }
 
   // Save the map (terrain).
-  SAVE_MAP_CHAR(ptile,
-                terrain2char(map_get_player_tile(ptile, plr)->terrain),
-                saving->file, "player%d.map_t%04d", plrno);
+  SAVE_MAP_CHAR(
+      ptile, terrain2char(map_get_player_tile(ptile, plr)->state->terrain),
+      saving->file, "player%d.map_t%04d", plrno);
 
   if (game.server.foggedborders) {
     // Save the map (borders).
@@ -6895,11 +7042,11 @@ static void sg_save_player_vision(struct savedata *saving,
         struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
         struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-        if (plrtile == nullptr || plrtile->owner == nullptr) {
+        if (plrtile == nullptr || plrtile->state->owner == nullptr) {
           qstrcpy(token, "-");
         } else {
           fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->owner));
+                      player_number(plrtile->state->owner));
         }
         strcat(line, token);
         if (x < wld.map.xsize) {
@@ -6919,11 +7066,11 @@ static void sg_save_player_vision(struct savedata *saving,
         struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
         struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-        if (plrtile == nullptr || plrtile->extras_owner == nullptr) {
+        if (plrtile == nullptr || plrtile->state->extras_owner == nullptr) {
           qstrcpy(token, "-");
         } else {
           fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->extras_owner));
+                      player_number(plrtile->state->extras_owner));
         }
         strcat(line, token);
         if (x < wld.map.xsize) {
@@ -6949,10 +7096,10 @@ static void sg_save_player_vision(struct savedata *saving,
       }
     }
 
-    SAVE_MAP_CHAR(ptile,
-                  sg_extras_get(map_get_player_tile(ptile, plr)->extras,
-                                map_get_player_tile(ptile, plr)->resource,
-                                mod),
+    SAVE_MAP_CHAR(
+        ptile,
+        sg_extras_get(map_get_player_tile(ptile, plr)->state->extras,
+                      map_get_player_tile(ptile, plr)->state->resource, mod),
                   saving->file, "player%d.map_e%02d_%04d", plrno, j);
   }
   halfbyte_iterate_extras_end;
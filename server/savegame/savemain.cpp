@@ -28,6 +28,7 @@
 
 // server
 #include "console.h"
+#include "maphand.h"
 #include "notify.h"
 
 /* server/savegame */
@@ -70,6 +71,9 @@ void savegame_load(struct section_file *sfile)
     return;
   }
 
+  // The private maps were loaded tile by tile; share what is equal.
+  player_maps_compact();
+
   players_iterate(pplayer)
   {
     unit_list_iterate(pplayer->units, punit)
@@ -13,6 +13,7 @@
 #include <cstring>
 
 // Qt
+#include <QElapsedTimer>
 #include <QString>
 
 // utility
@@ -21,6 +22,7 @@
 #include "shared.h"
 
 // common
+#include "city.h"
 #include "culture.h"
 #include "game.h"
 #include "improvement.h"
@@ -154,35 +156,38 @@ static void print_landarea_map(struct claim_map *pcmap, int turn)
 #endif // LAND_AREA_DEBUG > 2
 
 /**
-   Count landarea, settled area, and claims map for all players.
+   Returns whether the tile is within the city radius of one of the
+   player's cities.
  */
-static void build_landarea_map(struct claim_map *pcmap)
+static bool is_tile_claimed_by(const struct tile *ptile,
+                               const struct player *pplayer)
 {
-  bv_player *claims = new bv_player[MAP_INDEX_SIZE]();
-
-  memset(pcmap, 0, sizeof(*pcmap));
-
-  // First calculate claims: which tiles are owned by each player.
-  players_iterate(pplayer)
+  city_tile_iterate(CITY_MAP_MAX_RADIUS_SQ, ptile, tile1)
   {
-    city_list_iterate(pplayer->cities, pcity)
-    {
-      struct tile *pcenter = city_tile(pcity);
+    const struct city *pcity = tile_city(tile1);
 
-      city_tile_iterate(city_map_radius_sq_get(pcity), pcenter, tile1)
-      {
-        BV_SET(claims[tile_index(tile1)], player_index(city_owner(pcity)));
-      }
-      city_tile_iterate_end;
+    if (nullptr != pcity && city_owner(pcity) == pplayer
+        && city_map_includes_tile(pcity, ptile)) {
+      return true;
     }
-    city_list_iterate_end;
   }
-  players_iterate_end;
+  city_tile_iterate_end;
+
+  return false;
+}
+
+/**
+   Count landarea and settled area for all players in one pass over the
+   map. Claims by city radius only matter for tiles with units on them,
+   so they are looked up for those tiles only.
+ */
+static void build_landarea_map(struct claim_map *pcmap)
+{
+  memset(pcmap, 0, sizeof(*pcmap));
 
   whole_map_iterate(&(wld.map), ptile)
   {
     struct player *owner = nullptr;
-    bv_player *pclaim = &claims[tile_index(ptile)];
 
     if (is_ocean_tile(ptile)) {
       // Nothing.
@@ -195,7 +200,7 @@ static void build_landarea_map(struct claim_map *pcmap)
     } else if (unit_list_size(ptile->units) > 0) {
       // Because of allied stacking these calculations are a bit off.
       owner = unit_owner(unit_list_get(ptile->units, 0));
-      if (BV_ISSET(*pclaim, player_index(owner))) {
+      if (is_tile_claimed_by(ptile, owner)) {
         pcmap->player[player_index(owner)].settledarea++;
       }
     }
@@ -211,8 +216,6 @@ static void build_landarea_map(struct claim_map *pcmap)
   }
   whole_map_iterate_end;
 
-  delete[] claims;
-
 #if LAND_AREA_DEBUG >= 2
   print_landarea_map(pcmap, turn);
 #endif
@@ -250,14 +253,15 @@ static void get_player_landarea(struct claim_map *pcmap,
 }
 
 /**
-   Calculates the civilization score for the player.
+   Calculates the civilization score for the player, using the land area
+   claims computed for all players.
  */
-void calc_civ_score(struct player *pplayer)
+static void calc_civ_score(struct player *pplayer,
+                           struct claim_map *pcmap)
 {
   const struct research *presearch;
   struct city *wonder_city;
   int landarea = 0, settledarea = 0;
-  static struct claim_map cmap;
 
   pplayer->score.happy = 0;
   pplayer->score.content = 0;
@@ -328,9 +332,7 @@ void calc_civ_score(struct player *pplayer)
   }
   city_list_iterate_end;
 
-  build_landarea_map(&cmap);
-
-  get_player_landarea(&cmap, pplayer, &landarea, &settledarea);
+  get_player_landarea(pcmap, pplayer, &landarea, &settledarea);
   pplayer->score.landarea = landarea;
   pplayer->score.settledarea = settledarea;
 
@@ -366,6 +368,24 @@ void calc_civ_score(struct player *pplayer)
   pplayer->score.game = get_civ_score(pplayer);
 }
 
+/**
+   Calculates the civilization scores of all players. The whole map is
+   only walked once for all of them.
+ */
+void calc_civ_scores()
+{
+  static struct claim_map cmap;
+  QElapsedTimer timer;
+
+  timer.start();
+
+  build_landarea_map(&cmap);
+  players_iterate(pplayer) { calc_civ_score(pplayer, &cmap); }
+  players_iterate_end;
+
+  log_time(QStringLiteral("Scores: %1 milliseconds").arg(timer.elapsed()));
+}
+
 /**
    Return the score given by the units stats.
  */
@@ -12,7 +12,7 @@
 
 #include "fc_types.h"
 
-void calc_civ_score(struct player *pplayer);
+void calc_civ_scores();
 
 int get_civ_score(const struct player *pplayer);
 
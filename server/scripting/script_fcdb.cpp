@@ -9,7 +9,12 @@
  */
 
 // Qt
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QQueue>
 #include <QStandardPaths>
+#include <QWaitCondition>
 
 // sol2
 #include "sol/sol.hpp"
@@ -18,8 +23,13 @@
 #include "lua.h"
 
 // utility
+#include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 
+// common
+#include "connection.h"
+
 /* common/scriptcore */
 #include "luascript.h"
 #include "luascript_types.h"
@@ -39,6 +49,12 @@ static bool script_fcdb_functions_check(const char *fcdb_luafile);
 
 static bool script_fcdb_database_init();
 static bool script_fcdb_database_free();
+static void script_fcdb_close();
+
+static bool script_fcdb_user_exists(connection *pconn, bool &exists);
+static bool script_fcdb_user_save(connection *pconn, const char *password);
+static bool script_fcdb_user_verify(connection *pconn, const char *username,
+                                    bool &success);
 
 static void script_fcdb_cmd_reply(struct fc_lua *lfcl, QtMsgType level,
                                   const char *format, ...)
@@ -50,6 +66,50 @@ static sol::state *fcl = nullptr;
 /// Tolua compatibility
 static fc_lua fcl_compat = fc_lua();
 
+/// Serializes the use of the Lua state by the main and worker threads.
+static QMutex fcl_mutex;
+
+/**
+   A call waiting for or run by the worker thread. The connection is only
+   passed back to Lua as an opaque value: the worker reads the copies of
+   its name and address instead.
+ */
+struct fcdb_request {
+  struct fcdb_reply reply;
+  fcdb_reply_func func;
+  struct connection *pconn;
+  QByteArray username;
+  QByteArray ipaddr;
+  QByteArray password;
+  QElapsedTimer timer;
+  qint64 wait_us;
+};
+
+/// The request the worker is running, under fcl_mutex.
+static const struct fcdb_request *fcdb_current = nullptr;
+
+static struct {
+  QMutex mutex;
+  QWaitCondition cond;
+  QQueue<struct fcdb_request *> requests;
+  QQueue<struct fcdb_request *> replies;
+  bool exiting;
+} fcdb_queue;
+
+/// Calls sent and not answered yet. Main thread only.
+static int fcdb_pending = 0;
+
+/// Latency of the answered calls. Main thread only.
+static struct {
+  int calls;
+  int errors;
+  qint64 wait_us;
+  qint64 total_us;
+  qint64 max_us;
+} fcdb_stats;
+
+Q_GLOBAL_STATIC(fcThread, fcdb_thread);
+
 /**
    fcdb callback functions that must be defined in the lua script
    'database.lua':
@@ -143,14 +203,37 @@ static void script_fcdb_cmd_reply(struct fc_lua *lfcl, QtMsgType level,
   cmd_reply(CMD_FCDB, lfcl->caller, rfc_status, "%s", buf);
 }
 
+/**
+   Get username for connection, as copied when the running call was sent.
+ */
+static const char *script_fcdb_get_username(struct connection *pconn)
+{
+  if (fcdb_current != nullptr && fcdb_current->pconn == pconn) {
+    return fcdb_current->username.constData();
+  }
+  return auth_get_username(pconn);
+}
+
+/**
+   Get connection ip address, as copied when the running call was sent.
+ */
+static const char *script_fcdb_get_ipaddr(struct connection *pconn)
+{
+  if (fcdb_current != nullptr && fcdb_current->pconn == pconn) {
+    return fcdb_current->ipaddr.constData();
+  }
+  return auth_get_ipaddr(pconn);
+}
+
 /**
  * Registers FCDB-related functions in the Lua state
  */
 static void script_fcdb_register_functions()
 {
   // "auth" table
-  (*fcl)["auth"] = fcl->create_table_with("get_ipaddr", auth_get_ipaddr,
-                                          "get_username", auth_get_username);
+  (*fcl)["auth"] =
+      fcl->create_table_with("get_ipaddr", script_fcdb_get_ipaddr,
+                             "get_username", script_fcdb_get_username);
   // "fcdb" table
   (*fcl)["fcdb"] = fcl->create_table_with(
       "option", fcdb_option_get,
@@ -177,6 +260,8 @@ static void script_fcdb_register_functions()
  */
 bool script_fcdb_init(const QString &fcdb_luafile)
 {
+  QMutexLocker locker(&fcl_mutex);
+
   if (fcl != nullptr) {
     return true;
   }
@@ -211,7 +296,7 @@ bool script_fcdb_init(const QString &fcdb_luafile)
   } catch (const std::exception &e) {
     qCritical() << "Error loading the Freeciv21 database lua definition:"
                 << e.what();
-    script_fcdb_free();
+    script_fcdb_close();
     return false;
   }
 
@@ -222,23 +307,34 @@ bool script_fcdb_init(const QString &fcdb_luafile)
            .valid()) {
     qCritical("Error loading the Freeciv21 database lua script '%s'.",
               qUtf8Printable(fcdb_luafile_resolved));
-    script_fcdb_free();
+    script_fcdb_close();
     return false;
   }
   script_fcdb_functions_check(qUtf8Printable(fcdb_luafile_resolved));
 
   if (!script_fcdb_database_init()) {
     qCritical("Error connecting to the database");
-    script_fcdb_free();
+    script_fcdb_close();
     return false;
   }
   return true;
 }
 
 /**
-   Free the scripting data.
+   Free the scripting data. Calls queued for the worker thread stay queued
+   and fail if no script is loaded again.
  */
 void script_fcdb_free()
+{
+  QMutexLocker locker(&fcl_mutex);
+
+  script_fcdb_close();
+}
+
+/**
+   Close the database and the Lua state. The caller holds fcl_mutex.
+ */
+static void script_fcdb_close()
 {
   if (fcl != nullptr) {
     if (!script_fcdb_database_free()) {
@@ -257,6 +353,12 @@ void script_fcdb_free()
  */
 bool script_fcdb_do_string(struct connection *caller, const char *str)
 {
+  QMutexLocker locker(&fcl_mutex);
+
+  if (fcl == nullptr) {
+    return false;
+  }
+
   /* Set a log callback function which allows to send the results of the
    * command to the clients. */
   auto save_caller = fcl_compat.caller;
@@ -309,6 +411,12 @@ static bool script_fcdb_database_free()
 bool script_fcdb_user_delegate_to(connection *pconn, player *pplayer,
                                   const char *delegate, bool &success)
 {
+  QMutexLocker locker(&fcl_mutex);
+
+  if (fcl == nullptr) {
+    return false;
+  }
+
   const sol::protected_function user_delegate_to =
       (*fcl)["user_delegate_to"];
   auto result = user_delegate_to(pconn, pplayer, delegate);
@@ -324,7 +432,7 @@ bool script_fcdb_user_delegate_to(connection *pconn, player *pplayer,
 /**
  * Check if the user exists.
  */
-bool script_fcdb_user_exists(connection *pconn, bool &exists)
+static bool script_fcdb_user_exists(connection *pconn, bool &exists)
 {
   const sol::protected_function user_exists = (*fcl)["user_exists"];
   auto result = user_exists(pconn);
@@ -340,7 +448,7 @@ bool script_fcdb_user_exists(connection *pconn, bool &exists)
 /**
  * Save a new user.
  */
-bool script_fcdb_user_save(connection *pconn, const char *password)
+static bool script_fcdb_user_save(connection *pconn, const char *password)
 {
   const sol::protected_function user_save = (*fcl)["user_save"];
   auto result = user_save(pconn, password);
@@ -358,6 +466,12 @@ bool script_fcdb_user_save(connection *pconn, const char *password)
 bool script_fcdb_user_take(connection *requester, connection *taker,
                            player *player, bool will_observe, bool &success)
 {
+  QMutexLocker locker(&fcl_mutex);
+
+  if (fcl == nullptr) {
+    return false;
+  }
+
   const sol::protected_function user_take = (*fcl)["user_take"];
   auto result = user_take(requester, taker, player, will_observe);
   if (result.valid()) {
@@ -372,8 +486,8 @@ bool script_fcdb_user_take(connection *requester, connection *taker,
 /**
  * Check the credentials of the user.
  */
-bool script_fcdb_user_verify(connection *pconn, const char *username,
-                             bool &success)
+static bool script_fcdb_user_verify(connection *pconn, const char *username,
+                                    bool &success)
 {
   const sol::protected_function user_verify = (*fcl)["user_verify"];
   auto result = user_verify(pconn, username);
@@ -386,3 +500,182 @@ bool script_fcdb_user_verify(connection *pconn, const char *username,
   }
   return false;
 }
+
+/**
+   Run one call on the worker thread.
+ */
+static void script_fcdb_run(struct fcdb_request *preq)
+{
+  QMutexLocker locker(&fcl_mutex);
+  bool result = false;
+
+  preq->wait_us = preq->timer.nsecsElapsed() / 1000;
+  preq->reply.valid = false;
+  if (fcl != nullptr) {
+    fcdb_current = preq;
+    switch (preq->reply.call) {
+    case FCDB_USER_EXISTS:
+      preq->reply.valid = script_fcdb_user_exists(preq->pconn, result);
+      break;
+    case FCDB_USER_VERIFY:
+      preq->reply.valid = script_fcdb_user_verify(
+          preq->pconn, preq->password.constData(), result);
+      break;
+    case FCDB_USER_SAVE:
+      preq->reply.valid =
+          script_fcdb_user_save(preq->pconn, preq->password.constData());
+      break;
+    }
+    fcdb_current = nullptr;
+  }
+  preq->reply.result = result;
+}
+
+/**
+   Hand the answered calls to their reply functions. Runs on the main
+   thread.
+ */
+static void script_fcdb_replies()
+{
+  QQueue<struct fcdb_request *> replies;
+
+  {
+    QMutexLocker locker(&fcdb_queue.mutex);
+
+    replies.swap(fcdb_queue.replies);
+  }
+
+  for (auto *preq : qAsConst(replies)) {
+    qint64 total_us = preq->timer.nsecsElapsed() / 1000;
+
+    fcdb_pending--;
+    fcdb_stats.calls++;
+    if (!preq->reply.valid) {
+      fcdb_stats.errors++;
+    }
+    fcdb_stats.wait_us += preq->wait_us;
+    fcdb_stats.total_us += total_us;
+    fcdb_stats.max_us = MAX(fcdb_stats.max_us, total_us);
+    log_time(QStringLiteral("Database call for %1: %2 us queued, %3 us")
+                 .arg(preq->username.constData())
+                 .arg(preq->wait_us)
+                 .arg(total_us));
+
+    preq->func(&preq->reply);
+    delete preq;
+  }
+}
+
+/**
+   Main function of the worker thread: run the queued calls one at a time
+   until script_fcdb_stop().
+ */
+static void script_fcdb_worker(void *data)
+{
+  Q_UNUSED(data)
+  QMutexLocker locker(&fcdb_queue.mutex);
+
+  while (!fcdb_queue.exiting) {
+    struct fcdb_request *preq;
+
+    if (fcdb_queue.requests.isEmpty()) {
+      fcdb_queue.cond.wait(&fcdb_queue.mutex);
+      continue;
+    }
+
+    preq = fcdb_queue.requests.dequeue();
+    locker.unlock();
+    script_fcdb_run(preq);
+    locker.relock();
+
+    fcdb_queue.replies.enqueue(preq);
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(), [] { script_fcdb_replies(); },
+        Qt::QueuedConnection);
+  }
+}
+
+/**
+   Queue a call of the Lua function for the worker thread. The function
+   func is called on the main thread with the answer, unless the
+   connection is closed by then.
+ */
+void script_fcdb_call(enum fcdb_call call, struct connection *pconn,
+                      const char *password, fcdb_reply_func func)
+{
+  auto *preq = new fcdb_request;
+
+  preq->reply.conn_id = pconn->id;
+  preq->reply.call = call;
+  preq->reply.valid = false;
+  preq->reply.result = false;
+  preq->func = func;
+  preq->pconn = pconn;
+  preq->username = pconn->username;
+  preq->ipaddr = pconn->server.ipaddr;
+  preq->password = password != nullptr ? password : "";
+  preq->wait_us = 0;
+  preq->timer.start();
+
+  if (!fcdb_thread->isRunning()) {
+    fcdb_queue.exiting = false;
+    fcdb_thread->set_func(script_fcdb_worker, nullptr);
+    fcdb_thread->start(QThread::NormalPriority);
+  }
+
+  fcdb_pending++;
+
+  QMutexLocker locker(&fcdb_queue.mutex);
+  fcdb_queue.requests.enqueue(preq);
+  fcdb_queue.cond.wakeOne();
+}
+
+/**
+   Return the number of calls sent to the worker thread and not answered
+   yet.
+ */
+int script_fcdb_pending() { return fcdb_pending; }
+
+/**
+   Report the latency of the database calls.
+ */
+void script_fcdb_stats(struct connection *caller)
+{
+  int calls = MAX(fcdb_stats.calls, 1);
+
+  cmd_reply(CMD_FCDB, caller, C_OK,
+            _("%d database calls, %d failed, %d waiting."),
+            fcdb_stats.calls, fcdb_stats.errors, fcdb_pending);
+  cmd_reply(CMD_FCDB, caller, C_OK,
+            _("Average time queued %.1f ms, average total %.1f ms, "
+              "longest %.1f ms."),
+            fcdb_stats.wait_us / 1000.0 / calls,
+            fcdb_stats.total_us / 1000.0 / calls,
+            fcdb_stats.max_us / 1000.0);
+}
+
+/**
+   Stop the worker thread after its current call. Calls that are still
+   queued or not handed over are dropped.
+ */
+void script_fcdb_stop()
+{
+  if (!fcdb_thread->isRunning()) {
+    return;
+  }
+
+  {
+    QMutexLocker locker(&fcdb_queue.mutex);
+
+    fcdb_queue.exiting = true;
+    fcdb_queue.cond.wakeOne();
+  }
+  fcdb_thread->wait();
+
+  QMutexLocker locker(&fcdb_queue.mutex);
+  qDeleteAll(fcdb_queue.requests);
+  fcdb_queue.requests.clear();
+  qDeleteAll(fcdb_queue.replies);
+  fcdb_queue.replies.clear();
+  fcdb_pending = 0;
+}
@@ -22,18 +22,37 @@ class QString;
 struct connection;
 struct player;
 
+// Database calls run by the fcdb worker thread.
+enum fcdb_call {
+  FCDB_USER_EXISTS,
+  FCDB_USER_VERIFY,
+  FCDB_USER_SAVE
+};
+
+struct fcdb_reply {
+  int conn_id;
+  enum fcdb_call call;
+  bool valid;  // The Lua function ran without error
+  bool result; // What it returned, if anything
+};
+
+typedef void (*fcdb_reply_func)(const struct fcdb_reply *preply);
+
 // fcdb script functions.
 bool script_fcdb_init(const QString &fcdb_luafile);
 void script_fcdb_free();
+void script_fcdb_stop();
 
 bool script_fcdb_do_string(struct connection *caller, const char *str);
 
 // Call Lua functions
 bool script_fcdb_user_delegate_to(connection *pconn, player *pplayer,
                                   const char *delegate, bool &success);
-bool script_fcdb_user_exists(connection *pconn, bool &exists);
-bool script_fcdb_user_save(connection *pconn, const char *password);
 bool script_fcdb_user_take(connection *requester, connection *taker,
                            player *player, bool will_observe, bool &success);
-bool script_fcdb_user_verify(connection *pconn, const char *username,
-                             bool &success);
+
+// Call Lua functions on the worker thread
+void script_fcdb_call(enum fcdb_call call, struct connection *pconn,
+                      const char *password, fcdb_reply_func func);
+int script_fcdb_pending();
+void script_fcdb_stats(struct connection *caller);
@@ -8,6 +8,7 @@
  see https://www.gnu.org/licenses/.
  */
 
+#include <algorithm>
 #include <cstdarg>
 #include <ctime>
 #include <sys/stat.h>
@@ -21,6 +22,7 @@ extern "C" {
 #include "tolua.h"
 }
 // utility
+#include "fcintl.h"
 #include "log.h"
 #include "registry.h"
 
@@ -376,15 +378,94 @@ void script_server_state_save(struct section_file *file)
 /**
    Invoke all the callback functions attached to a given signal.
  */
-void script_server_signal_emit(const char *signal_name, ...)
+void script_server_signal_emit(enum script_signal signal_id, ...)
 {
   va_list args;
 
-  va_start(args, signal_name);
-  luascript_signal_emit_valist(fcl_main, signal_name, args);
+  if (!luascript_signal_has_callbacks(fcl_main, signal_id)) {
+    return;
+  }
+
+  va_start(args, signal_id);
+  luascript_signal_emit_by_id_valist(fcl_main, signal_id, args);
   va_end(args);
 }
 
+/**
+   Enable or disable profiling of the ruleset and scenario callbacks.
+ */
+void script_server_profile_enable(bool enable)
+{
+  luascript_profile_enable(fcl_main, enable);
+}
+
+/**
+   Set the time each callback may use per turn before a warning is
+   logged. 0 disables the budget.
+ */
+void script_server_profile_set_budget(int msec)
+{
+  luascript_profile_set_budget(fcl_main, msec);
+}
+
+/**
+   Clear the profiling data.
+ */
+void script_server_profile_reset() { luascript_profile_reset(fcl_main); }
+
+/**
+   Start accounting callback budgets for a new turn.
+ */
+void script_server_profile_turn_begin()
+{
+  luascript_profile_turn_reset(fcl_main);
+}
+
+/**
+   Send the profiling data to the caller, slowest signals first.
+ */
+void script_server_profile_report(struct connection *caller)
+{
+  const QVector<struct signal *> &signals = *fcl_main->signals_by_id;
+  QVector<int> order;
+  bool any = false;
+
+  for (int i = 0; i < signals.size(); i++) {
+    order.append(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&signals](int a, int b) {
+    return signals[a]->profile.nsec > signals[b]->profile.nsec;
+  });
+
+  cmd_reply(CMD_LUAPROFILE, caller, C_COMMENT, "%-40s %8s %10s %8s",
+            _("Signal / callback"), _("Calls"), _("Total ms"), _("Max ms"));
+  for (int i : qAsConst(order)) {
+    const struct signal *psignal = signals[i];
+
+    if (psignal->profile.calls == 0) {
+      continue;
+    }
+    any = true;
+
+    cmd_reply(CMD_LUAPROFILE, caller, C_COMMENT, "%-40s %8d %10.1f %8.1f",
+              qUtf8Printable(fcl_main->signal_names->at(i)),
+              psignal->profile.calls, psignal->profile.nsec / 1.0e6,
+              psignal->profile.max_nsec / 1.0e6);
+    for (const auto *pcallback : qAsConst(*psignal->callbacks)) {
+      cmd_reply(CMD_LUAPROFILE, caller, C_COMMENT,
+                "  %-38s %8d %10.1f %8.1f", pcallback->name,
+                pcallback->profile.calls, pcallback->profile.nsec / 1.0e6,
+                pcallback->profile.max_nsec / 1.0e6);
+    }
+  }
+
+  if (!any) {
+    cmd_reply(CMD_LUAPROFILE, caller, C_COMMENT, "%s",
+              fcl_main->profiling ? _("No script callback was invoked yet.")
+                                  : _("Script profiling is disabled."));
+  }
+}
+
 /**
    Declare any new signal types you need here.
  */
@@ -504,6 +585,13 @@ static void script_server_signals_create()
 
   luascript_signal_create(fcl_main, "action_started_unit_self", 2,
                           API_TYPE_ACTION, API_TYPE_UNIT);
+
+  // Emission by id relies on the creation order matching the enum.
+  for (int i = 0; i < SSIG_COUNT; i++) {
+    fc_assert(luascript_signal_id(fcl_main,
+                                  script_signal_name(script_signal(i)))
+              == i);
+  }
 }
 
 /**
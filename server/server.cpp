@@ -1071,7 +1071,7 @@ void server::pulse()
   finish_unit_waits();
 
   call_ai_refresh();
-  script_server_signal_emit("pulse");
+  script_server_signal_emit(SSIG_PULSE);
   (void) send_server_info_to_metaserver(META_REFRESH);
   if (current_turn_timeout() > 0 && S_S_RUNNING == server_state()
       && game.server.phase_timer
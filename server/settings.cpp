@@ -2917,6 +2917,20 @@ static struct setting settings[] = {
                 "are not required to wait for the save to finish."),
              nullptr, nullptr, GAME_DEFAULT_THREADED_SAVE),
 
+    GEN_INT("aithreads", game.server.ai_threads, SSET_META, SSET_INTERNAL,
+            SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+            N_("Number of threads used by AI players"),
+            N_("When this is greater than one, the AI players assess the "
+               "danger to their cities at the start of each phase using "
+               "this many threads, all at once, instead of one player "
+               "after the other. The assessment then sees the game as it "
+               "was when the phase started. They also use these threads "
+               "to measure the value of buildings and technologies for "
+               "their cities. When set to zero or one, everything is done "
+               "in the main thread."),
+            nullptr, nullptr, nullptr, GAME_MIN_AI_THREADS,
+            GAME_MAX_AI_THREADS, GAME_DEFAULT_AI_THREADS),
+
     GEN_ENUM("compresstype", game.server.save_compress_type, SSET_META,
              SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
              N_("Savegame compression algorithm"),
@@ -199,6 +199,7 @@ void srv_init()
   srvarg.auth_enabled = false;
   srvarg.auth_allow_guests = false;
   srvarg.auth_allow_newusers = false;
+  srvarg.auth_limit = 32;
 
   // mark as initialized
   has_been_srv_init = true;
@@ -622,7 +623,7 @@ void send_all_info(struct conn_list *dest)
     }
   };
   send_map_info(dest);
-  send_all_known_tiles(dest);
+  send_all_known_tiles_snapshot(dest);
   send_all_known_cities(dest);
   send_all_known_units(dest);
   send_spaceship_info(nullptr, dest);
@@ -1055,6 +1056,8 @@ void begin_turn(bool is_new_turn)
   log_debug("Begin turn");
 
   event_cache_remove_old();
+  // Effects may depend on the turn.
+  city_refresh_invalidate_effects();
 
   // Reset this each turn.
   if (is_new_turn) {
@@ -1084,8 +1087,10 @@ void begin_turn(bool is_new_turn)
   send_game_info(nullptr);
 
   if (is_new_turn) {
-    script_server_signal_emit("turn_begin", game.info.turn, game.info.year);
-    script_server_signal_emit("turn_started",
+    script_server_profile_turn_begin();
+    script_server_signal_emit(SSIG_TURN_BEGIN, game.info.turn,
+                              game.info.year);
+    script_server_signal_emit(SSIG_TURN_STARTED,
                               game.info.turn > 0 ? game.info.turn - 1
                                                  : game.info.turn,
                               game.info.year);
@@ -1093,8 +1098,7 @@ void begin_turn(bool is_new_turn)
     /* We build scores at the beginning of every turn.  We have to
      * build them at the beginning so that the AI can use the data,
      * and we are sure to have it when we need it. */
-    players_iterate(pplayer) { calc_civ_score(pplayer); }
-    players_iterate_end;
+    calc_civ_scores();
     log_civ_score_now();
 
     // Retire useless barbarian units
@@ -1614,7 +1618,7 @@ void end_turn()
 
       lsend_packet_achievement_info(first->connections, &pack);
 
-      script_server_signal_emit("achievement_gained", ach, first, true);
+      script_server_signal_emit(SSIG_ACHIEVEMENT_GAINED, ach, first, true);
     }
 
     pack.first = false;
@@ -1629,7 +1633,7 @@ void end_turn()
 
           lsend_packet_achievement_info(pplayer->connections, &pack);
 
-          script_server_signal_emit("achievement_gained", ach, pplayer,
+          script_server_signal_emit(SSIG_ACHIEVEMENT_GAINED, ach, pplayer,
                                     false);
         }
       }
@@ -1757,6 +1761,8 @@ void end_turn()
 
   log_debug("Sendyeartoclients");
   send_year_to_clients();
+  player_maps_log_memory();
+  city_refresh_log_stats();
   log_time(QStringLiteral("End turn:%1 milliseconds").arg(timer.elapsed()));
 }
 
@@ -2812,8 +2818,7 @@ static void announce_player(struct player *pplayer)
 void srv_scores()
 {
   // Recalculate the scores in case of a spaceship victory
-  players_iterate(pplayer) { calc_civ_score(pplayer); }
-  players_iterate_end;
+  calc_civ_scores();
 
   log_civ_score_now();
 
@@ -2993,7 +2998,7 @@ void srv_ready()
     }
 
     if (wld.map.server.generator != MAPGEN_SCENARIO) {
-      script_server_signal_emit("map_generated");
+      script_server_signal_emit(SSIG_MAP_GENERATED);
     }
 
     game_map_init();
@@ -3181,6 +3186,9 @@ void server_game_init(bool keep_ruleset_value)
  */
 void server_game_free()
 {
+  // Map images still being saved read the map.
+  mapimg_wait();
+
   CALL_FUNC_EACH_AI(game_free);
 
   // Free all the treaties that were left open when game finished.
@@ -3351,7 +3359,7 @@ terrain *mapimg_server_tile_terrain(const struct tile *ptile,
 {
   if (knowledge && pplayer) {
     struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-    return plrtile->terrain;
+    return plrtile->state->terrain;
   }
 
   return tile_terrain(ptile);
@@ -3367,7 +3375,7 @@ player *mapimg_server_tile_owner(const struct tile *ptile,
   if (knowledge && pplayer
       && tile_get_known(ptile, pplayer) != TILE_KNOWN_SEEN) {
     struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-    return plrtile->owner;
+    return plrtile->state->owner;
   }
 
   return tile_owner(ptile);
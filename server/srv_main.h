@@ -59,6 +59,7 @@ struct server_arguments {
   bool auth_enabled;        // defaults to FALSE
   bool auth_allow_guests;   // defaults to FALSE
   bool auth_allow_newusers; // defaults to FALSE
+  int auth_limit;           // logins waiting on the database at once
   enum announce_type announce;
 };
 
@@ -130,6 +130,8 @@ static bool default_command(struct connection *caller, char *arg,
                             bool check);
 static bool lua_command(struct connection *caller, char *arg, bool check,
                         int read_recursion);
+static bool luaprofile_command(struct connection *caller, char *arg,
+                               bool check);
 static bool kick_command(struct connection *caller, char *name, bool check);
 static bool delegate_command(struct connection *caller, char *arg,
                              bool check);
@@ -4711,6 +4713,8 @@ static bool handle_stdin_input_real(struct connection *caller, char *str,
     return default_command(caller, arg, check);
   case CMD_LUA:
     return lua_command(caller, arg, check, read_recursion);
+  case CMD_LUAPROFILE:
+    return luaprofile_command(caller, arg, check);
   case CMD_KICK:
     return kick_command(caller, arg, check);
   case CMD_DELEGATE:
@@ -5174,6 +5178,105 @@ static bool lua_command(struct connection *caller, char *arg, bool check,
   return ret;
 }
 
+// Define the possible arguments to the luaprofile command
+#define SPECENUM_NAME luaprofile_args
+#define SPECENUM_VALUE0 LUAPROFILE_ON
+#define SPECENUM_VALUE0NAME "on"
+#define SPECENUM_VALUE1 LUAPROFILE_OFF
+#define SPECENUM_VALUE1NAME "off"
+#define SPECENUM_VALUE2 LUAPROFILE_SHOW
+#define SPECENUM_VALUE2NAME "show"
+#define SPECENUM_VALUE3 LUAPROFILE_RESET
+#define SPECENUM_VALUE3NAME "reset"
+#define SPECENUM_VALUE4 LUAPROFILE_BUDGET
+#define SPECENUM_VALUE4NAME "budget"
+#include "specenum_gen.h"
+
+/**
+   Returns possible parameters for the luaprofile command.
+ */
+static const char *luaprofile_accessor(int i)
+{
+  i = CLIP(0, i, luaprofile_args_max());
+  return luaprofile_args_name(static_cast<enum luaprofile_args>(i));
+}
+
+/**
+   Control the script callback profiler.
+ */
+static bool luaprofile_command(struct connection *caller, char *arg,
+                               bool check)
+{
+  QStringList tokens;
+  int ind, budget = 0;
+  enum m_pre_result result;
+
+  tokens =
+      QString(arg).split(QRegularExpression(REG_EXP), Qt::SkipEmptyParts);
+  remove_quotes(tokens);
+
+  if (tokens.count() == 0) {
+    cmd_reply(CMD_LUAPROFILE, caller, C_SYNTAX,
+              _("Missing argument. See '%shelp luaprofile'."),
+              caller ? "/" : "");
+    return false;
+  }
+
+  result = match_prefix(luaprofile_accessor, luaprofile_args_max() + 1, 0,
+                        fc_strncasecmp, nullptr,
+                        qUtf8Printable(tokens.at(0)), &ind);
+  if (result != M_PRE_EXACT && result != M_PRE_ONLY) {
+    cmd_reply(CMD_LUAPROFILE, caller, C_SYNTAX,
+              _("Unknown argument '%s'. See '%shelp luaprofile'."),
+              qUtf8Printable(tokens.at(0)), caller ? "/" : "");
+    return false;
+  }
+
+  if (ind == LUAPROFILE_BUDGET) {
+    if (tokens.count() < 2
+        || !str_to_int(qUtf8Printable(tokens.at(1)), &budget)
+        || budget < 0) {
+      cmd_reply(CMD_LUAPROFILE, caller, C_SYNTAX,
+                _("The budget must be a number of milliseconds."));
+      return false;
+    }
+  }
+
+  if (check) {
+    return true;
+  }
+
+  switch (ind) {
+  case LUAPROFILE_ON:
+    script_server_profile_enable(true);
+    cmd_reply(CMD_LUAPROFILE, caller, C_OK, _("Script profiling enabled."));
+    break;
+  case LUAPROFILE_OFF:
+    script_server_profile_enable(false);
+    cmd_reply(CMD_LUAPROFILE, caller, C_OK, _("Script profiling disabled."));
+    break;
+  case LUAPROFILE_SHOW:
+    script_server_profile_report(caller);
+    break;
+  case LUAPROFILE_RESET:
+    script_server_profile_reset();
+    cmd_reply(CMD_LUAPROFILE, caller, C_OK, _("Script profile cleared."));
+    break;
+  case LUAPROFILE_BUDGET:
+    script_server_profile_set_budget(budget);
+    if (budget > 0) {
+      cmd_reply(CMD_LUAPROFILE, caller, C_OK,
+                _("Script callbacks may now use %d ms per turn."), budget);
+    } else {
+      cmd_reply(CMD_LUAPROFILE, caller, C_OK,
+                _("Script callback budget removed."));
+    }
+    break;
+  }
+
+  return true;
+}
+
 // Define the possible arguments to the delegation command
 #define SPECENUM_NAME delegate_args
 #define SPECENUM_VALUE0 DELEGATE_CANCEL
@@ -5893,7 +5996,8 @@ static bool mapimg_command(struct connection *caller, char *arg, bool check)
 
         if (pmapdef == nullptr
             || !mapimg_create(pmapdef, true, game.server.save_name,
-                              qUtf8Printable(srvarg.saves_pathname))) {
+                              qUtf8Printable(srvarg.saves_pathname))
+            || !mapimg_wait()) {
           cmd_reply(CMD_MAPIMG, caller, C_FAIL,
                     _("Error saving map image %d: %s."), id, mapimg_error());
           ret = false;
@@ -5910,7 +6014,8 @@ static bool mapimg_command(struct connection *caller, char *arg, bool check)
       pmapdef = mapimg_isvalid(id);
       if (pmapdef == nullptr
           || !mapimg_create(pmapdef, true, game.server.save_name,
-                            qUtf8Printable(srvarg.saves_pathname))) {
+                            qUtf8Printable(srvarg.saves_pathname))
+          || !mapimg_wait()) {
         cmd_reply(CMD_MAPIMG, caller, C_FAIL,
                   _("Error saving map image %d: %s."), id, mapimg_error());
         ret = false;
@@ -5998,6 +6103,8 @@ static bool aicmd_command(struct connection *caller, char *arg, bool check)
 #define SPECENUM_VALUE0NAME "reload"
 #define SPECENUM_VALUE1 FCDB_LUA
 #define SPECENUM_VALUE1NAME "lua"
+#define SPECENUM_VALUE2 FCDB_STATS
+#define SPECENUM_VALUE2NAME "stats"
 #define SPECENUM_COUNT FCDB_COUNT
 #include "specenum_gen.h"
 
@@ -6094,6 +6201,10 @@ static bool fcdb_command(struct connection *caller, char *arg, bool check)
     // Now execute the scriptlet.
     ret = script_fcdb_do_string(caller, arg);
     break;
+
+  case FCDB_STATS:
+    script_fcdb_stats(caller);
+    break;
   }
 
   return ret;
@@ -7368,6 +7479,15 @@ static char *lua_generator(const char *text, int state)
   return generic_generator(text, state, lua_args_max() + 1, lua_accessor);
 }
 
+/**
+   The valid arguments for the argument to "luaprofile".
+ */
+static char *luaprofile_generator(const char *text, int state)
+{
+  return generic_generator(text, state, luaprofile_args_max() + 1,
+                           luaprofile_accessor);
+}
+
 /**
    The valid first arguments to "help".
  */
@@ -7735,6 +7855,15 @@ static bool is_lua(int start)
                                    false);
 }
 
+/**
+   Return whether we are completing argument for luaprofile command
+ */
+static bool is_luaprofile(int start)
+{
+  return contains_str_before_start(
+      start, command_name_by_number(CMD_LUAPROFILE), false);
+}
+
 /**
    Return whether we are completing help command argument.
  */
@@ -7799,6 +7928,8 @@ char **freeciv_completion(const char *text, int start, int end)
     matches = rl_completion_matches(text, mapimg_generator);
   } else if (is_fcdb(start)) {
     matches = rl_completion_matches(text, fcdb_generator);
+  } else if (is_luaprofile(start)) {
+    matches = rl_completion_matches(text, luaprofile_generator);
   } else if (is_lua(start)) {
     matches = rl_completion_matches(text, lua_generator);
   } else {
@@ -82,7 +82,7 @@ void script_tech_learned(struct research *presearch,
    * tech first */
   if (originating_plr) {
     fc_assert(research_get(originating_plr) == presearch);
-    script_server_signal_emit("tech_researched", tech, originating_plr,
+    script_server_signal_emit(SSIG_TECH_RESEARCHED, tech, originating_plr,
                               reason);
   }
 
@@ -90,7 +90,7 @@ void script_tech_learned(struct research *presearch,
   research_players_iterate(presearch, member)
   {
     if (member != originating_plr) {
-      script_server_signal_emit("tech_researched", tech, member, reason);
+      script_server_signal_emit(SSIG_TECH_RESEARCHED, tech, member, reason);
     }
   }
   research_players_iterate_end;
@@ -221,7 +221,7 @@ void do_tech_parasite_effect(struct player *pplayer)
 
   research_players_iterate(plr_research, member)
   {
-    script_server_signal_emit("tech_researched", advance_by_number(tech),
+    script_server_signal_emit(SSIG_TECH_RESEARCHED, advance_by_number(tech),
                               member, "stolen");
   }
   research_players_iterate_end;
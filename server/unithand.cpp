@@ -2798,7 +2798,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
   if (pcity                                                                 \
       && is_action_enabled_unit_on_city(action_type, actor_unit, pcity)) {  \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_city",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_CITY,                \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2823,7 +2823,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
   if (actor_unit                                                            \
       && is_action_enabled_unit_on_self(action_type, actor_unit)) {         \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_self",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_SELF,                \
                               action_by_number(action), actor);             \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2844,7 +2844,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
   if (punit                                                                 \
       && is_action_enabled_unit_on_unit(action_type, actor_unit, punit)) {  \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_unit",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_UNIT,                \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2871,7 +2871,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
       && is_action_enabled_unit_on_units(action_type, actor_unit,           \
                                          target_tile)) {                    \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_units",                  \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_UNITS,               \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -2892,7 +2892,7 @@ bool unit_perform_action(struct player *pplayer, const int actor_id,
       && is_action_enabled_unit_on_tile(action_type, actor_unit,            \
                                         target_tile, target_extra)) {       \
     bool success;                                                           \
-    script_server_signal_emit("action_started_unit_tile",                   \
+    script_server_signal_emit(SSIG_ACTION_STARTED_UNIT_TILE,                \
                               action_by_number(action), actor, target);     \
     if (!actor || !unit_is_alive(actor_id)) {                               \
       /* Actor unit was destroyed during pre action Lua. */                 \
@@ -3407,7 +3407,8 @@ static bool city_add_unit(struct player *pplayer, struct unit *punit,
 
   send_city_info(nullptr, pcity);
 
-  script_server_signal_emit("city_size_change", pcity, amount, "unit_added");
+  script_server_signal_emit(SSIG_CITY_SIZE_CHANGE, pcity, amount,
+                            "unit_added");
 
   return true;
 }
@@ -3882,7 +3883,7 @@ static bool unit_do_destroy_city(struct player *act_player,
                              city_tile(tgt_city), city_link(tgt_city));
 
   // Run post city destruction Lua script.
-  script_server_signal_emit("city_destroyed", tgt_city, tgt_player,
+  script_server_signal_emit(SSIG_CITY_DESTROYED, tgt_city, tgt_player,
                             act_player);
 
   // Can't be sure of city existence after running script.
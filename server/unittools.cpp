@@ -15,6 +15,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 // utility
 #include "bitvector.h"
@@ -1639,7 +1640,7 @@ bool is_airunit_refuel_point(const struct tile *ptile,
 
     extra_type_list_iterate(pclass->cache.refuel_bases, pextra)
     {
-      if (BV_ISSET(plrtile->extras, extra_index(pextra))) {
+      if (BV_ISSET(plrtile->state->extras, extra_index(pextra))) {
         return true;
       }
     }
@@ -1737,8 +1738,8 @@ void transform_unit(struct unit *punit, const struct unit_type *to_unit,
   players_iterate_end;
 
   CALL_PLR_AI_FUNC(unit_transformed, pplayer, punit, old_type);
-  CALL_FUNC_EACH_AI(unit_info, punit);
 
+  // Also lets the AI types know about the change.
   send_unit_info(nullptr, punit);
   conn_list_do_unbuffer(pplayer->connections);
 }
@@ -1827,7 +1828,7 @@ struct unit *create_unit_full(struct player *pplayer, struct tile *ptile,
     fc_assert(city_owner(pcity) == pplayer);
     unit_list_prepend(pcity->units_supported, punit);
     // Refresh the unit's homecity.
-    city_refresh(pcity);
+    city_refresh_units(pcity);
     send_city_info(pplayer, pcity);
   }
 
@@ -1967,7 +1968,7 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
     player_status_add(unit_owner(punit), PSTATUS_DYING);
   }
 
-  script_server_signal_emit("unit_lost", punit, unit_owner(punit),
+  script_server_signal_emit(SSIG_UNIT_LOST, punit, unit_owner(punit),
                             unit_loss_reason_name(reason));
 
   script_server_remove_exported_object(punit);
@@ -1984,12 +1985,12 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
   sync_cities();
 
   if (phomecity) {
-    city_refresh(phomecity);
+    city_refresh_units(phomecity);
     send_city_info(city_owner(phomecity), phomecity);
   }
 
   if (pcity && pcity != phomecity) {
-    city_refresh(pcity);
+    city_refresh_units(pcity);
     send_city_info(city_owner(pcity), pcity);
   }
 
@@ -2856,6 +2857,8 @@ void send_unit_info(struct conn_list *dest, struct unit *punit)
     }
   }
   conn_list_iterate_end;
+
+  CALL_FUNC_EACH_AI(unit_info, punit);
 }
 
 /**
@@ -3010,8 +3013,7 @@ void do_nuclear_explosion(struct player *pplayer, struct tile *ptile)
   }
   square_iterate_end;
 
-  script_server_signal_emit("nuke_exploded", 2, API_TYPE_TILE, ptile,
-                            API_TYPE_PLAYER, pplayer);
+  script_server_signal_emit(SSIG_NUKE_EXPLODED, ptile, pplayer);
   notify_conn(nullptr, ptile, E_NUKE, ftc_server,
               _("The %s detonated a nuke!"),
               nation_plural_for_player(pplayer));
@@ -3099,18 +3101,19 @@ bool do_paradrop(struct unit *punit, struct tile *ptile,
   if (!map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
     // Only take in account values from player map.
     const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+    const struct player_tile_state *plrstate = plrtile->state.get();
 
     if (nullptr == plrtile->site
-        && !is_native_to_class(unit_class_get(punit), plrtile->terrain,
-                               &(plrtile->extras))) {
+        && !is_native_to_class(unit_class_get(punit), plrstate->terrain,
+                               &(plrstate->extras))) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("This unit cannot paradrop into %s."),
-                    terrain_name_translation(plrtile->terrain));
+                    terrain_name_translation(plrstate->terrain));
       return false;
     }
 
-    if (nullptr != plrtile->site && plrtile->owner != nullptr
-        && pplayers_non_attack(pplayer, plrtile->owner)) {
+    if (nullptr != plrtile->site && plrstate->owner != nullptr
+        && pplayers_non_attack(pplayer, plrstate->owner)) {
       notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                     _("Cannot attack unless you declare war first."));
       return false;
@@ -3238,13 +3241,13 @@ static void unit_enter_hut(struct unit *punit)
       /* FIXME: enable different classes
        * to behave differently with different huts */
       if (behavior == HUT_FRIGHTEN) {
-        script_server_signal_emit("hut_frighten", punit,
+        script_server_signal_emit(SSIG_HUT_FRIGHTEN, punit,
                                   extra_rule_name(pextra));
       } else if (is_ai(pplayer) && has_handicap(pplayer, H_LIMITEDHUTS)) {
         // AI with H_LIMITEDHUTS only gets 25 gold (or barbs if unlucky)
         (void) hut_get_limited(punit);
       } else {
-        script_server_signal_emit("hut_enter", punit,
+        script_server_signal_emit(SSIG_HUT_ENTER, punit,
                                   extra_rule_name(pextra));
       }
 
@@ -3673,6 +3676,16 @@ static bool unit_move_consequences(struct unit *punit, struct tile *src_tile,
     homecity_end_pos = homecity_start_pos;
   }
 
+  /* Where a unit is decides whether it is aggressive. The home cities
+   * are not always refreshed below, but their next refresh has to redo
+   * the support. */
+  if (homecity_start_pos) {
+    city_refresh_invalidate(homecity_start_pos, CRS_SUPPORT);
+  }
+  if (homecity_end_pos) {
+    city_refresh_invalidate(homecity_end_pos, CRS_SUPPORT);
+  }
+
   /* We only do refreshes for non-AI players to now make sure the AI turns
      doesn't take too long. Perhaps we should make a special refresh_city
      functions that only refreshed happines. */
@@ -3683,7 +3696,7 @@ static bool unit_move_consequences(struct unit *punit, struct tile *src_tile,
   if (tocity) { // entering a city
     if (tocity->owner == pplayer_end_pos) {
       if (tocity != homecity_end_pos && is_human(pplayer_end_pos)) {
-        city_refresh(tocity);
+        city_refresh_units(tocity);
         send_city_info(pplayer_end_pos, tocity);
       }
     }
@@ -3699,7 +3712,7 @@ static bool unit_move_consequences(struct unit *punit, struct tile *src_tile,
     if (fromcity != homecity_start_pos
         && fromcity->owner == pplayer_start_pos
         && is_human(pplayer_start_pos)) {
-      city_refresh(fromcity);
+      city_refresh_units(fromcity);
       send_city_info(pplayer_start_pos, fromcity);
     }
   }
@@ -3720,14 +3733,14 @@ static bool unit_move_consequences(struct unit *punit, struct tile *src_tile,
   }
 
   if (refresh_homecity_start_pos && is_human(pplayer_start_pos)) {
-    city_refresh(homecity_start_pos);
+    city_refresh_units(homecity_start_pos);
     send_city_info(pplayer_start_pos, homecity_start_pos);
   }
   if (refresh_homecity_end_pos
       && (!refresh_homecity_start_pos
           || homecity_start_pos != homecity_end_pos)
       && is_human(pplayer_end_pos)) {
-    city_refresh(homecity_end_pos);
+    city_refresh_units(homecity_end_pos);
     send_city_info(pplayer_end_pos, homecity_end_pos);
   }
 
@@ -3775,11 +3788,13 @@ static void check_unit_activity(struct unit *punit)
 }
 
 /**
-   Create a new unit move data, or use previous one if available.
+   Create a new unit move data, or use previous one if available. The
+   vision of the unit is moved as part of 'pvmove'.
  */
 static struct unit_move_data *unit_move_data(struct unit *punit,
                                              struct tile *psrctile,
-                                             struct tile *pdesttile)
+                                             struct tile *pdesttile,
+                                             struct vision_move *pvmove)
 {
   struct unit_move_data *pdata;
   struct player *powner = unit_owner(punit);
@@ -3837,10 +3852,11 @@ static struct unit_move_data *unit_move_data(struct unit *punit,
    * client moves the unit, and both areas are visible during the
    * move */
 
-  // Enhance vision if unit steps into a fortress
+  /* Enhance vision if unit steps into a fortress. The units moving
+   * together share the map update; see vision_move_new(). */
   new_vision = vision_new(powner, pdesttile);
   punit->server.vision = new_vision;
-  vision_change_sight(new_vision, radius_sq);
+  vision_move_add(pvmove, pdata->old_vision, new_vision, radius_sq);
   ASSERT_VISION(new_vision);
 
   return pdata;
@@ -3887,11 +3903,14 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   struct tile *psrctile;
   struct city *pcity;
   struct unit *ptransporter;
-  struct packet_unit_info src_info, dest_info;
-  struct packet_unit_short_info src_sinfo, dest_sinfo;
+  struct packet_unit_info src_info;
+  struct packet_unit_short_info src_sinfo;
+  std::vector<struct packet_unit_info> dest_info;
+  std::vector<struct packet_unit_short_info> dest_sinfo;
   struct unit_move_data_list *plist;
   struct unit_move_data *pdata;
-  int saved_id;
+  struct vision_move *pvmove;
+  int saved_id, i;
   bool unit_lives;
   bool adj;
   enum direction8 facing;
@@ -3902,6 +3921,7 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   fc_assert_ret_val(pdesttile != nullptr, false);
 
   plist = unit_move_data_list_new_full(unit_move_data_unref);
+  pvmove = vision_move_new();
   pplayer = unit_owner(punit);
   saved_id = punit->id;
   psrctile = unit_tile(punit);
@@ -3932,7 +3952,7 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   }
 
   // Make new data for 'punit'.
-  pdata = unit_move_data(punit, psrctile, pdesttile);
+  pdata = unit_move_data(punit, psrctile, pdesttile, pvmove);
   unit_move_data_list_prepend(plist, pdata);
 
   // Set unit orientation
@@ -3976,11 +3996,15 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   // Move all contained units.
   unit_cargo_iterate(punit, pcargo)
   {
-    pdata = unit_move_data(pcargo, psrctile, pdesttile);
+    pdata = unit_move_data(pcargo, psrctile, pdesttile, pvmove);
     unit_move_data_list_append(plist, pdata);
   }
   unit_cargo_iterate_end;
 
+  /* Unfog the destination for the whole stack at once, before the move is
+   * sent. */
+  vision_move_reveal(pvmove);
+
   // Get data for 'punit'.
   pdata = unit_move_data_list_front(plist);
 
@@ -4052,77 +4076,64 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
     }
   }
 
-  // Notifications of the move to the clients.
-  if (adj) {
-    /* Special case: 'punit' is moving to adjacent position. Then we show
-     * 'punit' move to all users able to see 'psrctile' or 'pdesttile'. */
-
-    // Make info packets at 'pdesttile'.
-    package_unit(punit, &dest_info);
-    package_short_unit(punit, &dest_sinfo, UNIT_INFO_IDENTITY, 0);
-
-    conn_list_iterate(game.est_connections, pconn)
-    {
-      struct player *aplayer = conn_get_player(pconn);
-
-      if (aplayer == nullptr) {
-        if (pconn->observer) {
-          // Global observers see all...
-          send_packet_unit_info(pconn, &src_info);
-          send_packet_unit_info(pconn, &dest_info);
-        }
-      } else if (BV_ISSET(pdata->can_see_move, player_index(aplayer))) {
-        if (aplayer == pplayer) {
-          send_packet_unit_info(pconn, &src_info);
-          send_packet_unit_info(pconn, &dest_info);
-        } else {
-          send_packet_unit_short_info(pconn, &src_sinfo, false);
-          send_packet_unit_short_info(pconn, &dest_sinfo, false);
-        }
-      }
-    }
-    conn_list_iterate_end;
-  }
-
-  // Other moves.
+  // Make info packets at 'pdesttile'.
+  dest_info.resize(unit_move_data_list_size(plist));
+  dest_sinfo.resize(unit_move_data_list_size(plist));
+  i = 0;
   unit_move_data_list_iterate(plist, pmove_data)
   {
-    if (adj && pmove_data == pdata) {
-      /* If positions are adjacent, we have already shown 'punit' move.
-       * See above. */
-      continue;
-    }
+    package_unit(pmove_data->punit, &dest_info[i]);
+    package_short_unit(pmove_data->punit, &dest_sinfo[i],
+                       UNIT_INFO_IDENTITY, 0);
+    i++;
+  }
+  unit_move_data_list_iterate_end;
 
-    // Make info packets at 'pdesttile'.
-    package_unit(pmove_data->punit, &dest_info);
-    package_short_unit(pmove_data->punit, &dest_sinfo, UNIT_INFO_IDENTITY,
-                       0);
+  /* Notifications of the move to the clients. Each connection gets the
+   * moves of the whole stack in one go. */
+  conn_list_iterate(game.est_connections, pconn)
+  {
+    struct player *aplayer = conn_get_player(pconn);
 
-    conn_list_iterate(game.est_connections, pconn)
+    i = 0;
+    unit_move_data_list_iterate(plist, pmove_data)
     {
-      struct player *aplayer = conn_get_player(pconn);
+      /* Special case: 'punit' is moving to adjacent position. Then we show
+       * 'punit' move from 'psrctile' to all users able to see 'psrctile'
+       * or 'pdesttile'. */
+      bool from_src = (adj && pmove_data == pdata);
 
       if (aplayer == nullptr) {
         if (pconn->observer) {
           // Global observers see all...
-          send_packet_unit_info(pconn, &dest_info);
+          if (from_src) {
+            send_packet_unit_info(pconn, &src_info);
+          }
+          send_packet_unit_info(pconn, &dest_info[i]);
         }
       } else if (BV_ISSET(pmove_data->can_see_move, player_index(aplayer))) {
         if (aplayer == pmove_data->powner) {
-          send_packet_unit_info(pconn, &dest_info);
+          if (from_src) {
+            send_packet_unit_info(pconn, &src_info);
+          }
+          send_packet_unit_info(pconn, &dest_info[i]);
         } else {
-          send_packet_unit_short_info(pconn, &dest_sinfo, false);
+          if (from_src) {
+            send_packet_unit_short_info(pconn, &src_sinfo, false);
+          }
+          send_packet_unit_short_info(pconn, &dest_sinfo[i], false);
         }
       }
+      i++;
     }
-    conn_list_iterate_end;
+    unit_move_data_list_iterate_end;
   }
-  unit_move_data_list_iterate_end;
+  conn_list_iterate_end;
 
   // Clear old vision.
+  vision_move_finish(pvmove);
   unit_move_data_list_iterate(plist, pmove_data)
   {
-    vision_clear_sight(pmove_data->old_vision);
     vision_free(pmove_data->old_vision);
     pmove_data->old_vision = nullptr;
   }
@@ -4198,6 +4209,16 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   }
   unit_move_data_list_iterate_rev_end;
 
+  /* The moving unit is reported to the AI types below, its cargo is not
+   * sent with send_unit_info(). */
+  unit_move_data_list_iterate(plist, pmove_data)
+  {
+    if (pmove_data != pdata && pmove_data->punit != nullptr) {
+      CALL_FUNC_EACH_AI(unit_info, pmove_data->punit);
+    }
+  }
+  unit_move_data_list_iterate_end;
+
   /* Inform the owner's client about actor unit arrival. Can, depending on
    * the client settings, cause the client to start the process that makes
    * the action selection dialog pop up. */
@@ -4286,7 +4307,7 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
 
   if (unit_lives) {
     // Let the scripts run ...
-    script_server_signal_emit("unit_moved", punit, psrctile, pdesttile);
+    script_server_signal_emit(SSIG_UNIT_MOVED, punit, psrctile, pdesttile);
     unit_lives = unit_is_alive(saved_id);
   }
 
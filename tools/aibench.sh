@@ -0,0 +1,73 @@
+#!/bin/bash
+#/**********************************************************************
+# Freeciv21 - Copyright (C) 2020 Freeciv21 and Freeciv contributors
+#   This program is free software; you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation; either version 3, or (at your option)
+#   any later version.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#***********************************************************************/
+
+# Compares the end of turn latency of AI types. Plays the same autogame
+# once for each AI type, with all players of that type, and reports the
+# "End phase" and "End turn" times of freeciv21-server --timetrack.
+#
+# Usage: aibench.sh SERVER [TURNS] [PLAYERS] [AI types...]
+#
+# The server must be built with FREECIV_DEBUG, as the autogame mode
+# (timeout -1) is only available there. The AI types default to
+# "classic threaded".
+
+if test "x$1" = "x" ; then
+  echo "Usage: $0 SERVER [TURNS] [PLAYERS] [AI types...]" >&2
+  exit 1
+fi
+
+SERVER="$1"
+shift
+TURNS="${1:-100}"
+test $# -gt 0 && shift
+PLAYERS="${1:-8}"
+test $# -gt 0 && shift
+AITYPES="${*:-classic threaded}"
+WORKDIR="$(mktemp -d)"
+trap 'rm -rf "$WORKDIR"' EXIT
+
+stats() {
+  # Count, mean and maximum of the milliseconds of the given log lines.
+  grep -o "$1:[0-9]*" "$2" | cut -d: -f2 \
+    | awk '{ n++; s += $1; if ($1 > m) m = $1 }
+           END { if (!n) { printf "no data"; exit }
+                 printf "%d samples, mean %.1f ms, max %d ms", n, s / n, m }'
+}
+
+for AITYPE in $AITYPES
+do
+  SERV="$WORKDIR/$AITYPE.serv"
+  LOG="$WORKDIR/$AITYPE.log"
+
+  {
+    echo "set timeout -1"
+    echo "set minplayers 0"
+    echo "set aifill 0"
+    echo "set mapseed 1"
+    echo "set gameseed 1"
+    echo "set endturn $TURNS"
+    for i in $(seq "$PLAYERS") ; do
+      echo "create AI$i $AITYPE"
+    done
+    echo "start"
+  } > "$SERV"
+
+  "$SERVER" --timetrack --exit-on-end --saves "$WORKDIR" \
+            --read "$SERV" > "$LOG" 2>&1 < /dev/null
+
+  echo "$AITYPE:"
+  echo "  End phase: $(stats "End phase" "$LOG")"
+  echo "  End turn:  $(stats "End turn" "$LOG")"
+done
@@ -0,0 +1,241 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+/* Benchmark of genhash, using the access pattern of the delta caches of
+ * the generated packet code. Every send_packet_tile_info() and
+ * send_packet_unit_info() looks up the previously sent packet by its key
+ * and inserts a copy on the first send; removing a unit cancels its
+ * cached unit_info. */
+
+#include <fc_config.h>
+
+#include <cstdlib>
+#include <cstring>
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+
+// utility
+#include "genhash.h"
+#include "log.h"
+#include "rand.h"
+#include "shared.h"
+#include "version.h"
+
+/* Stands in for a delta packet: one key field and a payload of about the
+ * size of packet_tile_info. */
+struct bench_packet {
+  int key;
+  char payload[60];
+};
+
+// Timings of one run of a pattern.
+struct bench_result {
+  qint64 nsecs;
+  long ops;
+};
+
+static int rounds_selected = 100;
+
+/**
+   Same as the generated hash function of a packet with one key field.
+ */
+static genhash_val_t hash_bench_packet(const void *vkey)
+{
+  const struct bench_packet *key = (const struct bench_packet *) vkey;
+
+  return key->key;
+}
+
+/**
+   Same as the generated comparison function of a packet with one key
+   field.
+ */
+static bool cmp_bench_packet(const void *vkey1, const void *vkey2)
+{
+  const struct bench_packet *key1 = (const struct bench_packet *) vkey1;
+  const struct bench_packet *key2 = (const struct bench_packet *) vkey2;
+
+  return key1->key == key2->key;
+}
+
+/**
+   Does what the generated send function does with the delta cache.
+ */
+static void bench_send(struct genhash *hash,
+                       const struct bench_packet *real_packet)
+{
+  struct bench_packet *old;
+
+  if (!genhash_lookup(hash, real_packet, (void **) &old)) {
+    old = new bench_packet;
+    *old = *real_packet;
+    genhash_insert(hash, old, old);
+    memset(old, 0, sizeof(*old));
+  }
+  *old = *real_packet;
+}
+
+/**
+   Frees a cached packet.
+ */
+static void bench_free(void *ptr) { delete (struct bench_packet *) ptr; }
+
+/**
+   Tile info pattern: all the tiles of the map are sent once, then each
+   round sends a random tenth of them again, as vision changes do.
+ */
+static struct bench_result bench_tiles(int ntiles)
+{
+  struct genhash *hash = genhash_new_full(
+      hash_bench_packet, cmp_bench_packet, nullptr, nullptr, nullptr,
+      bench_free);
+  struct bench_packet packet;
+  struct bench_result result = {0, 0};
+  QElapsedTimer timer;
+  int i, round;
+
+  memset(&packet, 0, sizeof(packet));
+  timer.start();
+  for (i = 0; i < ntiles; i++) {
+    packet.key = i;
+    bench_send(hash, &packet);
+  }
+  result.ops += ntiles;
+  for (round = 0; round < rounds_selected; round++) {
+    for (i = 0; i < ntiles / 10; i++) {
+      packet.key = fc_rand(ntiles);
+      packet.payload[0] = round;
+      bench_send(hash, &packet);
+    }
+    result.ops += ntiles / 10;
+  }
+  result.nsecs = timer.nsecsElapsed();
+
+  genhash_destroy(hash);
+  return result;
+}
+
+/**
+   Unit info pattern: every unit is sent once per round as it moves. Each
+   round a few units die, cancelling their cached info, and as many new
+   ones with higher ids are built.
+ */
+static struct bench_result bench_units(int nunits)
+{
+  struct genhash *hash = genhash_new_full(
+      hash_bench_packet, cmp_bench_packet, nullptr, nullptr, nullptr,
+      bench_free);
+  QVector<int> ids(nunits);
+  struct bench_packet packet;
+  struct bench_result result = {0, 0};
+  QElapsedTimer timer;
+  int next_id = 1;
+  int i, round;
+
+  for (i = 0; i < nunits; i++) {
+    ids[i] = next_id++;
+  }
+
+  memset(&packet, 0, sizeof(packet));
+  timer.start();
+  for (round = 0; round < rounds_selected; round++) {
+    for (i = 0; i < nunits; i++) {
+      packet.key = ids[i];
+      packet.payload[0] = round;
+      bench_send(hash, &packet);
+    }
+    result.ops += nunits;
+    for (i = 0; i < nunits / 20 + 1; i++) {
+      int victim = fc_rand(nunits);
+
+      packet.key = ids[victim];
+      genhash_remove(hash, &packet);
+      ids[victim] = next_id++;
+    }
+    result.ops += nunits / 20 + 1;
+  }
+  result.nsecs = timer.nsecsElapsed();
+
+  genhash_destroy(hash);
+  return result;
+}
+
+/**
+   Parse freeciv21-genhashbench commandline parameters.
+ */
+static void genhashbench_parse_cmdline(const QCoreApplication &app)
+{
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  parser.addVersionOption();
+
+  bool ok = parser.addOptions({
+      {{"r", "rounds"},
+       QStringLiteral("Number of rounds of each pattern (default 100)"),
+       QStringLiteral("N")},
+  });
+  if (!ok) {
+    qFatal("Adding command line arguments failed");
+    exit(EXIT_FAILURE);
+  }
+
+  // Parse
+  parser.process(app);
+
+  // Process the parsed options
+  if (parser.isSet(QStringLiteral("rounds"))) {
+    rounds_selected = parser.value(QStringLiteral("rounds")).toInt(&ok);
+    if (!ok || rounds_selected <= 0) {
+      qCritical("Invalid number of rounds: %s",
+                qUtf8Printable(parser.value(QStringLiteral("rounds"))));
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+/**
+   Main entry point for freeciv21-genhashbench
+ */
+int main(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationVersion(freeciv21_version());
+  // Tiles of the small, normal and huge map sizes; units of a few players.
+  const int sizes[] = {1000, 4000, 16000, 64000};
+
+  log_init();
+
+  genhashbench_parse_cmdline(app);
+
+  for (const int size : sizes) {
+    struct bench_result result;
+
+    fc_srand(size);
+    result = bench_tiles(size);
+    qInfo("tile_info %6d: %8.1f ns/op", size,
+          double(result.nsecs) / result.ops);
+
+    fc_srand(size);
+    result = bench_units(size / 10);
+    qInfo("unit_info %6d: %8.1f ns/op", size / 10,
+          double(result.nsecs) / result.ops);
+  }
+
+  log_close();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#include <fc_config.h>
+
+#include <cstdlib>
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// utility
+#include "fcintl.h"
+#include "log.h"
+#include "shared.h"
+#include "version.h"
+
+// common
+#include "mapimg.h"
+
+static QString stream_selected;
+static QString output_selected;
+
+/**
+   Parse freeciv21-mapframes commandline parameters.
+ */
+static void mapframes_parse_cmdline(const QCoreApplication &app)
+{
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  parser.addVersionOption();
+  parser.addPositionalArgument(_("stream"),
+                               _("Map image stream to convert"));
+
+  bool ok = parser.addOptions({
+      {{"F", "Fatal"}, _("Raise a signal on failed assertion")},
+      {{"o", "output"},
+       _("Prefix of the images; defaults to the stream name"),
+       // TRANS: Command-line argument
+       _("PREFIX")},
+  });
+  if (!ok) {
+    qFatal("Adding command line arguments failed");
+    exit(EXIT_FAILURE);
+  }
+
+  // Parse
+  parser.process(app);
+
+  // Process the parsed options
+  fc_assert_set_fatal(parser.isSet(QStringLiteral("Fatal")));
+  if (parser.positionalArguments().size() != 1) {
+    parser.showHelp(EXIT_FAILURE);
+  }
+  stream_selected = parser.positionalArguments().at(0);
+  if (parser.isSet(QStringLiteral("output"))) {
+    output_selected = parser.value(QStringLiteral("output"));
+  } else {
+    output_selected = QFileInfo(stream_selected).completeBaseName();
+  }
+}
+
+/**
+   Write one frame as ppm file. A file that could not be written
+   completely is removed.
+ */
+static bool mapframes_write(const QString &filename, const QByteArray &title,
+                            const QByteArray &rgb, int width, int height,
+                            int zoom)
+{
+  QSaveFile file(filename);
+  int x, y, z;
+
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCritical(_("Could not open file: %s"), qUtf8Printable(filename));
+    return false;
+  }
+
+  file.write(QStringLiteral("P6\n# %1\n%2 %3\n255\n")
+                 .arg(QString::fromUtf8(title))
+                 .arg(width * zoom)
+                 .arg(height * zoom)
+                 .toUtf8());
+  for (y = 0; y < height; y++) {
+    QByteArray row;
+
+    row.reserve(width * zoom * 3);
+    for (x = 0; x < width; x++) {
+      for (z = 0; z < zoom; z++) {
+        row.append(rgb.constData() + (y * width + x) * 3, 3);
+      }
+    }
+    for (z = 0; z < zoom; z++) {
+      file.write(row);
+    }
+  }
+
+  // Only replaces the file if everything could be written.
+  return file.commit();
+}
+
+/**
+   Replay the stream and write every frame as image. Returns the number of
+   frames written or -1 on error.
+ */
+static int mapframes_convert(const QString &streamname,
+                             const QString &prefix)
+{
+  QFile file(streamname);
+  QByteArray magic(qstrlen(MAPIMG_DELTA_MAGIC), '\0');
+  QByteArray maparg, rgb;
+  quint32 version;
+  int frames = 0;
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    qCritical(_("Could not open file: %s"), qUtf8Printable(streamname));
+    return -1;
+  }
+
+  QDataStream in(&file);
+  in.readRawData(magic.data(), magic.size());
+  in >> version >> maparg;
+  if (magic != MAPIMG_DELTA_MAGIC || version != MAPIMG_DELTA_VERSION) {
+    qCritical(_("%s is not a map image stream."),
+              qUtf8Printable(streamname));
+    return -1;
+  }
+  qInfo(_("Map definition: %s"), maparg.constData());
+
+  while (!in.atEnd()) {
+    quint8 type;
+    qint32 turn, width, height, zoom;
+    QByteArray title, compressed, data;
+
+    in >> type >> turn >> title >> width >> height >> zoom >> compressed;
+    if (in.status() != QDataStream::Ok || width <= 0 || height <= 0
+        || zoom <= 0) {
+      qCritical(_("%s: frame %d is truncated."), qUtf8Printable(streamname),
+                frames);
+      return -1;
+    }
+    data = qUncompress(compressed);
+
+    if (type == MAPIMG_DELTA_KEYFRAME) {
+      if (data.size() != width * height * 3) {
+        qCritical(_("%s: keyframe %d has the wrong size."),
+                  qUtf8Printable(streamname), frames);
+        return -1;
+      }
+      rgb = data;
+    } else if (type == MAPIMG_DELTA_FRAME
+               && rgb.size() == width * height * 3) {
+      QDataStream runs(data);
+      quint32 npixels = quint32(width * height);
+
+      while (!runs.atEnd()) {
+        quint32 start, length;
+
+        runs >> start >> length;
+        // Written this way so that start + length cannot overflow.
+        if (runs.status() != QDataStream::Ok || length > npixels
+            || start > npixels - length) {
+          qCritical(_("%s: frame %d is corrupted."),
+                    qUtf8Printable(streamname), frames);
+          return -1;
+        }
+        if (runs.readRawData(rgb.data() + start * 3, length * 3)
+            != int(length * 3)) {
+          qCritical(_("%s: frame %d is truncated."),
+                    qUtf8Printable(streamname), frames);
+          return -1;
+        }
+      }
+    } else {
+      qCritical(_("%s: frame %d does not follow a keyframe."),
+                qUtf8Printable(streamname), frames);
+      return -1;
+    }
+
+    if (!mapframes_write(QStringLiteral("%1-%2.ppm")
+                             .arg(prefix)
+                             .arg(frames, 5, 10, QLatin1Char('0')),
+                         title, rgb, width, height, zoom)) {
+      return -1;
+    }
+    log_debug("frame %d: turn %d", frames, turn);
+    frames++;
+  }
+
+  return frames;
+}
+
+/**
+   Main entry point for freeciv21-mapframes
+ */
+int main(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationVersion(freeciv21_version());
+  int frames;
+
+  log_init();
+
+  init_nls();
+
+  mapframes_parse_cmdline(app);
+
+  frames = mapframes_convert(stream_selected, output_selected);
+  if (frames >= 0) {
+    qInfo(_("Wrote %d images."), frames);
+  }
+
+  log_close();
+  free_nls();
+
+  return frames >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
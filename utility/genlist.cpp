@@ -12,6 +12,11 @@
       \____/        ********************************************************/
 
 #include <cstdlib>
+#include <new>
+#include <vector>
+
+// Qt
+#include <QMutexLocker>
 
 // utility
 #include "fcthread.h"
@@ -19,6 +24,67 @@
 #include "rand.h"
 
 #include "genlist.h"
+
+// Number of lists or links carved out of one allocation.
+#define GENLIST_SLAB_SIZE 256
+
+/* A free list of fixed size blocks. The pointer to the next free block is
+ * stored in the block itself. */
+struct genlist_pool {
+  void *free_block;
+};
+
+/* The pools are shared by all threads, so that a block freed on a worker
+ * thread is reused by the next list created anywhere. */
+static struct genlist_pool list_pool = {nullptr};
+static struct genlist_pool link_pool = {nullptr};
+
+/* Protects both pools and the slabs, never freed: lists are still
+ * destroyed by the destructors of static objects at exit. */
+static QBasicMutex genlist_pool_mutex;
+static std::vector<void *> *genlist_slabs = nullptr;
+
+/**
+   Take a block of the given size from the pool, allocating a new slab if
+   the pool is empty.
+ */
+static void *genlist_pool_alloc(struct genlist_pool *pool, size_t size)
+{
+  QMutexLocker locker(&genlist_pool_mutex);
+  void *block;
+
+  if (nullptr == pool->free_block) {
+    char *slab = static_cast<char *>(::operator new(size
+                                                    * GENLIST_SLAB_SIZE));
+    int i;
+
+    if (nullptr == genlist_slabs) {
+      genlist_slabs = new std::vector<void *>;
+    }
+    genlist_slabs->push_back(slab);
+
+    for (i = GENLIST_SLAB_SIZE - 1; i >= 0; i--) {
+      *reinterpret_cast<void **>(slab + i * size) = pool->free_block;
+      pool->free_block = slab + i * size;
+    }
+  }
+
+  block = pool->free_block;
+  pool->free_block = *static_cast<void **>(block);
+  return block;
+}
+
+/**
+   Give a block back to the pool.
+ */
+static void genlist_pool_free(struct genlist_pool *pool, void *block)
+{
+  QMutexLocker locker(&genlist_pool_mutex);
+
+  *static_cast<void **>(block) = pool->free_block;
+  pool->free_block = block;
+}
+
 /**
    Create a new empty genlist.
  */
@@ -29,9 +95,12 @@ struct genlist *genlist_new() { return genlist_new_full(nullptr); }
  */
 struct genlist *genlist_new_full(genlist_free_fn_t free_data_func)
 {
-  genlist *pgenlist = new genlist;
+  genlist *pgenlist = new (genlist_pool_alloc(&list_pool, sizeof(genlist)))
+      genlist;
 
   pgenlist->nelements = 0;
+  pgenlist->inline_used = false;
+  pgenlist->mutex.storeRelaxed(nullptr);
   pgenlist->head_link = nullptr;
   pgenlist->tail_link = nullptr;
   pgenlist->free_data_func = free_data_func;
@@ -49,7 +118,37 @@ void genlist_destroy(struct genlist *pgenlist)
   }
 
   genlist_clear(pgenlist);
-  delete pgenlist;
+  delete pgenlist->mutex.loadRelaxed();
+  pgenlist->~genlist();
+  genlist_pool_free(&list_pool, pgenlist);
+}
+
+/**
+   Returns storage for a new link of the list: the inline link if it is
+   free, else a block of the link pool.
+ */
+static inline struct genlist_link *
+genlist_link_alloc(struct genlist *pgenlist)
+{
+  if (!pgenlist->inline_used) {
+    pgenlist->inline_used = true;
+    return &pgenlist->inline_link;
+  }
+  return static_cast<struct genlist_link *>(
+      genlist_pool_alloc(&link_pool, sizeof(struct genlist_link)));
+}
+
+/**
+   Releases the storage of a link, see genlist_link_alloc().
+ */
+static inline void genlist_link_free(struct genlist *pgenlist,
+                                     struct genlist_link *plink)
+{
+  if (plink == &pgenlist->inline_link) {
+    pgenlist->inline_used = false;
+  } else {
+    genlist_pool_free(&link_pool, plink);
+  }
 }
 
 /**
@@ -59,7 +158,7 @@ static void genlist_link_new(struct genlist *pgenlist, void *dataptr,
                              struct genlist_link *prev,
                              struct genlist_link *next)
 {
-  genlist_link *plink = new genlist_link;
+  genlist_link *plink = genlist_link_alloc(pgenlist);
 
   plink->dataptr = dataptr;
   plink->prev = prev;
@@ -102,7 +201,7 @@ static void genlist_link_destroy(struct genlist *pgenlist,
   if (nullptr != pgenlist->free_data_func) {
     pgenlist->free_data_func(plink->dataptr);
   }
-  delete plink;
+  genlist_link_free(pgenlist, plink);
 }
 
 /**
@@ -252,12 +351,12 @@ void genlist_clear(struct genlist *pgenlist)
       do {
         plink2 = plink->next;
         free_data_func(plink->dataptr);
-        delete plink;
+        genlist_link_free(pgenlist, plink);
       } while (nullptr != (plink = plink2));
     } else {
       do {
         plink2 = plink->next;
-        delete plink;
+        genlist_link_free(pgenlist, plink);
       } while (nullptr != (plink = plink2));
     }
   }
@@ -671,11 +770,24 @@ void genlist_reverse(struct genlist *pgenlist)
 }
 
 /**
-   Allocates list mutex
+   Allocates list mutex. The mutex is created on first use; most lists are
+   never locked.
  */
 void genlist_allocate_mutex(struct genlist *pgenlist)
 {
-  pgenlist->mutex.lock();
+  QMutex *mutex = pgenlist->mutex.loadAcquire();
+
+  if (nullptr == mutex) {
+    QMutex *created = new QMutex;
+
+    if (pgenlist->mutex.testAndSetOrdered(nullptr, created, mutex)) {
+      mutex = created;
+    } else {
+      // Another thread was faster.
+      delete created;
+    }
+  }
+  mutex->lock();
 }
 
 /**
@@ -683,5 +795,8 @@ void genlist_allocate_mutex(struct genlist *pgenlist)
  */
 void genlist_release_mutex(struct genlist *pgenlist)
 {
-  pgenlist->mutex.unlock();
+  QMutex *mutex = pgenlist->mutex.loadAcquire();
+
+  fc_assert_ret(nullptr != mutex);
+  mutex->unlock();
 }
@@ -30,31 +30,45 @@
   iterator is active, in particular removing the next element pointed
   to by the iterator (see further comments below).
 
+  Lists and links are taken from slab allocated pools, and the first link
+  of every list is stored inline, so most lists of zero or one element
+  (like the units on a tile) never call the allocator. The mutex of a
+  list is only created the first time it is locked.
+
   See also the speclist module.
 ****************************************************************************/
 
+// Qt
+#include <QAtomicPointer>
+
 // utility
 #include "fcthread.h"
 #include "support.h" // bool, fc__warn_unused_result
 
-// A single element of a genlist, opaque type.
-struct genlist_link;
-
 // Function type definitions.
 typedef void (*genlist_free_fn_t)(void *);
 typedef void *(*genlist_copy_fn_t)(const void *);
 typedef bool (*genlist_cond_fn_t)(const void *);
 typedef bool (*genlist_comp_fn_t)(const void *, const void *);
 
+/* A single element of a genlist, storing the pointer to user
+ * data, and pointers to the next and previous elements: */
+struct genlist_link {
+  struct genlist_link *next, *prev;
+  void *dataptr;
+};
+
 /* A genlist, storing the number of elements (for quick retrieval and
  * testing for empty lists), and pointers to the first and last elements
  * of the list. */
 struct genlist {
   int nelements;
-  QMutex mutex;
+  bool inline_used;
+  QAtomicPointer<QMutex> mutex; // See genlist_allocate_mutex()
   struct genlist_link *head_link;
   struct genlist_link *tail_link;
   genlist_free_fn_t free_data_func;
+  struct genlist_link inline_link; // Used before the pool, if free
 };
 
 struct genlist *genlist_new() fc__warn_unused_result;
@@ -119,13 +133,6 @@ void genlist_reverse(struct genlist *pgenlist);
 void genlist_allocate_mutex(struct genlist *pgenlist);
 void genlist_release_mutex(struct genlist *pgenlist);
 
-/* A single element of a genlist, storing the pointer to user
- * data, and pointers to the next and previous elements: */
-struct genlist_link {
-  struct genlist_link *next, *prev;
-  void *dataptr;
-};
-
 /****************************************************************************
   Returns the pointer of this link.
 ****************************************************************************/
@@ -148,6 +148,23 @@
   - The number of entries is fixed when the hash table is built.
   - Now uses hash.c
  */
+#include <fc_config.h>
+
+#ifdef FREECIV_HAVE_LZMA_MT
+#include <lzma.h>
+#endif
+#ifdef FREECIV_HAVE_ZSTD_MT
+#include <zstd.h>
+#endif
+
+// Qt
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
 // KArchive
 #include <KFilterDev>
 
@@ -161,6 +178,7 @@
 #include "section_file.h"
 #include "shared.h"
 #include "support.h"
+#include "timing.h"
 
 #include "registry_ini.h"
 
@@ -169,6 +187,12 @@
 // Set to FALSE for old-style savefiles.
 #define SAVE_TABLES true
 
+// Files with fewer sections are formatted on the calling thread.
+#define SAVE_PARALLEL_SECTIONS 16
+
+// Formats the sections of big files.
+Q_GLOBAL_STATIC(QThreadPool, save_pool)
+
 static inline bool entry_used(const struct entry *pentry);
 static inline void entry_use(struct entry *pentry);
 
@@ -593,6 +617,320 @@ static bool is_legal_table_entry_name(char c, bool num)
   return (num ? QChar::isLetterOrNumber(c) : QChar::isLetter(c)) || c == '_';
 }
 
+/**
+   Writes one section in the registry format to the given device.
+   real_filename is only used in warnings. Only reads the section, so
+   different sections can be written from different threads.
+ */
+static bool section_to_file(const struct section *psection, QIODevice *fs,
+                            const char *real_filename)
+{
+  char pentry_name[128];
+  const char *col_entry_name;
+  const struct entry_list_link *ent_iter, *save_iter, *col_iter;
+  struct entry *pentry, *col_pentry;
+  int i;
+
+  if (psection->special == EST_INCLUDE) {
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
+      fc_assert(!strcmp(entry_name(pentry), "file"));
+
+      fc_assert_ret_val(fs->write("*include ") > 0, false);
+      fc_assert_ret_val(entry_to_file(pentry, fs), false);
+      fc_assert_ret_val(fs->write("\n") > 0, false);
+    }
+  } else if (psection->special == EST_COMMENT) {
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
+      fc_assert(!strcmp(entry_name(pentry), "comment"));
+
+      fc_assert_ret_val(entry_to_file(pentry, fs), false);
+      fc_assert_ret_val(fs->write("\n") > 0, false);
+    }
+  } else {
+    fc_assert_ret_val(fs->write("\n[") > 0, false);
+    fc_assert_ret_val(fs->write(section_name(psection)) > 0, false);
+    fc_assert_ret_val(fs->write("]\n") > 0, false);
+
+    /* Following doesn't use entry_list_iterate() because we want to do
+     * tricky things with the iterators...
+     */
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
+      const char *comment;
+
+      /* Tables: break out of this loop if this is a non-table
+       * entry (pentry and ent_iter unchanged) or after table (pentry
+       * and ent_iter suitably updated, pentry possibly nullptr).
+       * After each table, loop again in case the next entry
+       * is another table.
+       */
+      for (;;) {
+        char *c, *first, base[64];
+        int offset, irow, icol, ncol;
+
+        /* Example: for first table name of "xyz0.blah":
+         *  first points to the original string pentry->name
+         *  base contains "xyz";
+         *  offset = 5 (so first+offset gives "blah")
+         *  note qstrlen(base) = offset - 2
+         */
+
+        if (!SAVE_TABLES) {
+          break;
+        }
+
+        sz_strlcpy(pentry_name, entry_name(pentry));
+        c = first = pentry_name;
+        if (*c == '\0' || !is_legal_table_entry_name(*c, false)) {
+          break;
+        }
+        for (; *c != '\0' && is_legal_table_entry_name(*c, false); c++) {
+          // nothing
+        }
+        if (0 != strncmp(c, "0.", 2)) {
+          break;
+        }
+        c += 2;
+        if (*c == '\0' || !is_legal_table_entry_name(*c, true)) {
+          break;
+        }
+
+        offset = c - first;
+        first[offset - 2] = '\0';
+        sz_strlcpy(base, first);
+        first[offset - 2] = '0';
+        fc_assert_ret_val(fs->write(base) > 0, false);
+        fc_assert_ret_val(fs->write("={") > 0, false);
+
+        /* Save an iterator at this first entry, which we can later use
+         * to repeatedly iterate over column names:
+         */
+        save_iter = ent_iter;
+
+        // write the column names, and calculate ncol:
+        ncol = 0;
+        col_iter = save_iter;
+        for (; (col_pentry = entry_list_link_data(col_iter));
+             col_iter = entry_list_link_next(col_iter)) {
+          col_entry_name = entry_name(col_pentry);
+          if (strncmp(col_entry_name, first, offset) != 0) {
+            break;
+          }
+          fc_assert_ret_val(fs->write(ncol == 0 ? "\"" : ",\"") > 0,
+                            false);
+          fc_assert_ret_val(fs->write(col_entry_name + offset) > 0, false);
+          fc_assert_ret_val(fs->write("\"") > 0, false);
+          ncol++;
+        }
+        fc_assert_ret_val(fs->write("\n") > 0, false);
+
+        /* Iterate over rows and columns, incrementing ent_iter as we go,
+         * and writing values to the table.  Have a separate iterator
+         * to the column names to check they all match.
+         */
+        irow = icol = 0;
+        col_iter = save_iter;
+        for (;;) {
+          char expect[128]; // pentry->name we're expecting
+
+          pentry = entry_list_link_data(ent_iter);
+          col_pentry = entry_list_link_data(col_iter);
+
+          fc_snprintf(expect, sizeof(expect), "%s%d.%s", base, irow,
+                      entry_name(col_pentry) + offset);
+
+          // break out of tabular if doesn't match:
+          if ((!pentry) || (strcmp(entry_name(pentry), expect) != 0)) {
+            if (icol != 0) {
+              /* If the second or later row of a table is missing some
+               * entries that the first row had, we drop out of the tabular
+               * format.  This is inefficient so we print a warning
+               * message; the calling code probably needs to be fixed so
+               * that it can use the more efficient tabular format.
+               *
+               * FIXME: If the first row is missing some entries that the
+               * second or later row has, then we'll drop out of tabular
+               * format without an error message. */
+              qCCritical(
+                  bugs_category,
+                  "In file %s, there is no entry in the registry for\n"
+                  "%s.%s (or the entries are out of order). This means\n"
+                  "a less efficient non-tabular format will be used.\n"
+                  "To avoid this make sure all rows of a table are\n"
+                  "filled out with an entry for every column.",
+                  real_filename, section_name(psection), expect);
+              fc_assert_ret_val(fs->write("\n") > 0, false);
+            }
+            fc_assert_ret_val(fs->write("}\n") > 0, false);
+            break;
+          }
+
+          if (icol > 0) {
+            fc_assert_ret_val(fs->write(",") > 0, false);
+          }
+          fc_assert_ret_val(entry_to_file(pentry, fs), false);
+
+          ent_iter = entry_list_link_next(ent_iter);
+          col_iter = entry_list_link_next(col_iter);
+
+          icol++;
+          if (icol == ncol) {
+            fc_assert_ret_val(fs->write("\n") > 0, false);
+            irow++;
+            icol = 0;
+            col_iter = save_iter;
+          }
+        }
+        if (!pentry) {
+          break;
+        }
+      }
+      if (!pentry) {
+        break;
+      }
+
+      // Classic entry.
+      col_entry_name = entry_name(pentry);
+      fc_assert_ret_val(fs->write(col_entry_name), false);
+      fc_assert_ret_val(fs->write("="), false);
+      fc_assert_ret_val(entry_to_file(pentry, fs), false);
+
+      // Check for vector.
+      for (i = 1;; i++) {
+        col_iter = entry_list_link_next(ent_iter);
+        col_pentry = entry_list_link_data(col_iter);
+        if (nullptr == col_pentry) {
+          break;
+        }
+        fc_snprintf(pentry_name, sizeof(pentry_name), "%s,%d",
+                    col_entry_name, i);
+        if (0 != strcmp(pentry_name, entry_name(col_pentry))) {
+          break;
+        }
+        fc_assert_ret_val(fs->write(",") > 0, false);
+        fc_assert_ret_val(entry_to_file(col_pentry, fs), false);
+        ent_iter = col_iter;
+      }
+
+      comment = entry_comment(pentry);
+      if (comment) {
+        fc_assert_ret_val(fs->write("  # ") > 0, false);
+        fc_assert_ret_val(fs->write(comment) > 0, false);
+        fc_assert_ret_val(fs->write("\n") > 0, false);
+      } else {
+        fc_assert_ret_val(fs->write("\n") > 0, false);
+      }
+    }
+  }
+
+  return true;
+}
+
+#ifdef FREECIV_HAVE_LZMA_MT
+/**
+   Compresses the buffers in order into one xz stream, using all cores.
+   Unlike KFilterDev, the encoder splits the data into blocks and
+   compresses them in parallel. The result is a normal xz file.
+ */
+static bool buffers_to_xz(const QVector<QByteArray> &buffers, QIODevice *fs)
+{
+  lzma_stream strm = LZMA_STREAM_INIT;
+  lzma_mt mt = {};
+  QByteArray out(64 * 1024, Qt::Uninitialized);
+  lzma_ret ret = LZMA_OK;
+
+  mt.threads = qMax(1, QThread::idealThreadCount());
+  /* The default block size is three times the dictionary, larger than
+   * most savegames. Smaller blocks keep every thread busy. */
+  mt.block_size = 2 * 1024 * 1024;
+  mt.preset = LZMA_PRESET_DEFAULT;
+  mt.check = LZMA_CHECK_CRC32;
+  if (lzma_stream_encoder_mt(&strm, &mt) != LZMA_OK) {
+    return false;
+  }
+
+  for (int i = 0; i <= buffers.size() && ret == LZMA_OK; i++) {
+    bool finish = (i == buffers.size());
+
+    if (!finish && buffers[i].isEmpty()) {
+      continue;
+    }
+    if (!finish) {
+      strm.next_in = reinterpret_cast<const uint8_t *>(buffers[i].data());
+      strm.avail_in = buffers[i].size();
+    }
+    do {
+      strm.next_out = reinterpret_cast<uint8_t *>(out.data());
+      strm.avail_out = out.size();
+      ret = lzma_code(&strm, finish ? LZMA_FINISH : LZMA_RUN);
+      if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+        break;
+      }
+      if (fs->write(out.constData(), out.size() - strm.avail_out)
+          != qint64(out.size() - strm.avail_out)) {
+        ret = LZMA_PROG_ERROR;
+        break;
+      }
+    } while (strm.avail_in > 0 || (finish && ret != LZMA_STREAM_END));
+  }
+  lzma_end(&strm);
+
+  return ret == LZMA_STREAM_END;
+}
+#endif // FREECIV_HAVE_LZMA_MT
+
+#ifdef FREECIV_HAVE_ZSTD_MT
+/**
+   Compresses the buffers in order into one zstd frame. The library
+   compresses with worker threads when it was built with them. The result
+   is a normal zstd file.
+ */
+static bool buffers_to_zstd(const QVector<QByteArray> &buffers,
+                            QIODevice *fs)
+{
+  ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  QByteArray out(ZSTD_CStreamOutSize(), Qt::Uninitialized);
+  size_t remaining = 0;
+  bool ok = (cctx != nullptr);
+
+  if (ok) {
+    // Fails harmlessly if the library has no thread support.
+    (void) ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers,
+                                  QThread::idealThreadCount());
+  }
+
+  for (int i = 0; ok && i <= buffers.size(); i++) {
+    bool finish = (i == buffers.size());
+    ZSTD_inBuffer in = {nullptr, 0, 0};
+
+    if (!finish) {
+      in.src = buffers[i].constData();
+      in.size = buffers[i].size();
+    }
+    do {
+      ZSTD_outBuffer obuf = {out.data(), size_t(out.size()), 0};
+
+      remaining = ZSTD_compressStream2(cctx, &obuf, &in,
+                                       finish ? ZSTD_e_end
+                                              : ZSTD_e_continue);
+      if (ZSTD_isError(remaining)
+          || fs->write(out.constData(), obuf.pos) != qint64(obuf.pos)) {
+        ok = false;
+        break;
+      }
+    } while (in.pos < in.size || (finish && remaining != 0));
+  }
+  ZSTD_freeCCtx(cctx);
+
+  return ok;
+}
+#endif // FREECIV_HAVE_ZSTD_MT
+
 /**
    Save the previously filled in section_file to disk.
 
@@ -610,11 +948,13 @@ static bool is_legal_table_entry_name(char c, bool num)
 bool secfile_save(const struct section_file *secfile, QString filename)
 {
   char real_filename[1024];
-  char pentry_name[128];
-  const char *col_entry_name;
-  const struct entry_list_link *ent_iter, *save_iter, *col_iter;
-  struct entry *pentry, *col_pentry;
-  int i;
+  QVector<const struct section *> sections;
+  QVector<QByteArray> buffers;
+  QAtomicInt failed;
+  QElapsedTimer timer;
+  qint64 size = 0;
+  bool (*compress)(const QVector<QByteArray> &, QIODevice *) = nullptr;
+  std::unique_ptr<QIODevice> fs;
 
   SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, nullptr != secfile, false);
 
@@ -622,8 +962,26 @@ bool secfile_save(const struct section_file *secfile, QString filename)
     filename = secfile->name;
   }
 
+  timer.start();
   interpret_tilde(real_filename, sizeof(real_filename), filename);
-  auto fs = std::make_unique<KFilterDev>(real_filename);
+
+  /* xz and zstd are compressed here with several threads, the other
+   * formats by KFilterDev. */
+#ifdef FREECIV_HAVE_LZMA_MT
+  if (QString(real_filename).endsWith(QLatin1String(".xz"))) {
+    compress = buffers_to_xz;
+  }
+#endif
+#ifdef FREECIV_HAVE_ZSTD_MT
+  if (QString(real_filename).endsWith(QLatin1String(".zst"))) {
+    compress = buffers_to_zstd;
+  }
+#endif
+  if (compress != nullptr) {
+    fs = std::make_unique<QFile>(real_filename);
+  } else {
+    fs = std::make_unique<KFilterDev>(real_filename);
+  }
   fs->open(QIODevice::WriteOnly);
 
   if (!fs->isOpen()) {
@@ -632,212 +990,81 @@ bool secfile_save(const struct section_file *secfile, QString filename)
     return false;
   }
 
+  /* Sections don't depend on each other, so those of big files are
+   * formatted in parallel. The compressor still sees them in the original
+   * order. */
   section_list_iterate(secfile->sections, psection)
   {
-    if (psection->special == EST_INCLUDE) {
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
-        fc_assert(!strcmp(entry_name(pentry), "file"));
-
-        fc_assert_ret_val(fs->write("*include ") > 0, false);
-        fc_assert_ret_val(entry_to_file(pentry, fs.get()), false);
-        fc_assert_ret_val(fs->write("\n") > 0, false);
-      }
-    } else if (psection->special == EST_COMMENT) {
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
-        fc_assert(!strcmp(entry_name(pentry), "comment"));
-
-        fc_assert_ret_val(entry_to_file(pentry, fs.get()), false);
-        fc_assert_ret_val(fs->write("\n") > 0, false);
-      }
-    } else {
-      fc_assert_ret_val(fs->write("\n[") > 0, false);
-      fc_assert_ret_val(fs->write(section_name(psection)) > 0, false);
-      fc_assert_ret_val(fs->write("]\n") > 0, false);
-
-      /* Following doesn't use entry_list_iterate() because we want to do
-       * tricky things with the iterators...
-       */
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
-        const char *comment;
-
-        /* Tables: break out of this loop if this is a non-table
-         * entry (pentry and ent_iter unchanged) or after table (pentry
-         * and ent_iter suitably updated, pentry possibly nullptr).
-         * After each table, loop again in case the next entry
-         * is another table.
-         */
-        for (;;) {
-          char *c, *first, base[64];
-          int offset, irow, icol, ncol;
-
-          /* Example: for first table name of "xyz0.blah":
-           *  first points to the original string pentry->name
-           *  base contains "xyz";
-           *  offset = 5 (so first+offset gives "blah")
-           *  note qstrlen(base) = offset - 2
-           */
-
-          if (!SAVE_TABLES) {
-            break;
-          }
+    sections.append(psection);
+  }
+  section_list_iterate_end;
+  buffers.resize(sections.size());
 
-          sz_strlcpy(pentry_name, entry_name(pentry));
-          c = first = pentry_name;
-          if (*c == '\0' || !is_legal_table_entry_name(*c, false)) {
-            break;
-          }
-          for (; *c != '\0' && is_legal_table_entry_name(*c, false); c++) {
-            // nothing
-          }
-          if (0 != strncmp(c, "0.", 2)) {
-            break;
-          }
-          c += 2;
-          if (*c == '\0' || !is_legal_table_entry_name(*c, true)) {
-            break;
-          }
+  if (sections.size() < SAVE_PARALLEL_SECTIONS) {
+    for (int i = 0; i < sections.size(); i++) {
+      QBuffer buffer(&buffers[i]);
 
-          offset = c - first;
-          first[offset - 2] = '\0';
-          sz_strlcpy(base, first);
-          first[offset - 2] = '0';
-          fc_assert_ret_val(fs->write(base) > 0, false);
-          fc_assert_ret_val(fs->write("={") > 0, false);
-
-          /* Save an iterator at this first entry, which we can later use
-           * to repeatedly iterate over column names:
-           */
-          save_iter = ent_iter;
-
-          // write the column names, and calculate ncol:
-          ncol = 0;
-          col_iter = save_iter;
-          for (; (col_pentry = entry_list_link_data(col_iter));
-               col_iter = entry_list_link_next(col_iter)) {
-            col_entry_name = entry_name(col_pentry);
-            if (strncmp(col_entry_name, first, offset) != 0) {
-              break;
-            }
-            fc_assert_ret_val(fs->write(ncol == 0 ? "\"" : ",\"") > 0,
-                              false);
-            fc_assert_ret_val(fs->write(col_entry_name + offset) > 0, false);
-            fc_assert_ret_val(fs->write("\"") > 0, false);
-            ncol++;
-          }
-          fc_assert_ret_val(fs->write("\n") > 0, false);
-
-          /* Iterate over rows and columns, incrementing ent_iter as we go,
-           * and writing values to the table.  Have a separate iterator
-           * to the column names to check they all match.
-           */
-          irow = icol = 0;
-          col_iter = save_iter;
-          for (;;) {
-            char expect[128]; // pentry->name we're expecting
-
-            pentry = entry_list_link_data(ent_iter);
-            col_pentry = entry_list_link_data(col_iter);
-
-            fc_snprintf(expect, sizeof(expect), "%s%d.%s", base, irow,
-                        entry_name(col_pentry) + offset);
-
-            // break out of tabular if doesn't match:
-            if ((!pentry) || (strcmp(entry_name(pentry), expect) != 0)) {
-              if (icol != 0) {
-                /* If the second or later row of a table is missing some
-                 * entries that the first row had, we drop out of the tabular
-                 * format.  This is inefficient so we print a warning
-                 * message; the calling code probably needs to be fixed so
-                 * that it can use the more efficient tabular format.
-                 *
-                 * FIXME: If the first row is missing some entries that the
-                 * second or later row has, then we'll drop out of tabular
-                 * format without an error message. */
-                qCCritical(
-                    bugs_category,
-                    "In file %s, there is no entry in the registry for\n"
-                    "%s.%s (or the entries are out of order). This means\n"
-                    "a less efficient non-tabular format will be used.\n"
-                    "To avoid this make sure all rows of a table are\n"
-                    "filled out with an entry for every column.",
-                    real_filename, section_name(psection), expect);
-                fc_assert_ret_val(fs->write("\n") > 0, false);
-              }
-              fc_assert_ret_val(fs->write("}\n") > 0, false);
-              break;
-            }
+      buffer.open(QIODevice::WriteOnly);
+      if (!section_to_file(sections[i], &buffer, real_filename)) {
+        failed.storeRelaxed(1);
+      }
+    }
+  } else {
+    QSemaphore done;
 
-            if (icol > 0) {
-              fc_assert_ret_val(fs->write(",") > 0, false);
-            }
-            fc_assert_ret_val(entry_to_file(pentry, fs.get()), false);
+    for (int i = 0; i < sections.size(); i++) {
+      const struct section *psection = sections[i];
+      QByteArray *out = &buffers[i];
 
-            ent_iter = entry_list_link_next(ent_iter);
-            col_iter = entry_list_link_next(col_iter);
+      save_pool->start([psection, out, &real_filename, &failed, &done]() {
+        QBuffer buffer(out);
 
-            icol++;
-            if (icol == ncol) {
-              fc_assert_ret_val(fs->write("\n") > 0, false);
-              irow++;
-              icol = 0;
-              col_iter = save_iter;
-            }
-          }
-          if (!pentry) {
-            break;
-          }
-        }
-        if (!pentry) {
-          break;
+        buffer.open(QIODevice::WriteOnly);
+        if (!section_to_file(psection, &buffer, real_filename)) {
+          failed.storeRelaxed(1);
         }
+        done.release();
+      });
+    }
+    // Only wait for our own sections, the pool is shared.
+    done.acquire(sections.size());
+  }
 
-        // Classic entry.
-        col_entry_name = entry_name(pentry);
-        fc_assert_ret_val(fs->write(col_entry_name), false);
-        fc_assert_ret_val(fs->write("="), false);
-        fc_assert_ret_val(entry_to_file(pentry, fs.get()), false);
+  if (failed.loadRelaxed() != 0) {
+    SECFILE_LOG(secfile, nullptr, "Could not format %s", real_filename);
+    return false;
+  }
 
-        // Check for vector.
-        for (i = 1;; i++) {
-          col_iter = entry_list_link_next(ent_iter);
-          col_pentry = entry_list_link_data(col_iter);
-          if (nullptr == col_pentry) {
-            break;
-          }
-          fc_snprintf(pentry_name, sizeof(pentry_name), "%s,%d",
-                      col_entry_name, i);
-          if (0 != strcmp(pentry_name, entry_name(col_pentry))) {
-            break;
-          }
-          fc_assert_ret_val(fs->write(",") > 0, false);
-          fc_assert_ret_val(entry_to_file(col_pentry, fs.get()), false);
-          ent_iter = col_iter;
-        }
+  for (const auto &buffer : qAsConst(buffers)) {
+    size += buffer.size();
+  }
 
-        comment = entry_comment(pentry);
-        if (comment) {
-          fc_assert_ret_val(fs->write("  # ") > 0, false);
-          fc_assert_ret_val(fs->write(comment) > 0, false);
-          fc_assert_ret_val(fs->write("\n") > 0, false);
-        } else {
-          fc_assert_ret_val(fs->write("\n") > 0, false);
-        }
+  if (compress != nullptr) {
+    if (!compress(buffers, fs.get())
+        || !static_cast<QFile *>(fs.get())->flush()) {
+      SECFILE_LOG(secfile, nullptr, "Could not compress %s: %s",
+                  real_filename, qUtf8Printable(fs->errorString()));
+      return false;
+    }
+  } else {
+    for (const auto &buffer : qAsConst(buffers)) {
+      if (!buffer.isEmpty()) {
+        fc_assert_ret_val(fs->write(buffer) == buffer.size(), false);
       }
     }
-  }
-  section_list_iterate_end;
 
-  if (fs->error() != 0) {
-    SECFILE_LOG(secfile, nullptr, "Error before closing %s: %s",
-                real_filename, qUtf8Printable(fs->errorString()));
-    return false;
+    if (static_cast<KFilterDev *>(fs.get())->error() != 0) {
+      SECFILE_LOG(secfile, nullptr, "Error before closing %s: %s",
+                  real_filename, qUtf8Printable(fs->errorString()));
+      return false;
+    }
   }
+  fs->close();
+
+  qCDebug(timers_category,
+          "Saved %s: %lld bytes in %.3f seconds (%.1f MB/s)", real_filename,
+          static_cast<long long>(size), timer.elapsed() / 1000.0,
+          size / 1048576.0 / qMax(timer.elapsed(), qint64(1)) * 1000.0);
 
   return true;
 }
@@ -3251,7 +3478,7 @@ bool entry_str_set_gt_marking(struct entry *pentry, bool gt_marking)
  */
 static bool entry_to_file(const struct entry *pentry, QIODevice *fs)
 {
-  static char buf[8192];
+  char buf[8192];
 
   switch (pentry->type) {
   case ENTRY_BOOL: